@@ -0,0 +1,848 @@
+// Minimal KServe v2 (Triton) server for client benchmarks: answers health, metadata, config and
+// infer requests for one model with canned [N,300,6] detections after a configurable delay, or
+// with the outputs and latencies of a recorded client trace (--trace). Speaks HTTP/1.1 with the
+// binary tensor extension; gRPC is added when built with YOLOV10_BENCH_GRPC_MOCK. No GPU or
+// model is involved.
+#include <rapidjson/document.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "trace.h"
+
+#if defined(YOLOV10_MOCK_GRPC)
+#include <grpcpp/grpcpp.h>
+#include "grpc_service.grpc.pb.h"
+#endif
+
+namespace {
+
+struct MockConfig {
+    int http_port{8000};
+    int grpc_port{8001};
+    std::string model_name{"yolov10m"};
+    int max_batch_size{1};
+    int input_width{640};
+    int input_height{640};
+    std::string input_datatype{"FP32"};
+    int detections{20};
+    std::chrono::microseconds delay{0};
+    std::chrono::microseconds jitter{0};
+    std::string trace_path;
+};
+
+// Model description plus the canned output shared by both protocols. With a trace, each request is
+// answered with a recorded output after its recorded latency: the output of the frame and request
+// index named by the request id (trace_request_id), or else the next one recorded with the
+// request's batch size.
+class MockModel {
+public:
+    MockModel(const MockConfig& config, std::shared_ptr<const TraceReader> trace) : config_{config}, trace_{std::move(trace)} {
+        if (config.input_datatype != "FP32" && config.input_datatype != "UINT8" && config.input_datatype != "BYTES") {
+            throw std::runtime_error("Mock input datatype must be FP32, UINT8 or BYTES.");
+        }
+        // BYTES stands in for an ensemble that decodes JPEGs; elements vary in size
+        frame_bytes_ = config.input_datatype == "BYTES"
+                           ? 0
+                           : static_cast<size_t>(3) * config.input_width * config.input_height *
+                                 (config.input_datatype == "FP32" ? sizeof(float) : 1);
+        // Descending scores, boxes spread over the input; same for every frame of a batch
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> coordinate(0.f, 1.f);
+        std::vector<float> frame(kRows * kCols, 0.f);
+        const int detections = std::clamp(config.detections, 0, kRows);
+        for (int i = 0; i < detections; ++i) {
+            float* row = frame.data() + i * kCols;
+            const float x = coordinate(rng) * config.input_width * 0.8f;
+            const float y = coordinate(rng) * config.input_height * 0.8f;
+            row[0] = x;
+            row[1] = y;
+            row[2] = x + config.input_width * 0.1f;
+            row[3] = y + config.input_height * 0.1f;
+            row[4] = 0.95f - 0.9f * i / std::max(detections, 1);
+            row[5] = static_cast<float>(i % 80);
+        }
+        const size_t batches = static_cast<size_t>(std::max(config.max_batch_size, 1));
+        output_.resize(batches * frame.size() * sizeof(float));
+        for (size_t b = 0; b < batches; ++b) {
+            std::memcpy(output_.data() + b * frame.size() * sizeof(float), frame.data(), frame.size() * sizeof(float));
+        }
+        if (trace_) {
+            for (const TraceRecord* record : trace_->records(TraceRecordType::Output)) {
+                const size_t index = replay_.size();
+                replay_.push_back(TraceReader::output(*record));
+                by_request_.emplace(std::make_pair(record->frame_id, record->index), index);
+                by_batch_size_[recorded_batch_size(replay_.back())].push_back(index);
+            }
+            if (replay_.empty()) {
+                throw std::runtime_error("Trace " + config.trace_path + " holds no outputs to replay.");
+            }
+            for (const auto& [batch_size, indices] : by_batch_size_) {
+                batch_cursors_.emplace(batch_size, std::make_unique<std::atomic<size_t>>(0));
+            }
+        }
+    }
+
+    const MockConfig& config() const { return config_; }
+    size_t frame_bytes() const { return frame_bytes_; }
+
+    // Declared outputs; shapes exclude the batch dimension of batching models.
+    std::vector<TraceTensor> output_specs() const {
+        if (replay_.empty()) {
+            return {TraceTensor{"output0", "FP32", {kRows, kCols}}};
+        }
+        std::vector<TraceTensor> specs;
+        for (const TraceTensor& tensor : replay_.front().tensors) {
+            TraceTensor spec{tensor.name, tensor.datatype, tensor.shape};
+            if (config_.max_batch_size > 0 && !spec.shape.empty()) {
+                spec.shape.erase(spec.shape.begin());
+            }
+            specs.push_back(spec);
+        }
+        return specs;
+    }
+
+    // Output tensors for a request, returned once the simulated or recorded compute time has passed.
+    // Throws if a trace has no output for the request's batch size.
+    std::vector<TraceTensor> run(int64_t batch_size, const std::string& request_id) const {
+        if (replay_.empty()) {
+            simulate_compute();
+            const size_t batch = static_cast<size_t>(batch_size);
+            return {TraceTensor{"output0", "FP32", {batch_size, kRows, kCols}, output_.data(), batch * kRows * kCols * sizeof(float)}};
+        }
+        const TraceOutput& recorded = replay_[replay_index(batch_size, request_id)];
+        std::this_thread::sleep_for(std::chrono::nanoseconds(recorded.latency_ns));
+        return recorded.tensors;
+    }
+    bool encoded_input() const { return frame_bytes_ == 0; }
+    // Model configuration datatype: BYTES tensors are declared as TYPE_STRING
+    std::string config_datatype() const { return encoded_input() ? "TYPE_STRING" : "TYPE_" + config_.input_datatype; }
+    std::vector<int64_t> input_dims() const {
+        std::vector<int64_t> dims = {3, config_.input_height, config_.input_width};
+        if (encoded_input()) {
+            dims = {1};
+        }
+        if (config_.max_batch_size == 0) {
+            dims.insert(dims.begin(), 1);
+        }
+        return dims;
+    }
+
+    // Empty if a request with leading dimension `batch_size` and `input_bytes` of input is valid, else the reason.
+    std::string validate(int64_t batch_size, const char* input, size_t input_bytes) const {
+        const int64_t max_batch = std::max(config_.max_batch_size, 1);
+        std::stringstream err_msg;
+        if (batch_size < 1 || batch_size > max_batch) {
+            err_msg << "batch size " << batch_size << " outside [1, " << max_batch << "]";
+        } else if (encoded_input()) {
+            const int64_t elements = count_bytes_elements(input, input_bytes);
+            if (elements != batch_size) {
+                err_msg << "expected " << batch_size << " length-prefixed BYTES elements, got "
+                        << (elements < 0 ? "a malformed tensor" : std::to_string(elements));
+            }
+        } else if (input_bytes != frame_bytes_ * static_cast<size_t>(batch_size)) {
+            err_msg << "expected " << frame_bytes_ * batch_size << " input bytes, got " << input_bytes;
+        }
+        return err_msg.str();
+    }
+
+    // Stands in for the model's execution time.
+    void simulate_compute() const {
+        auto delay = config_.delay;
+        if (config_.jitter.count() > 0) {
+            thread_local std::mt19937 rng(std::random_device{}());
+            std::uniform_int_distribution<int64_t> jitter(0, config_.jitter.count());
+            delay += std::chrono::microseconds(jitter(rng));
+        }
+        if (delay.count() > 0) {
+            std::this_thread::sleep_for(delay);
+        }
+    }
+
+    // Elements of a raw BYTES tensor (4-byte little-endian length, then the bytes), or -1 if malformed.
+    static int64_t count_bytes_elements(const char* data, size_t size) {
+        int64_t count = 0;
+        size_t offset = 0;
+        while (offset < size) {
+            if (size - offset < 4) {
+                return -1;
+            }
+            const auto* prefix = reinterpret_cast<const uint8_t*>(data + offset);
+            const size_t length = prefix[0] | (prefix[1] << 8) | (prefix[2] << 16) | (static_cast<size_t>(prefix[3]) << 24);
+            offset += 4;
+            if (length > size - offset) {
+                return -1;
+            }
+            offset += length;
+            ++count;
+        }
+        return count;
+    }
+
+    static constexpr int kRows = 300;
+    static constexpr int kCols = 6;
+
+private:
+    // Leading dimension of a recorded output; 1 for models without batching.
+    int64_t recorded_batch_size(const TraceOutput& output) const {
+        if (config_.max_batch_size <= 0 || output.tensors.empty() || output.tensors.front().shape.empty()) {
+            return 1;
+        }
+        return output.tensors.front().shape.front();
+    }
+
+    // Matching by id rather than by input: a changed client may send different bytes for the same frame.
+    size_t replay_index(int64_t batch_size, const std::string& request_id) const {
+        uint64_t frame_id;
+        uint32_t request_index;
+        if (parse_trace_request_id(request_id, frame_id, request_index)) {
+            auto it = by_request_.find({frame_id, request_index});
+            if (it != by_request_.end()) {
+                if (recorded_batch_size(replay_[it->second]) != batch_size) {
+                    std::stringstream err_msg;
+                    err_msg << "request " << request_index << " of frame " << frame_id << " was recorded with batch size "
+                            << recorded_batch_size(replay_[it->second]) << ", not " << batch_size;
+                    throw std::runtime_error(err_msg.str());
+                }
+                return it->second;
+            }
+        }
+        // Untagged requests or frames the trace does not hold: the next output of the same shape, in recorded order
+        auto it = by_batch_size_.find(batch_size);
+        if (it == by_batch_size_.end()) {
+            std::stringstream err_msg;
+            err_msg << "the trace holds no output with batch size " << batch_size;
+            throw std::runtime_error(err_msg.str());
+        }
+        const size_t cursor = batch_cursors_.at(batch_size)->fetch_add(1, std::memory_order_relaxed);
+        return it->second[cursor % it->second.size()];
+    }
+
+    MockConfig config_;
+    size_t frame_bytes_;
+    std::vector<uint8_t> output_;
+    std::shared_ptr<const TraceReader> trace_; // Owns the memory replay_ points into
+    std::vector<TraceOutput> replay_;
+    // Indices into replay_: by (frame id, request index), and per batch size in recorded order
+    std::map<std::pair<uint64_t, uint32_t>, size_t> by_request_;
+    std::map<int64_t, std::vector<size_t>> by_batch_size_;
+    std::map<int64_t, std::unique_ptr<std::atomic<size_t>>> batch_cursors_;
+};
+
+std::string json_dims(const std::vector<int64_t>& dims) {
+    std::string json = "[";
+    for (size_t i = 0; i < dims.size(); ++i) {
+        json += (i ? "," : "") + std::to_string(dims[i]);
+    }
+    return json + "]";
+}
+
+std::string model_config_json(const MockModel& model) {
+    const MockConfig& config = model.config();
+    std::stringstream json;
+    json << "{\"name\":\"" << config.model_name << "\",\"platform\":\"tensorrt_plan\",\"max_batch_size\":"
+         << config.max_batch_size << ",\"input\":[{\"name\":\"images\",\"data_type\":\"" << model.config_datatype()
+         << "\",\"format\":\"FORMAT_NONE\",\"dims\":" << json_dims(model.input_dims()) << "}],\"output\":[";
+    const std::vector<TraceTensor> outputs = model.output_specs();
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        json << (i ? "," : "") << "{\"name\":\"" << outputs[i].name << "\",\"data_type\":\"TYPE_" << outputs[i].datatype
+             << "\",\"dims\":" << json_dims(outputs[i].shape) << "}";
+    }
+    json << "]";
+    if (model.encoded_input()) {
+        // Network resolution the ensemble decodes to, as a real encoded-input model declares it
+        json << ",\"parameters\":{\"input_width\":{\"string_value\":\"" << config.input_width
+             << "\"},\"input_height\":{\"string_value\":\"" << config.input_height << "\"}}";
+    }
+    json << "}";
+    return json.str();
+}
+
+std::string model_metadata_json(const MockModel& model) {
+    const MockConfig& config = model.config();
+    std::vector<int64_t> input_shape = {-1, 3, config.input_height, config.input_width};
+    if (model.encoded_input()) {
+        input_shape = {-1, 1};
+    }
+    std::stringstream json;
+    json << "{\"name\":\"" << config.model_name << "\",\"versions\":[\"1\"],\"platform\":\"tensorrt_plan\","
+         << "\"inputs\":[{\"name\":\"images\",\"datatype\":\"" << config.input_datatype << "\",\"shape\":"
+         << json_dims(input_shape) << "}],\"outputs\":[";
+    const std::vector<TraceTensor> outputs = model.output_specs();
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        std::vector<int64_t> output_shape = outputs[i].shape;
+        if (config.max_batch_size > 0) {
+            output_shape.insert(output_shape.begin(), -1);
+        }
+        json << (i ? "," : "") << "{\"name\":\"" << outputs[i].name << "\",\"datatype\":\"" << outputs[i].datatype
+             << "\",\"shape\":" << json_dims(output_shape) << "}";
+    }
+    json << "]}";
+    return json.str();
+}
+
+// ---------------------------------------------------------------------------------------------
+// HTTP
+
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+
+    const std::string* header(const std::string& name) const {
+        for (const auto& [key, value] : headers) {
+            if (strcasecmp(key.c_str(), name.c_str()) == 0) {
+                return &value;
+            }
+        }
+        return nullptr;
+    }
+};
+
+struct HttpResponse {
+    int status{200};
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+};
+
+const char* status_text(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    default: return "Internal Server Error";
+    }
+}
+
+HttpResponse error_response(int status, const std::string& message) {
+    HttpResponse response;
+    response.status = status;
+    response.headers.emplace_back("Content-Type", "application/json");
+    std::string escaped;
+    for (char c : message) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    response.body = "{\"error\":\"" + escaped + "\"}";
+    return response;
+}
+
+HttpResponse json_response(std::string body) {
+    HttpResponse response;
+    response.headers.emplace_back("Content-Type", "application/json");
+    response.body = std::move(body);
+    return response;
+}
+
+class HttpConnection {
+public:
+    explicit HttpConnection(int fd) : fd_{fd} {}
+    ~HttpConnection() { ::close(fd_); }
+
+    // Reads the next request; false when the peer closed the connection.
+    bool read_request(HttpRequest& request) {
+        size_t header_end;
+        while ((header_end = buffer_.find("\r\n\r\n")) == std::string::npos) {
+            if (!fill()) {
+                return false;
+            }
+        }
+        std::istringstream head(buffer_.substr(0, header_end));
+        buffer_.erase(0, header_end + 4);
+
+        std::string line;
+        std::getline(head, line);
+        std::istringstream request_line(line);
+        request_line >> request.method >> request.path;
+        request.headers.clear();
+        while (std::getline(head, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            const size_t colon = line.find(':');
+            if (colon == std::string::npos) {
+                continue;
+            }
+            size_t value_start = line.find_first_not_of(' ', colon + 1);
+            request.headers.emplace_back(line.substr(0, colon),
+                                         value_start == std::string::npos ? "" : line.substr(value_start));
+        }
+
+        const std::string* content_length = request.header("Content-Length");
+        const size_t body_size = content_length ? std::stoul(*content_length) : 0;
+        if (const std::string* expect = request.header("Expect"); expect && strcasecmp(expect->c_str(), "100-continue") == 0) {
+            // libcurl waits for this before sending large bodies
+            write_all("HTTP/1.1 100 Continue\r\n\r\n");
+        }
+        while (buffer_.size() < body_size) {
+            if (!fill()) {
+                return false;
+            }
+        }
+        request.body = buffer_.substr(0, body_size);
+        buffer_.erase(0, body_size);
+        return true;
+    }
+
+    bool write_response(const HttpResponse& response) {
+        std::string head = "HTTP/1.1 " + std::to_string(response.status) + " " + status_text(response.status) + "\r\n";
+        for (const auto& [key, value] : response.headers) {
+            head += key + ": " + value + "\r\n";
+        }
+        head += "Content-Length: " + std::to_string(response.body.size()) + "\r\n\r\n";
+        return write_all(head) && write_all(response.body);
+    }
+
+private:
+    bool fill() {
+        char chunk[64 * 1024];
+        const ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            return false;
+        }
+        buffer_.append(chunk, static_cast<size_t>(n));
+        return true;
+    }
+
+    bool write_all(const std::string& data) {
+        size_t written = 0;
+        while (written < data.size()) {
+            const ssize_t n = ::send(fd_, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+            if (n <= 0) {
+                return false;
+            }
+            written += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    int fd_;
+    std::string buffer_;
+};
+
+class HttpHandler {
+public:
+    explicit HttpHandler(const MockModel& model) : model_{model} {
+        model_prefix_ = "/v2/models/" + model.config().model_name;
+    }
+
+    HttpResponse handle(const HttpRequest& request) const {
+        std::string path = request.path.substr(0, request.path.find('?'));
+        if (path == "/v2/health/live" || path == "/v2/health/ready") {
+            return HttpResponse{};
+        }
+        if (path == "/v2") {
+            return json_response("{\"name\":\"mock-triton\",\"version\":\"0\",\"extensions\":[\"binary_tensor_data\"]}");
+        }
+        if (path.rfind("/v2/models/", 0) != 0) {
+            return error_response(404, "Not found");
+        }
+        if (path.compare(0, model_prefix_.size(), model_prefix_) != 0 ||
+            (path.size() > model_prefix_.size() && path[model_prefix_.size()] != '/')) {
+            const std::string name = path.substr(11, path.find('/', 11) - 11);
+            return error_response(400, "Request for unknown model: '" + name + "' is not found");
+        }
+        std::string action = path.substr(model_prefix_.size());
+        if (action.rfind("/versions/", 0) == 0) {
+            const size_t slash = action.find('/', 10);
+            action = slash == std::string::npos ? "" : action.substr(slash);
+        }
+        if (action.empty()) {
+            return json_response(model_metadata_json(model_));
+        }
+        if (action == "/ready") {
+            return HttpResponse{};
+        }
+        if (action == "/config") {
+            return json_response(model_config_json(model_));
+        }
+        if (action == "/infer" && request.method == "POST") {
+            return infer(request);
+        }
+        return error_response(404, "Not found");
+    }
+
+private:
+    HttpResponse infer(const HttpRequest& request) const {
+        const std::string* header_length = request.header("Inference-Header-Content-Length");
+        if (!header_length) {
+            return error_response(400, "mock server only accepts binary tensor data");
+        }
+        const size_t json_size = std::stoul(*header_length);
+        if (json_size > request.body.size()) {
+            return error_response(400, "Inference-Header-Content-Length exceeds the body");
+        }
+        rapidjson::Document json;
+        json.Parse(request.body.data(), json_size);
+        if (json.HasParseError() || !json.HasMember("inputs") || json["inputs"].Size() != 1) {
+            return error_response(400, "malformed inference request");
+        }
+        const auto& input = json["inputs"][0];
+        if (input.HasMember("parameters") && input["parameters"].HasMember("shared_memory_region")) {
+            return error_response(400, "mock server does not support shared memory");
+        }
+        const int64_t batch_size = input["shape"][0].GetInt64();
+        const std::string error = model_.validate(batch_size, request.body.data() + json_size, request.body.size() - json_size);
+        if (!error.empty()) {
+            return error_response(400, error);
+        }
+
+        std::vector<TraceTensor> outputs;
+        try {
+            outputs = model_.run(batch_size, json.HasMember("id") ? json["id"].GetString() : "");
+        } catch (const std::exception& e) {
+            return error_response(400, e.what());
+        }
+
+        size_t output_bytes = 0;
+        std::stringstream header;
+        header << "{";
+        if (json.HasMember("id")) {
+            header << "\"id\":\"" << json["id"].GetString() << "\",";
+        }
+        header << "\"model_name\":\"" << model_.config().model_name << "\",\"model_version\":\"1\",\"outputs\":[";
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            header << (i ? "," : "") << "{\"name\":\"" << outputs[i].name << "\",\"datatype\":\"" << outputs[i].datatype
+                   << "\",\"shape\":" << json_dims(outputs[i].shape) << ",\"parameters\":{\"binary_data_size\":"
+                   << outputs[i].byte_size << "}}";
+            output_bytes += outputs[i].byte_size;
+        }
+        header << "]}";
+        HttpResponse response;
+        const std::string header_json = header.str();
+        response.headers.emplace_back("Content-Type", "application/octet-stream");
+        response.headers.emplace_back("Inference-Header-Content-Length", std::to_string(header_json.size()));
+        response.body.reserve(header_json.size() + output_bytes);
+        response.body.append(header_json);
+        for (const TraceTensor& output : outputs) {
+            response.body.append(reinterpret_cast<const char*>(output.data), output.byte_size);
+        }
+        return response;
+    }
+
+    const MockModel& model_;
+    std::string model_prefix_;
+};
+
+int listen_on(int port) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create listening socket.");
+    }
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, 128) != 0) {
+        ::close(fd);
+        std::stringstream err_msg;
+        err_msg << "Failed to listen on port " << port << ": " << std::strerror(errno);
+        throw std::runtime_error(err_msg.str());
+    }
+    return fd;
+}
+
+// Thread per connection; benchmark clients keep a handful of long-lived keep-alive connections.
+void serve_http(const MockModel& model, int port) {
+    const int listen_fd = listen_on(port);
+    const HttpHandler handler(model);
+    std::cout << "HTTP listening on 0.0.0.0:" << port << std::endl;
+    while (true) {
+        const int fd = ::accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        std::thread([fd, &handler] {
+            HttpConnection connection(fd);
+            HttpRequest request;
+            while (connection.read_request(request)) {
+                HttpResponse response;
+                try {
+                    response = handler.handle(request);
+                } catch (const std::exception& e) {
+                    response = error_response(500, e.what());
+                }
+                const std::string* connection_header = request.header("Connection");
+                const bool close = connection_header && strcasecmp(connection_header->c_str(), "close") == 0;
+                if (!connection.write_response(response) || close) {
+                    break;
+                }
+            }
+        }).detach();
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// gRPC
+
+#if defined(YOLOV10_MOCK_GRPC)
+class MockGrpcService final : public inference::GRPCInferenceService::Service {
+public:
+    explicit MockGrpcService(const MockModel& model) : model_{model} {}
+
+    grpc::Status ServerLive(grpc::ServerContext*, const inference::ServerLiveRequest*,
+                            inference::ServerLiveResponse* response) override {
+        response->set_live(true);
+        return grpc::Status::OK;
+    }
+
+    grpc::Status ServerReady(grpc::ServerContext*, const inference::ServerReadyRequest*,
+                             inference::ServerReadyResponse* response) override {
+        response->set_ready(true);
+        return grpc::Status::OK;
+    }
+
+    grpc::Status ModelReady(grpc::ServerContext*, const inference::ModelReadyRequest* request,
+                            inference::ModelReadyResponse* response) override {
+        response->set_ready(request->name() == model_.config().model_name);
+        return grpc::Status::OK;
+    }
+
+    grpc::Status ModelMetadata(grpc::ServerContext*, const inference::ModelMetadataRequest* request,
+                               inference::ModelMetadataResponse* response) override {
+        const MockConfig& config = model_.config();
+        if (request->name() != config.model_name) {
+            return unknown_model(request->name());
+        }
+        response->set_name(config.model_name);
+        response->add_versions("1");
+        response->set_platform("tensorrt_plan");
+        auto* input = response->add_inputs();
+        input->set_name("images");
+        input->set_datatype(config.input_datatype);
+        if (model_.encoded_input()) {
+            input->add_shape(-1);
+            input->add_shape(1);
+        } else {
+            for (int64_t dim : {int64_t{-1}, int64_t{3}, static_cast<int64_t>(config.input_height), static_cast<int64_t>(config.input_width)}) {
+                input->add_shape(dim);
+            }
+        }
+        for (const TraceTensor& spec : model_.output_specs()) {
+            auto* output = response->add_outputs();
+            output->set_name(spec.name);
+            output->set_datatype(spec.datatype);
+            if (config.max_batch_size > 0) {
+                output->add_shape(-1);
+            }
+            for (int64_t dim : spec.shape) {
+                output->add_shape(dim);
+            }
+        }
+        return grpc::Status::OK;
+    }
+
+    grpc::Status ModelConfig(grpc::ServerContext*, const inference::ModelConfigRequest* request,
+                             inference::ModelConfigResponse* response) override {
+        const MockConfig& config = model_.config();
+        if (request->name() != config.model_name) {
+            return unknown_model(request->name());
+        }
+        inference::ModelConfig* model_config = response->mutable_config();
+        model_config->set_name(config.model_name);
+        model_config->set_platform("tensorrt_plan");
+        model_config->set_max_batch_size(config.max_batch_size);
+        auto* input = model_config->add_input();
+        input->set_name("images");
+        inference::DataType input_datatype = inference::TYPE_INVALID;
+        inference::DataType_Parse(model_.config_datatype(), &input_datatype);
+        input->set_data_type(input_datatype);
+        input->set_format(inference::ModelInput::FORMAT_NONE);
+        for (int64_t dim : model_.input_dims()) {
+            input->add_dims(dim);
+        }
+        for (const TraceTensor& spec : model_.output_specs()) {
+            auto* output = model_config->add_output();
+            output->set_name(spec.name);
+            inference::DataType output_datatype = inference::TYPE_INVALID;
+            inference::DataType_Parse("TYPE_" + spec.datatype, &output_datatype);
+            output->set_data_type(output_datatype);
+            for (int64_t dim : spec.shape) {
+                output->add_dims(dim);
+            }
+        }
+        if (model_.encoded_input()) {
+            auto& parameters = *model_config->mutable_parameters();
+            parameters["input_width"].set_string_value(std::to_string(config.input_width));
+            parameters["input_height"].set_string_value(std::to_string(config.input_height));
+        }
+        return grpc::Status::OK;
+    }
+
+    grpc::Status ModelInfer(grpc::ServerContext*, const inference::ModelInferRequest* request,
+                            inference::ModelInferResponse* response) override {
+        return infer(*request, *response);
+    }
+
+    grpc::Status ModelStreamInfer(
+        grpc::ServerContext*,
+        grpc::ServerReaderWriter<inference::ModelStreamInferResponse, inference::ModelInferRequest>* stream) override {
+        inference::ModelInferRequest request;
+        while (stream->Read(&request)) {
+            inference::ModelStreamInferResponse response;
+            const grpc::Status status = infer(request, *response.mutable_infer_response());
+            if (!status.ok()) {
+                response.set_error_message(status.error_message());
+            }
+            stream->Write(response);
+        }
+        return grpc::Status::OK;
+    }
+
+private:
+    static grpc::Status unknown_model(const std::string& name) {
+        return grpc::Status(grpc::StatusCode::NOT_FOUND, "Request for unknown model: '" + name + "' is not found");
+    }
+
+    grpc::Status infer(const inference::ModelInferRequest& request, inference::ModelInferResponse& response) const {
+        if (request.model_name() != model_.config().model_name) {
+            return unknown_model(request.model_name());
+        }
+        if (request.inputs_size() != 1 || request.raw_input_contents_size() != 1 || request.inputs(0).shape_size() == 0) {
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "mock server expects one raw input tensor");
+        }
+        const int64_t batch_size = request.inputs(0).shape(0);
+        const std::string error = model_.validate(batch_size, request.raw_input_contents(0).data(), request.raw_input_contents(0).size());
+        if (!error.empty()) {
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, error);
+        }
+
+        std::vector<TraceTensor> outputs;
+        try {
+            outputs = model_.run(batch_size, request.id());
+        } catch (const std::exception& e) {
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, e.what());
+        }
+
+        response.set_model_name(model_.config().model_name);
+        response.set_model_version("1");
+        response.set_id(request.id());
+        for (const TraceTensor& tensor : outputs) {
+            auto* output = response.add_outputs();
+            output->set_name(tensor.name);
+            output->set_datatype(tensor.datatype);
+            for (int64_t dim : tensor.shape) {
+                output->add_shape(dim);
+            }
+            response.add_raw_output_contents(reinterpret_cast<const char*>(tensor.data), tensor.byte_size);
+        }
+        return grpc::Status::OK;
+    }
+
+    const MockModel& model_;
+};
+
+void serve_grpc(const MockModel& model, int port) {
+    MockGrpcService service(model);
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort("0.0.0.0:" + std::to_string(port), grpc::InsecureServerCredentials());
+    builder.SetMaxReceiveMessageSize(-1);
+    builder.RegisterService(&service);
+    std::unique_ptr<grpc::Server> server = builder.BuildAndStart();
+    if (!server) {
+        std::stringstream err_msg;
+        err_msg << "Failed to start gRPC server on port " << port;
+        throw std::runtime_error(err_msg.str());
+    }
+    std::cout << "gRPC listening on 0.0.0.0:" << port << std::endl;
+    server->Wait();
+}
+#endif
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]" << std::endl;
+    std::cerr << "Options: --http-port <port>      (default 8000; health, metadata, config and infer over HTTP)" << std::endl;
+    std::cerr << "         --grpc-port <port>      (default 8001; the same over gRPC, only when built with YOLOV10_BENCH_GRPC_MOCK)" << std::endl;
+    std::cerr << "         --model <name>          (default yolov10m)" << std::endl;
+    std::cerr << "         --max-batch-size <n>    (default 1)" << std::endl;
+    std::cerr << "         --input-size <w>x<h>    (default 640x640)" << std::endl;
+    std::cerr << "         --input-datatype <FP32|UINT8|BYTES>  BYTES mimics a JPEG-decoding ensemble" << std::endl;
+    std::cerr << "         --detections <n>        non-empty rows in the canned output (default 20)" << std::endl;
+    std::cerr << "         --delay-us <us>         simulated model latency per request (default 0)" << std::endl;
+    std::cerr << "         --jitter-us <us>        uniform random extra latency (default 0)" << std::endl;
+    std::cerr << "         --trace <file>          answer with the outputs and latencies of a client trace (--record);" << std::endl;
+    std::cerr << "                                 model, input size, datatype and batch size come from the trace" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    MockConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--http-port" && i + 1 < argc) {
+            config.http_port = std::stoi(argv[++i]);
+        } else if (arg == "--grpc-port" && i + 1 < argc) {
+            config.grpc_port = std::stoi(argv[++i]);
+        } else if (arg == "--model" && i + 1 < argc) {
+            config.model_name = argv[++i];
+        } else if (arg == "--max-batch-size" && i + 1 < argc) {
+            config.max_batch_size = std::stoi(argv[++i]);
+        } else if (arg == "--input-size" && i + 1 < argc) {
+            const std::string size = argv[++i];
+            config.input_width = std::stoi(size.substr(0, size.find('x')));
+            config.input_height = std::stoi(size.substr(size.find('x') + 1));
+        } else if (arg == "--input-datatype" && i + 1 < argc) {
+            config.input_datatype = argv[++i];
+        } else if (arg == "--detections" && i + 1 < argc) {
+            config.detections = std::stoi(argv[++i]);
+        } else if (arg == "--delay-us" && i + 1 < argc) {
+            config.delay = std::chrono::microseconds(std::stoll(argv[++i]));
+        } else if (arg == "--jitter-us" && i + 1 < argc) {
+            config.jitter = std::chrono::microseconds(std::stoll(argv[++i]));
+        } else if (arg == "--trace" && i + 1 < argc) {
+            config.trace_path = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    try {
+        std::shared_ptr<const TraceReader> trace;
+        if (!config.trace_path.empty()) {
+            trace = std::make_shared<TraceReader>(config.trace_path);
+            // The recording client saw this model; serve the same one so it takes the same code paths
+            config.model_name = trace->meta("model", config.model_name);
+            config.input_width = std::stoi(trace->meta("input_width", std::to_string(config.input_width)));
+            config.input_height = std::stoi(trace->meta("input_height", std::to_string(config.input_height)));
+            config.input_datatype = trace->meta("input_datatype", config.input_datatype);
+            config.max_batch_size = std::stoi(trace->meta("max_batch_size", std::to_string(config.max_batch_size)));
+            std::cout << "Replaying " << trace->records(TraceRecordType::Output).size() << " outputs of " << config.trace_path
+                      << std::endl;
+        }
+        const MockModel model(config, trace);
+#if defined(YOLOV10_MOCK_GRPC)
+        std::thread grpc_thread(serve_grpc, std::cref(model), config.grpc_port);
+        grpc_thread.detach();
+#endif
+        serve_http(model, config.http_port);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
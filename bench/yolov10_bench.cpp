@@ -0,0 +1,470 @@
+// Load generator for the full preprocess -> infer -> postprocess path. Each worker owns a
+// TritonClient and a YOLOv10 task (with --batch the workers share one client and a DynamicBatcher
+// packs their frames into batched requests); with --rate the requests follow a fixed open-loop schedule
+// and latency is measured from the scheduled send time, so a slow server cannot hide queueing.
+// Results are printed (or written) as JSON.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <latch>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include "dynamic_batcher.h"
+#include "triton_client.h"
+#include "yolov10.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchConfig {
+    std::string host{"localhost"};
+    ProtocolType protocol{ProtocolType::HTTP};
+    int port{0}; // 0: 8000 for HTTP, 8001 for gRPC
+    std::vector<std::string> servers; // host:port endpoints; overrides host and port when set
+    bool hedge{false};
+    std::string model_name{"yolov10m"};
+    size_t concurrency{1};
+    size_t batch_size{1};
+    // Workers send single frames through one shared DynamicBatcher; batch_size then caps its batches
+    bool batch{false};
+    std::chrono::microseconds batch_delay{500};
+    double rate{0.0}; // Requests per second over all workers; 0 runs closed loop
+    double duration_seconds{10.0};
+    size_t requests{0}; // Stops after this many requests when non-zero, instead of the duration
+    size_t warmup{10};  // Unrecorded requests per worker
+    std::string image_path;
+    cv::Size frame_size{1280, 720};
+    bool letterbox{false};
+    std::string output_path;
+};
+
+enum class Stage { Preprocess = 0, Infer, Postprocess, Total, Count };
+constexpr const char* kStageNames[] = {"preprocess", "infer", "postprocess", "total"};
+
+struct WorkerResult {
+    std::vector<double> latency_us[static_cast<size_t>(Stage::Count)];
+    size_t requests{0};
+    size_t errors{0};
+    size_t detections{0};
+    std::string first_error;
+};
+
+double elapsed_us(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+class Scheduler {
+public:
+    explicit Scheduler(const BenchConfig& config) : config_{config} {}
+
+    void start() {
+        start_ = Clock::now();
+        deadline_ = start_ + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(config_.duration_seconds));
+    }
+
+    // Claims the next request; returns false when the run is over. `scheduled` is when the request
+    // should be sent: its slot in the open-loop schedule, or now in closed-loop mode.
+    bool next(Clock::time_point& scheduled) {
+        if (cancelled_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        const size_t index = next_.fetch_add(1, std::memory_order_relaxed);
+        if (config_.requests > 0 && index >= config_.requests) {
+            return false;
+        }
+        if (config_.rate > 0) {
+            scheduled = start_ + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(index / config_.rate));
+            if (config_.requests == 0 && scheduled >= deadline_) {
+                return false;
+            }
+            std::this_thread::sleep_until(scheduled);
+        } else {
+            scheduled = Clock::now();
+            if (config_.requests == 0 && scheduled >= deadline_) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+    Clock::time_point start_time() const { return start_; }
+
+private:
+    const BenchConfig& config_;
+    Clock::time_point start_;
+    Clock::time_point deadline_;
+    std::atomic<size_t> next_{0};
+    std::atomic<bool> cancelled_{false};
+};
+
+cv::Mat load_frame(const BenchConfig& config) {
+    if (!config.image_path.empty()) {
+        cv::Mat image = cv::imread(config.image_path);
+        if (image.empty()) {
+            throw std::runtime_error("Error loading image: " + config.image_path);
+        }
+        return image;
+    }
+    // Noise rather than a flat color so the preprocessing touches realistic data
+    cv::Mat frame(config.frame_size, CV_8UC3);
+    cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+    return frame;
+}
+
+// Frames per request sent by one worker; the batcher does the packing in --batch mode.
+size_t worker_batch_size(const BenchConfig& config) {
+    return config.batch ? 1 : config.batch_size;
+}
+
+LoadBalancingConfig balancing_config(const BenchConfig& config) {
+    LoadBalancingConfig balancing;
+    balancing.hedging = config.hedge;
+    return balancing;
+}
+
+// Client and batcher shared by every worker in --batch mode.
+struct SharedBatching {
+    std::unique_ptr<TritonClient> client;
+    TritonModelInfo model_info;
+    std::unique_ptr<DynamicBatcher> batcher;
+};
+
+void run_worker(const BenchConfig& config, const std::vector<std::string>& urls, const cv::Mat& frame, Scheduler& scheduler,
+                std::latch& ready, SharedBatching* shared, WorkerResult& result) {
+    std::unique_ptr<TritonClient> client;
+    std::unique_ptr<YOLOv10> task;
+    size_t frame_bytes = 0;
+    const size_t batch_size = worker_batch_size(config);
+    std::vector<uint8_t> input_data;
+    std::vector<uint8_t> encoded;
+    const std::vector<cv::Size> frame_sizes(batch_size, frame.size());
+    InferenceOutput output;
+    DetectionBatch detections;
+    uint64_t frame_id = 0;
+
+    auto run_once = [&](Clock::time_point scheduled, bool record) {
+        const Clock::time_point start = Clock::now();
+        if (frame_bytes == 0) {
+            // Encoded input: length-prefixed JPEGs back to back
+            input_data.clear();
+            for (size_t i = 0; i < batch_size; ++i) {
+                task->preprocess(frame, encoded);
+                input_data.insert(input_data.end(), encoded.begin(), encoded.end());
+            }
+        } else {
+            for (size_t i = 0; i < batch_size; ++i) {
+                task->preprocess(frame, input_data.data() + i * frame_bytes);
+            }
+        }
+        const Clock::time_point preprocessed = Clock::now();
+        Clock::time_point inferred;
+        if (shared) {
+            // The batcher takes the frame; the next one is preprocessed into a fresh buffer
+            auto pending = shared->batcher->submit(frame_id++, std::move(input_data));
+            input_data.resize(frame_bytes);
+            InferenceResult inference = pending.get();
+            inferred = Clock::now();
+            detections.clear();
+            task->postprocess(frame.size(), *inference.output, inference.batch_index, detections);
+        } else {
+            client->run_inference(input_data, output, batch_size);
+            inferred = Clock::now();
+            task->postprocess_batch(frame_sizes, output, detections);
+        }
+        const Clock::time_point end = Clock::now();
+        if (record) {
+            result.latency_us[static_cast<size_t>(Stage::Preprocess)].push_back(elapsed_us(start, preprocessed));
+            result.latency_us[static_cast<size_t>(Stage::Infer)].push_back(elapsed_us(preprocessed, inferred));
+            result.latency_us[static_cast<size_t>(Stage::Postprocess)].push_back(elapsed_us(inferred, end));
+            result.latency_us[static_cast<size_t>(Stage::Total)].push_back(elapsed_us(scheduled, end));
+            result.detections += detections.size();
+        }
+    };
+
+    try {
+        TritonModelInfo info;
+        if (shared) {
+            info = shared->model_info;
+        } else {
+            client = std::make_unique<TritonClient>(urls, config.protocol, config.model_name, "", false, balancing_config(config));
+            client->initialize_triton_client();
+            info = client->retrieve_model_info(config.model_name, {1, 3, 640, 640});
+        }
+        task = std::make_unique<YOLOv10>(info.input_width, info.input_height, info.input_format, info.input_datatype);
+        if (config.letterbox) {
+            task->set_resize_mode(ResizeMode::Letterbox);
+        }
+        frame_bytes = task->input_byte_size();
+        input_data.resize(frame_bytes * batch_size);
+        for (size_t i = 0; i < config.warmup; ++i) {
+            run_once(Clock::now(), false);
+        }
+    } catch (...) {
+        // Release the other workers; the run is cancelled and the error reported
+        scheduler.cancel();
+        ready.count_down();
+        throw;
+    }
+    ready.arrive_and_wait();
+
+    Clock::time_point scheduled;
+    while (scheduler.next(scheduled)) {
+        try {
+            run_once(scheduled, true);
+            ++result.requests;
+        } catch (const std::exception& e) {
+            if (result.errors++ == 0) {
+                result.first_error = e.what();
+            }
+        }
+    }
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    // Nearest rank
+    const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+void write_latency_json(std::ostream& out, std::vector<double>& samples) {
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double sample : samples) {
+        sum += sample;
+    }
+    out << "{\"count\":" << samples.size() << ",\"mean\":" << (samples.empty() ? 0.0 : sum / samples.size())
+        << ",\"min\":" << (samples.empty() ? 0.0 : samples.front()) << ",\"p50\":" << percentile(samples, 50)
+        << ",\"p90\":" << percentile(samples, 90) << ",\"p99\":" << percentile(samples, 99)
+        << ",\"p99.9\":" << percentile(samples, 99.9) << ",\"max\":" << (samples.empty() ? 0.0 : samples.back()) << "}";
+}
+
+// Power-of-two microsecond buckets of the end-to-end latency; samples must be sorted.
+void write_histogram_json(std::ostream& out, const std::vector<double>& sorted) {
+    out << "[";
+    size_t begin = 0;
+    bool first = true;
+    for (double bound = 64.0; begin < sorted.size(); bound *= 2.0) {
+        const size_t end = std::upper_bound(sorted.begin() + begin, sorted.end(), bound) - sorted.begin();
+        if (end > begin) {
+            out << (first ? "" : ",") << "{\"le_us\":" << bound << ",\"count\":" << end - begin << "}";
+            first = false;
+        }
+        begin = end;
+    }
+    out << "]";
+}
+
+std::string json_escape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c == '\n' ? ' ' : c;
+    }
+    return escaped;
+}
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]" << std::endl;
+    std::cerr << "Options: --host <host>            Triton host (default localhost)" << std::endl;
+    std::cerr << "         --protocol <http|grpc>   (default http)" << std::endl;
+    std::cerr << "         --port <port>            inference port (default 8000 for HTTP, 8001 for gRPC)" << std::endl;
+    std::cerr << "         --servers <host:port,...>  balance over several endpoints instead of --host/--port" << std::endl;
+    std::cerr << "         --hedge                  re-send slow requests to a second endpoint" << std::endl;
+    std::cerr << "         --model <name>           (default yolov10m)" << std::endl;
+    std::cerr << "         --concurrency <n>        workers, each with its own client (default 1)" << std::endl;
+    std::cerr << "         --batch-size <n>         frames per request (default 1)" << std::endl;
+    std::cerr << "         --batch                  share one client and pack single frames from all workers with the" << std::endl;
+    std::cerr << "                                  dynamic batcher, up to --batch-size frames (default: model max_batch_size)" << std::endl;
+    std::cerr << "         --batch-delay <us>       longest wait for a batch to fill (default 500)" << std::endl;
+    std::cerr << "         --rate <rps>             open-loop request rate over all workers (default: closed loop)" << std::endl;
+    std::cerr << "         --duration <s>           (default 10)" << std::endl;
+    std::cerr << "         --requests <n>           stop after n requests instead of a duration" << std::endl;
+    std::cerr << "         --warmup <n>             unrecorded requests per worker (default 10)" << std::endl;
+    std::cerr << "         --image <path>           input frame (default: 1280x720 noise)" << std::endl;
+    std::cerr << "         --letterbox              letterbox instead of stretch resize" << std::endl;
+    std::cerr << "         --output <file.json>     write the report to a file instead of stdout" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--host" && i + 1 < argc) {
+            config.host = argv[++i];
+        } else if (arg == "--protocol" && i + 1 < argc) {
+            std::string protocol = argv[++i];
+            if (protocol != "http" && protocol != "grpc") {
+                print_usage(argv[0]);
+                return 1;
+            }
+            config.protocol = protocol == "grpc" ? ProtocolType::GRPC : ProtocolType::HTTP;
+        } else if (arg == "--port" && i + 1 < argc) {
+            config.port = std::stoi(argv[++i]);
+        } else if (arg == "--servers" && i + 1 < argc) {
+            std::stringstream list(argv[++i]);
+            for (std::string server; std::getline(list, server, ',');) {
+                if (!server.empty()) {
+                    config.servers.push_back(server);
+                }
+            }
+        } else if (arg == "--hedge") {
+            config.hedge = true;
+        } else if (arg == "--model" && i + 1 < argc) {
+            config.model_name = argv[++i];
+        } else if (arg == "--concurrency" && i + 1 < argc) {
+            config.concurrency = std::max<size_t>(1, std::stoul(argv[++i]));
+        } else if (arg == "--batch-size" && i + 1 < argc) {
+            config.batch_size = std::max<size_t>(1, std::stoul(argv[++i]));
+        } else if (arg == "--batch") {
+            config.batch = true;
+        } else if (arg == "--batch-delay" && i + 1 < argc) {
+            config.batch_delay = std::chrono::microseconds(std::stoll(argv[++i]));
+        } else if (arg == "--rate" && i + 1 < argc) {
+            config.rate = std::stod(argv[++i]);
+        } else if (arg == "--duration" && i + 1 < argc) {
+            config.duration_seconds = std::stod(argv[++i]);
+        } else if (arg == "--requests" && i + 1 < argc) {
+            config.requests = std::stoul(argv[++i]);
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            config.warmup = std::stoul(argv[++i]);
+        } else if (arg == "--image" && i + 1 < argc) {
+            config.image_path = argv[++i];
+        } else if (arg == "--letterbox") {
+            config.letterbox = true;
+        } else if (arg == "--output" && i + 1 < argc) {
+            config.output_path = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<std::string> urls = config.servers;
+    if (urls.empty()) {
+        const int port = config.port ? config.port : (config.protocol == ProtocolType::GRPC ? 8001 : 8000);
+        urls.push_back(config.host + ":" + std::to_string(port));
+    }
+
+    std::vector<WorkerResult> results(config.concurrency);
+    Clock::time_point end;
+    Scheduler scheduler(config);
+    std::unique_ptr<SharedBatching> shared;
+    BatcherStats batcher_stats;
+    try {
+        const cv::Mat frame = load_frame(config);
+        if (config.batch) {
+            shared = std::make_unique<SharedBatching>();
+            shared->client = std::make_unique<TritonClient>(urls, config.protocol, config.model_name, "", false,
+                                                            balancing_config(config));
+            shared->client->initialize_triton_client();
+            shared->model_info = shared->client->retrieve_model_info(config.model_name, {1, 3, 640, 640});
+            BatcherConfig batcher_config;
+            batcher_config.max_batch_size = config.batch_size > 1 ? config.batch_size : 0;
+            batcher_config.max_queue_delay = config.batch_delay;
+            // Enough batches outstanding that every worker's frame can be on the wire at once
+            batcher_config.max_in_flight = config.concurrency;
+            shared->batcher = std::make_unique<DynamicBatcher>(*shared->client, shared->model_info, batcher_config);
+        }
+        std::latch ready(static_cast<std::ptrdiff_t>(config.concurrency) + 1);
+        std::vector<std::thread> workers;
+        std::mutex error_mutex;
+        std::exception_ptr setup_error;
+        for (size_t i = 0; i < config.concurrency; ++i) {
+            workers.emplace_back([&, i] {
+                try {
+                    run_worker(config, urls, frame, scheduler, ready, shared.get(), results[i]);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!setup_error) {
+                        setup_error = std::current_exception();
+                    }
+                }
+            });
+        }
+        ready.arrive_and_wait();
+        scheduler.start();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        end = Clock::now();
+        if (shared) {
+            batcher_stats = shared->batcher->stats();
+        }
+        if (setup_error) {
+            std::rethrow_exception(setup_error);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    WorkerResult total;
+    for (WorkerResult& result : results) {
+        for (size_t s = 0; s < static_cast<size_t>(Stage::Count); ++s) {
+            auto& samples = total.latency_us[s];
+            samples.insert(samples.end(), result.latency_us[s].begin(), result.latency_us[s].end());
+        }
+        total.requests += result.requests;
+        total.errors += result.errors;
+        total.detections += result.detections;
+        if (total.first_error.empty()) {
+            total.first_error = result.first_error;
+        }
+    }
+    const double seconds = std::chrono::duration<double>(end - scheduler.start_time()).count();
+
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(1);
+    json << "{\"config\":{\"urls\":[";
+    for (size_t i = 0; i < urls.size(); ++i) {
+        json << (i ? "," : "") << "\"" << urls[i] << "\"";
+    }
+    json << "],\"protocol\":\""
+         << (config.protocol == ProtocolType::GRPC ? "grpc" : "http") << "\",\"model\":\"" << config.model_name
+         << "\",\"concurrency\":" << config.concurrency << ",\"batch_size\":" << config.batch_size
+         << ",\"batch\":" << (config.batch ? "true" : "false")
+         << ",\"rate\":" << config.rate << ",\"hedge\":" << (config.hedge ? "true" : "false")
+         << ",\"letterbox\":" << (config.letterbox ? "true" : "false") << "},";
+    json << "\"duration_s\":" << std::setprecision(3) << seconds << std::setprecision(1) << ",\"requests\":" << total.requests
+         << ",\"errors\":" << total.errors << ",\"throughput_rps\":" << total.requests / seconds
+         << ",\"throughput_fps\":" << total.requests * worker_batch_size(config) / seconds
+         << ",\"detections\":" << total.detections << ",";
+    if (config.batch) {
+        json << "\"batcher\":{\"batches\":" << batcher_stats.batches << ",\"frames\":" << batcher_stats.frames
+             << ",\"average_batch_size\":" << std::setprecision(2) << batcher_stats.average_batch_size()
+             << std::setprecision(1) << "},";
+    }
+    if (!total.first_error.empty()) {
+        json << "\"first_error\":\"" << json_escape(total.first_error) << "\",";
+    }
+    json << "\"latency_us\":{";
+    for (size_t s = 0; s < static_cast<size_t>(Stage::Count); ++s) {
+        json << (s ? "," : "") << "\"" << kStageNames[s] << "\":";
+        write_latency_json(json, total.latency_us[s]);
+    }
+    json << "},\"histogram_us\":";
+    write_histogram_json(json, total.latency_us[static_cast<size_t>(Stage::Total)]);
+    json << "}";
+
+    if (config.output_path.empty()) {
+        std::cout << json.str() << std::endl;
+    } else {
+        std::ofstream file(config.output_path);
+        file << json.str() << std::endl;
+    }
+    return total.errors == 0 ? 0 : 2;
+}
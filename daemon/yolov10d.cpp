@@ -0,0 +1,423 @@
+// Long-running detection service: keeps a pool of warm clients (channel set up, model
+// configuration parsed) and answers requests on a Unix domain socket, so callers pay a socket
+// round trip per image instead of process start-up. Images arrive as a passed file descriptor,
+// which is mapped read-only in place when it is a memfd sealed against shrinking and read otherwise,
+// or inline for small encoded files. The wire format is in
+// include/daemon_protocol.h; libyolov10client's DaemonConnection is the client side.
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <poll.h>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include "daemon_protocol.h"
+#include "metrics.h"
+#include "yolov10client.h"
+
+namespace {
+
+std::atomic<bool> g_stop{false};
+
+void handle_signal(int) {
+    g_stop.store(true);
+}
+
+struct DaemonConfig {
+    std::string socket_path{yolov10::DaemonConnection::default_socket_path()};
+    yolov10::ClientOptions client;
+    size_t workers{2};
+    int metrics_port{0};
+};
+
+// Warm clients handed out one request at a time.
+class ClientPool {
+public:
+    ClientPool(const yolov10::ClientOptions& options, size_t size) {
+        for (size_t i = 0; i < std::max<size_t>(1, size); ++i) {
+            clients_.push_back(std::make_unique<yolov10::Client>(options));
+            idle_.push_back(clients_.back().get());
+        }
+    }
+
+    std::vector<yolov10::Detection> detect(const yolov10::ImageView& image) {
+        yolov10::Client* client;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return !idle_.empty(); });
+            client = idle_.back();
+            idle_.pop_back();
+        }
+        try {
+            std::vector<yolov10::Detection> detections = client->detect(image);
+            release(client);
+            return detections;
+        } catch (...) {
+            release(client);
+            throw;
+        }
+    }
+
+private:
+    void release(yolov10::Client* client) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            idle_.push_back(client);
+        }
+        cv_.notify_one();
+    }
+
+    std::vector<std::unique_ptr<yolov10::Client>> clients_;
+    std::vector<yolov10::Client*> idle_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+// Read-only view of `size` bytes at `offset` in a passed descriptor. Only a memfd sealed with
+// F_SEAL_SHRINK is mapped in place: the caller could truncate any other file during the request,
+// and touching the lost pages would kill the daemon with SIGBUS. Other descriptors are read into a buffer.
+class PassedImage {
+public:
+    PassedImage(int fd, uint64_t offset, uint64_t size) {
+        if (size == 0 || offset + size < offset) {
+            throw_out_of_range(offset, size);
+        }
+        // Seals first: once F_SEAL_SHRINK is set the size seen by fstat can no longer drop under the mapping
+        const int seals = fcntl(fd, F_GET_SEALS);
+        if (seals != -1 && (seals & F_SEAL_SHRINK)) {
+            check_range(fd, offset, size);
+            map(fd, offset, size);
+        } else {
+            // Only bounds the allocation; a file truncated after this is caught by pread
+            check_range(fd, offset, size);
+            read_into_buffer(fd, offset, size);
+        }
+    }
+    ~PassedImage() {
+        if (base_) {
+            munmap(base_, length_);
+        }
+    }
+
+    PassedImage(const PassedImage&) = delete;
+    PassedImage& operator=(const PassedImage&) = delete;
+
+    const uint8_t* data() const { return data_; }
+
+private:
+    static void check_range(int fd, uint64_t offset, uint64_t size) {
+        struct stat st {};
+        if (fstat(fd, &st) == -1 || offset + size > static_cast<uint64_t>(st.st_size)) {
+            throw_out_of_range(offset, size);
+        }
+    }
+
+    [[noreturn]] static void throw_out_of_range(uint64_t offset, uint64_t size) {
+        std::stringstream err_msg;
+        err_msg << "Image of " << size << " bytes at offset " << offset << " is outside the passed file.";
+        throw std::runtime_error(err_msg.str());
+    }
+
+    void map(int fd, uint64_t offset, uint64_t size) {
+        // mmap offsets must be page aligned
+        const uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+        const uint64_t aligned = offset - offset % page;
+        length_ = static_cast<size_t>(offset - aligned + size);
+        void* addr = mmap(nullptr, length_, PROT_READ, MAP_SHARED, fd, static_cast<off_t>(aligned));
+        if (addr == MAP_FAILED) {
+            std::stringstream err_msg;
+            err_msg << "Failed to map the passed image: " << std::strerror(errno);
+            throw std::runtime_error(err_msg.str());
+        }
+        base_ = static_cast<uint8_t*>(addr);
+        data_ = base_ + (offset - aligned);
+    }
+
+    void read_into_buffer(int fd, uint64_t offset, uint64_t size) {
+        buffer_.resize(static_cast<size_t>(size));
+        size_t done = 0;
+        while (done < buffer_.size()) {
+            const ssize_t n = pread(fd, buffer_.data() + done, buffer_.size() - done, static_cast<off_t>(offset + done));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                std::stringstream err_msg;
+                err_msg << "Failed to read the passed image: " << (n < 0 ? std::strerror(errno) : "file truncated");
+                throw std::runtime_error(err_msg.str());
+            }
+            done += static_cast<size_t>(n);
+        }
+        data_ = buffer_.data();
+    }
+
+    uint8_t* base_{nullptr};
+    size_t length_{0};
+    std::vector<uint8_t> buffer_;
+    const uint8_t* data_{nullptr};
+};
+
+// Closes a passed descriptor once its request is answered.
+struct FdGuard {
+    int fd;
+    ~FdGuard() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+};
+
+void send_response(int socket, int32_t status, const std::string& error, const std::vector<yolov10::Detection>& detections) {
+    if (detections.size() > kDaemonMaxDetections) {
+        send_response(socket, -1, "too many detections for one response; lower --max-det", {});
+        return;
+    }
+    const size_t error_length = std::min<size_t>(error.size(), kDaemonMaxErrorBytes);
+    DaemonResponse response{kDaemonResponseMagic, status, static_cast<uint32_t>(detections.size()),
+                            static_cast<uint32_t>(error_length)};
+    std::vector<uint8_t> payload(error.begin(), error.begin() + error_length);
+    const auto* detection_bytes = reinterpret_cast<const uint8_t*>(detections.data());
+    payload.insert(payload.end(), detection_bytes, detection_bytes + detections.size() * sizeof(yolov10::Detection));
+    send_message(socket, &response, sizeof(response), payload.data(), payload.size());
+}
+
+// One request after another until the peer hangs up or breaks the protocol.
+void serve_connection(int socket, ClientPool& pool) {
+    std::vector<uint8_t> inline_data;
+    while (true) {
+        DaemonRequest request{};
+        int fd = -1;
+        if (!receive_exact(socket, &request, sizeof(request), &fd)) {
+            return;
+        }
+        const FdGuard fd_guard{fd};
+        if (request.magic != kDaemonRequestMagic || request.version != kDaemonProtocolVersion ||
+            (request.has_fd != 0) != (fd >= 0) || (!request.has_fd && request.size > kDaemonMaxInlineBytes)) {
+            // Anything after a malformed header cannot be framed
+            send_response(socket, -1, "malformed request", {});
+            return;
+        }
+        if (!request.has_fd) {
+            inline_data.resize(request.size);
+            if (!receive_exact(socket, inline_data.data(), inline_data.size())) {
+                return;
+            }
+        }
+
+        std::vector<yolov10::Detection> detections;
+        try {
+            std::unique_ptr<PassedImage> passed;
+            yolov10::ImageView image;
+            if (request.has_fd) {
+                passed = std::make_unique<PassedImage>(fd, request.offset, request.size);
+                image.data = passed->data();
+            } else {
+                image.data = inline_data.data();
+            }
+            image.size = request.size;
+            image.format = request.format == static_cast<uint32_t>(yolov10::ImageFormat::Encoded) ? yolov10::ImageFormat::Encoded
+                                                                                                 : yolov10::ImageFormat::Bgr;
+            image.width = request.width;
+            image.height = request.height;
+            image.stride = request.stride;
+            detections = pool.detect(image);
+        } catch (const std::exception& e) {
+            send_response(socket, -1, e.what(), {});
+            continue;
+        }
+        send_response(socket, 0, std::string(), detections);
+    }
+}
+
+int listen_on(const std::string& path) {
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) {
+        std::stringstream err_msg;
+        err_msg << "Socket path is too long: " << path;
+        throw std::runtime_error(err_msg.str());
+    }
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        std::stringstream err_msg;
+        err_msg << "Failed to create socket: " << std::strerror(errno);
+        throw std::runtime_error(err_msg.str());
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    struct stat st {};
+    if (lstat(path.c_str(), &st) == 0) {
+        std::stringstream err_msg;
+        if (!S_ISSOCK(st.st_mode)) {
+            err_msg << path << " exists and is not a socket; refusing to replace it.";
+        } else {
+            const int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            const bool live = probe != -1 && connect(probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+            if (probe != -1) {
+                close(probe);
+            }
+            if (live) {
+                err_msg << "Another yolov10d is already listening on " << path << ".";
+            } else {
+                // Left behind by an instance that did not shut down cleanly; it would make bind fail
+                unlink(path.c_str());
+            }
+        }
+        if (!err_msg.str().empty()) {
+            close(fd);
+            throw std::runtime_error(err_msg.str());
+        }
+    }
+    if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1) {
+        std::stringstream err_msg;
+        err_msg << "Failed to bind " << path << ": " << std::strerror(errno);
+        close(fd);
+        throw std::runtime_error(err_msg.str());
+    }
+    // Owner only: requests run on the daemon's servers. Set before listen() so nobody connects earlier.
+    if (chmod(path.c_str(), S_IRUSR | S_IWUSR) == -1 || listen(fd, 64) == -1) {
+        std::stringstream err_msg;
+        err_msg << "Failed to listen on " << path << ": " << std::strerror(errno);
+        close(fd);
+        unlink(path.c_str());
+        throw std::runtime_error(err_msg.str());
+    }
+    return fd;
+}
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--socket <path>] [--server <host:port,...>] [--http] [--model <name>] [--workers <n>]" << std::endl;
+    std::cerr << "Options: --socket <path>      Unix socket to listen on (default $YOLOV10_DAEMON_SOCKET or /tmp/yolov10d.sock)" << std::endl;
+    std::cerr << "         --workers <n>        warm clients, i.e. requests processed at once (default 2)" << std::endl;
+    std::cerr << "         --conf <t>           confidence threshold (default 0.1)" << std::endl;
+    std::cerr << "         --max-det <n>        keep the n highest-scoring detections per image" << std::endl;
+    std::cerr << "         --letterbox          keep the aspect ratio and pad instead of stretching" << std::endl;
+    std::cerr << "         --warmup <n>         send n dummy requests per client before accepting connections" << std::endl;
+    std::cerr << "         --metrics-port <p>   serve Prometheus metrics on http://127.0.0.1:<p>/metrics" << std::endl;
+}
+
+std::vector<std::string> split_list(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    DaemonConfig config;
+    bool servers_set = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            config.socket_path = argv[++i];
+        } else if (arg == "--server" && i + 1 < argc) {
+            config.client.servers = split_list(argv[++i]);
+            servers_set = true;
+        } else if (arg == "--http") {
+            config.client.http = true;
+        } else if (arg == "--model" && i + 1 < argc) {
+            config.client.model = argv[++i];
+        } else if (arg == "--workers" && i + 1 < argc) {
+            config.workers = std::stoul(argv[++i]);
+        } else if (arg == "--conf" && i + 1 < argc) {
+            config.client.confidence_threshold = std::stof(argv[++i]);
+        } else if (arg == "--max-det" && i + 1 < argc) {
+            config.client.max_detections = std::stoul(argv[++i]);
+        } else if (arg == "--letterbox") {
+            config.client.letterbox = true;
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            config.client.warmup_requests = std::stoul(argv[++i]);
+        } else if (arg == "--metrics-port" && i + 1 < argc) {
+            config.metrics_port = std::stoi(argv[++i]);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!servers_set && config.client.http) {
+        config.client.servers = {"localhost:8000"};
+    }
+
+    std::signal(SIGINT, handle_signal);
+    std::signal(SIGTERM, handle_signal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::unique_ptr<MetricsServer> metrics_server;
+    if (config.metrics_port > 0) {
+        metrics_server = std::make_unique<MetricsServer>(config.metrics_port);
+    }
+    const auto startup_begin = std::chrono::steady_clock::now();
+    ClientPool pool(config.client, config.workers);
+    const int listen_fd = listen_on(config.socket_path);
+    std::cout << "yolov10d: " << config.workers << " clients for " << config.client.model << " ready in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startup_begin).count()
+              << " ms, listening on " << config.socket_path << std::endl;
+
+    struct Connection {
+        int socket;
+        std::thread thread;
+        std::atomic<bool> done{false};
+    };
+    std::list<Connection> connections;
+    while (!g_stop.load()) {
+        // Reap finished connections so a long-running daemon does not accumulate threads
+        for (auto it = connections.begin(); it != connections.end();) {
+            if (it->done.load()) {
+                it->thread.join();
+                close(it->socket);
+                it = connections.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        pollfd listener{listen_fd, POLLIN, 0};
+        if (poll(&listener, 1, 500) <= 0) {
+            continue;
+        }
+        const int socket = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (socket == -1) {
+            continue;
+        }
+        Connection& connection = connections.emplace_back();
+        connection.socket = socket;
+        connection.thread = std::thread([&connection, &pool] {
+            try {
+                serve_connection(connection.socket, pool);
+            } catch (const std::exception& e) {
+                std::cerr << "yolov10d: connection closed: " << e.what() << std::endl;
+            }
+            connection.done.store(true);
+        });
+    }
+
+    std::cout << "yolov10d: shutting down" << std::endl;
+    close(listen_fd);
+    unlink(config.socket_path.c_str());
+    for (Connection& connection : connections) {
+        // Wakes threads blocked reading the next request; one in the middle of a request finishes it
+        shutdown(connection.socket, SHUT_RD);
+    }
+    for (Connection& connection : connections) {
+        connection.thread.join();
+        close(connection.socket);
+    }
+    return 0;
+}
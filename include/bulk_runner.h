@@ -0,0 +1,106 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "common.h"
+#include "result_cache.h"
+#include "triton_client.h"
+#include "yolov10.h"
+
+enum class BulkOutputFormat { Jsonl = 0, Binary };
+
+// Binary record file: the 8-byte magic "YV10DET1", then one record per image in input order, all
+// little-endian:
+//   u64 index, u32 path_length, path bytes, i32 width, i32 height,
+//   u32 error_length, error bytes (0 on success), u32 detection_count,
+//   detection_count x { f32 x1, f32 y1, f32 x2, f32 y2, f32 score, i32 class_id }
+constexpr char kBulkBinaryMagic[8] = {'Y', 'V', '1', '0', 'D', 'E', 'T', '1'};
+
+struct BulkConfig {
+    std::string input;  // Directory (searched recursively for images) or manifest with one path per line
+    std::string output; // Results, written in input order
+    BulkOutputFormat format{BulkOutputFormat::Jsonl};
+    size_t decode_threads{4};
+    size_t max_in_flight{8};
+    // Images admitted ahead of the oldest one not yet written; bounds memory however large the input is.
+    size_t window{64};
+    // Records between checkpoints; a resumed run repeats at most this many images.
+    size_t checkpoint_interval{1000};
+    // Continue from `<output>.ckpt` instead of starting over.
+    bool resume{false};
+};
+
+struct BulkStats {
+    uint64_t processed{0}; // Images written in this run, including failures
+    uint64_t failed{0};    // Unreadable images and failed requests
+    uint64_t resumed_from{0};
+    double elapsed_seconds{0.0};
+};
+
+// Offline detection over a directory or manifest of images: a pool of threads decodes and
+// preprocesses, requests go out through TritonClient::run_inference_async and the calling thread
+// postprocesses and streams records to JSONL or the binary format above. Only the window of
+// in-progress images is kept in memory. A directory is listed once into `<output>.manifest`, which
+// fixes the order so that `<output>.ckpt` (next index and output offset) can resume the run.
+class BulkRunner {
+public:
+    BulkRunner(TritonClient& triton_client, const TritonModelInfo& model_info, const PostprocessConfig& postprocess_config,
+               ResizeMode resize_mode, const BulkConfig& config);
+    ~BulkRunner();
+
+    BulkRunner(const BulkRunner&) = delete;
+    BulkRunner& operator=(const BulkRunner&) = delete;
+
+    // Duplicates found in the cache skip decoding (exact keys) or preprocessing and inference.
+    void set_result_cache(std::shared_ptr<ResultCache> cache) { result_cache_ = std::move(cache); }
+    BulkStats run();
+
+private:
+    struct Slot {
+        uint64_t index{0};
+        std::string path;
+        cv::Size frame_size;
+        InferenceResult result;
+        std::string error;
+        std::optional<uint64_t> cache_key;
+        std::optional<std::vector<Detection>> cached; // Set instead of `result` on a cache hit
+        bool ready{false};
+    };
+
+    std::string prepare_manifest() const;
+    void read_loop(const std::string& manifest, uint64_t first_index);
+    void decode_loop();
+    void complete(uint64_t index, InferenceResult&& result, std::string error);
+    void complete_cached(uint64_t index, std::vector<Detection>&& detections);
+    void write_record(const Slot& slot, const std::vector<Detection>& detections);
+    void write_checkpoint(uint64_t next_index);
+    void fail(std::exception_ptr error);
+
+    TritonClient& triton_client_;
+    const TritonModelInfo& model_info_;
+    PostprocessConfig postprocess_config_;
+    ResizeMode resize_mode_;
+    BulkConfig config_;
+    std::shared_ptr<ResultCache> result_cache_;
+    std::ofstream output_;
+
+    // Window of in-progress images; image i lives in slots_[i % window]
+    std::vector<Slot> slots_;
+    uint64_t next_write_{0};
+    uint64_t admitted_{0};
+    bool input_done_{false};
+    std::deque<std::pair<uint64_t, std::string>> decode_queue_;
+    bool stop_{false};
+    std::exception_ptr error_;
+    std::mutex mutex_;
+    std::condition_variable admit_cv_;
+    std::condition_variable decode_cv_;
+    std::condition_variable write_cv_;
+    // run_inference_async is called from every decode thread; the HTTP client is not thread-safe
+    std::mutex submit_mutex_;
+    std::vector<std::thread> threads_;
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "yolov10client.h"
+
+// Wire format of the yolov10d Unix-socket API. The socket is local, so fields are in native
+// byte order. Each request is a DaemonRequest, sent with the image descriptor attached as
+// SCM_RIGHTS when `has_fd` is set and followed by `size` image bytes otherwise. Each response is
+// a DaemonResponse followed by `error_length` bytes of message and `count` yolov10::Detection.
+constexpr uint32_t kDaemonRequestMagic = 0x52303159;  // "Y10R"
+constexpr uint32_t kDaemonResponseMagic = 0x41303159; // "Y10A"
+constexpr uint32_t kDaemonProtocolVersion = 1;
+// Inline images larger than this must be passed as a descriptor.
+constexpr uint64_t kDaemonMaxInlineBytes = 64ull << 20;
+// Bounds on a response, checked by the client before it allocates; the daemon truncates longer errors.
+constexpr uint32_t kDaemonMaxDetections = 1u << 16;
+constexpr uint32_t kDaemonMaxErrorBytes = 4096;
+
+struct DaemonRequest {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format; // yolov10::ImageFormat
+    uint32_t has_fd;
+    int32_t width;
+    int32_t height;
+    uint64_t stride;
+    uint64_t offset; // Of the image in the passed descriptor
+    uint64_t size;
+};
+static_assert(sizeof(DaemonRequest) == 48, "DaemonRequest layout is part of the protocol");
+
+struct DaemonResponse {
+    uint32_t magic;
+    int32_t status; // 0 on success
+    uint32_t count;
+    uint32_t error_length;
+};
+static_assert(sizeof(DaemonResponse) == 16, "DaemonResponse layout is part of the protocol");
+static_assert(sizeof(yolov10::Detection) == 24, "Detection layout is part of the protocol");
+
+// Writes `header` then `payload` in full, attaching `fd` to the first byte when it is >= 0.
+void send_message(int socket, const void* header, size_t header_size, const void* payload, size_t payload_size, int fd = -1);
+// Reads exactly `size` bytes. Returns false if the peer closed the socket before the first byte;
+// a descriptor passed along with the bytes is stored in `fd` (-1 if none).
+bool receive_exact(int socket, void* data, size_t size, int* fd = nullptr);
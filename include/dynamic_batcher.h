@@ -0,0 +1,62 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include "common.h"
+#include "triton_client.h"
+
+struct BatcherConfig {
+    // 0 uses the model's max_batch_size.
+    size_t max_batch_size{0};
+    // Longest time the oldest queued frame waits for a batch to fill before it is sent anyway.
+    std::chrono::microseconds max_queue_delay{500};
+    // Batches outstanding at once; the batcher raises the client's own limit to match.
+    size_t max_in_flight{2};
+};
+
+struct BatcherStats {
+    uint64_t batches{0};
+    uint64_t frames{0};
+    double average_batch_size() const { return batches ? static_cast<double>(frames) / batches : 0.0; }
+};
+
+// Packs preprocessed frames from any number of callers into one contiguous [N,C,H,W] request,
+// flushing when N reaches the batch limit or the oldest frame has waited max_queue_delay.
+// Each frame's result shares the [N,...] response; InferenceResult::batch_index selects its slice.
+// Batches are sent with the asynchronous client, so the next batch fills while earlier ones are on the wire.
+class DynamicBatcher {
+public:
+    DynamicBatcher(TritonClient& triton_client, const TritonModelInfo& model_info,
+                   const BatcherConfig& config = BatcherConfig());
+    ~DynamicBatcher();
+
+    std::future<InferenceResult> submit(uint64_t frame_id, std::vector<uint8_t> input_data);
+    BatcherStats stats() const;
+    size_t max_batch_size() const { return max_batch_size_; }
+
+private:
+    struct PendingFrame {
+        uint64_t frame_id;
+        std::vector<uint8_t> input_data;
+        std::promise<InferenceResult> promise;
+        std::chrono::steady_clock::time_point enqueue_time;
+    };
+
+    void worker_loop();
+    void send_batch(std::vector<PendingFrame>&& batch);
+
+    TritonClient& triton_client_;
+    size_t frame_byte_size_; // 0 for encoded images, which vary in size
+    size_t max_batch_size_;
+    std::chrono::microseconds max_queue_delay_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<PendingFrame> queue_;
+    bool stop_{false};
+    BatcherStats stats_;
+    uint64_t next_batch_id_{0};
+    std::thread worker_;
+};
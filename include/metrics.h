@@ -0,0 +1,156 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+// Log-linear latency histogram in microseconds (HDR style): 8 linear sub-buckets per power of two,
+// so any recorded value is within 12.5% of its bucket bound, up to ~2^40 us. Recording is a
+// single relaxed atomic increment per field; it never locks or allocates.
+class Histogram {
+public:
+    static constexpr int kSubBucketBits = 3;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kMaxMagnitude = 40; // Values from 2^41 us up share the last bucket
+    static constexpr size_t kBucketCount = (kMaxMagnitude - kSubBucketBits + 2) * kSubBuckets;
+
+    void record(uint64_t value_us) {
+        buckets_[bucket_index(value_us)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_us_.fetch_add(value_us, std::memory_order_relaxed);
+    }
+    void record(std::chrono::steady_clock::duration duration) {
+        record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count()));
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum_us() const { return sum_us_.load(std::memory_order_relaxed); }
+    uint64_t bucket(size_t index) const { return buckets_[index].load(std::memory_order_relaxed); }
+    // Number of recorded values <= `bound_us`, rounded to bucket resolution.
+    uint64_t count_at_or_below(uint64_t bound_us) const;
+    // Upper bound of the bucket holding the `q` quantile (0..1); 0 when empty.
+    uint64_t quantile_us(double q) const;
+
+    static size_t bucket_index(uint64_t value_us);
+    // Largest value that falls into bucket `index`.
+    static uint64_t bucket_upper_bound(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_us_{0};
+};
+
+class Counter {
+public:
+    void add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+class Gauge {
+public:
+    void set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+    void add(int64_t delta) { value_.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+// Client-side time split of one request: preprocess -> serialize (bind the input tensor) ->
+// network (send, server, receive) -> deserialize (index the response) -> postprocess.
+enum class MetricStage { Preprocess = 0, Serialize, Network, Deserialize, Postprocess, Count };
+enum class MetricCounter { Frames = 0, Requests, Errors, DroppedFrames, Hedges, EndpointEjections, SkippedFrames, Count };
+// Queue depths between pipeline stages plus requests in flight and frames waiting in the batcher.
+enum class MetricGauge { CaptureQueue = 0, PreprocessQueue, InferQueue, InFlight, BatcherQueue, Count };
+
+const char* metric_stage_name(MetricStage stage);
+
+// Process-wide metrics, fixed at compile time so the hot path never looks anything up by name.
+class ClientMetrics {
+public:
+    Histogram& latency(MetricStage stage) { return latency_[static_cast<size_t>(stage)]; }
+    Counter& counter(MetricCounter counter) { return counters_[static_cast<size_t>(counter)]; }
+    Gauge& gauge(MetricGauge gauge) { return gauges_[static_cast<size_t>(gauge)]; }
+    const Histogram& latency(MetricStage stage) const { return latency_[static_cast<size_t>(stage)]; }
+    const Counter& counter(MetricCounter counter) const { return counters_[static_cast<size_t>(counter)]; }
+    const Gauge& gauge(MetricGauge gauge) const { return gauges_[static_cast<size_t>(gauge)]; }
+
+    // Prometheus text exposition format (version 0.0.4).
+    std::string render_prometheus() const;
+
+    // Appends to every render. For metrics whose label values are only known at runtime, such
+    // as per-stream counters; the collector must stay valid until removed.
+    using Collector = std::function<void(std::ostream&)>;
+    size_t add_collector(Collector collector);
+    void remove_collector(size_t id);
+
+private:
+    std::array<Histogram, static_cast<size_t>(MetricStage::Count)> latency_;
+    std::array<Counter, static_cast<size_t>(MetricCounter::Count)> counters_;
+    std::array<Gauge, static_cast<size_t>(MetricGauge::Count)> gauges_;
+    mutable std::mutex collectors_mutex_;
+    std::map<size_t, Collector> collectors_;
+    size_t next_collector_{0};
+};
+
+ClientMetrics& client_metrics();
+
+// Records the lifetime of the enclosing scope into a stage histogram.
+class ScopedTimer {
+public:
+    explicit ScopedTimer(MetricStage stage)
+        : histogram_{client_metrics().latency(stage)}, start_{std::chrono::steady_clock::now()} {}
+    ~ScopedTimer() { histogram_.record(std::chrono::steady_clock::now() - start_); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram& histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Serves GET /metrics on a local port from a background thread.
+class MetricsServer {
+public:
+    // `bind_address` defaults to loopback; use "0.0.0.0" to let a remote Prometheus scrape it.
+    explicit MetricsServer(int port, const std::string& bind_address = "127.0.0.1");
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+private:
+    void serve();
+
+    int listen_fd_{-1};
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+// Instrumentation macros; they compile to nothing unless YOLOV10_ENABLE_METRICS is defined.
+#define YOLOV10_METRICS_CONCAT_INNER(a, b) a##b
+#define YOLOV10_METRICS_CONCAT(a, b) YOLOV10_METRICS_CONCAT_INNER(a, b)
+#if defined(YOLOV10_ENABLE_METRICS)
+#define YOLOV10_SCOPED_TIMER(stage) ScopedTimer YOLOV10_METRICS_CONCAT(scoped_timer_, __LINE__)(stage)
+#define YOLOV10_RECORD_LATENCY(stage, duration) client_metrics().latency(stage).record(duration)
+#define YOLOV10_COUNT(which, n) client_metrics().counter(which).add(n)
+#define YOLOV10_GAUGE_SET(which, value) client_metrics().gauge(which).set(static_cast<int64_t>(value))
+#define YOLOV10_GAUGE_ADD(which, delta) client_metrics().gauge(which).add(delta)
+#else
+#define YOLOV10_SCOPED_TIMER(stage) ((void)0)
+#define YOLOV10_RECORD_LATENCY(stage, duration) ((void)0)
+#define YOLOV10_COUNT(which, n) ((void)0)
+#define YOLOV10_GAUGE_SET(which, value) ((void)0)
+#define YOLOV10_GAUGE_ADD(which, delta) ((void)0)
+#endif
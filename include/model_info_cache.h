@@ -0,0 +1,42 @@
+#pragma once
+#include <chrono>
+#include <optional>
+#include <string>
+#include "triton_client.h"
+
+// Parsed model configurations kept on disk between runs, one file per server, model name and version.
+// `server` identifies where the entry came from (protocol and endpoint URLs), so two servers that
+// serve different models under the same name never share an entry.
+// An entry younger than `max_age` is used without asking the server. An older entry is used if
+// its fingerprint still matches the server's model configuration, which skips parsing and
+// validating it again. A missing or corrupt file is a cache miss, and a failed write
+// only costs the next start its cache hit.
+class ModelInfoCache {
+public:
+    struct Entry {
+        TritonModelInfo info;
+        std::string fingerprint; // Hash of the model configuration the entry was built from
+        std::chrono::system_clock::time_point stored;
+    };
+
+    explicit ModelInfoCache(std::string directory = default_directory(),
+                            std::chrono::seconds max_age = std::chrono::seconds(300));
+
+    // $YOLOV10_CACHE_DIR, else $XDG_CACHE_HOME/yolov10-triton, else ~/.cache/yolov10-triton.
+    static std::string default_directory();
+    // Stable across runs and builds (FNV-1a), unlike std::hash.
+    static std::string fingerprint(const std::string& data);
+
+    std::optional<Entry> load(const std::string& server, const std::string& model_name, const std::string& model_version) const;
+    void store(const std::string& server, const std::string& model_name, const std::string& model_version,
+               const TritonModelInfo& info, const std::string& fingerprint) const;
+    bool fresh(const Entry& entry) const;
+
+    const std::string& directory() const { return directory_; }
+
+private:
+    std::string path(const std::string& server, const std::string& model_name, const std::string& model_version) const;
+
+    std::string directory_;
+    std::chrono::seconds max_age_;
+};
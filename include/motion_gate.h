@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include "common.h"
+
+struct MotionGateConfig {
+    // Frames are compared as grayscale thumbnails of this width (height follows the aspect ratio).
+    int thumbnail_width{96};
+    // A thumbnail pixel counts as changed when it differs by more than this (0-255).
+    int pixel_threshold{20};
+    // Inference runs when at least this fraction of thumbnail pixels changed.
+    float changed_fraction{0.002f};
+    // Inference also runs after this many consecutive skipped frames, bounding how stale
+    // carried-forward detections can get.
+    uint32_t max_skip{30};
+};
+
+// Decides per frame whether inference is needed. Each frame is compared with the frame that was
+// last sent to inference, not the previous one, so slow changes still add up and trigger it.
+class MotionGate {
+public:
+    explicit MotionGate(const MotionGateConfig& config = MotionGateConfig()) : config_{config} {}
+
+    // True if the frame should be inferred; the frame then becomes the new reference.
+    bool should_infer(const cv::Mat& frame);
+    // Fraction of thumbnail pixels that changed in the last should_infer() call.
+    float last_score() const { return last_score_; }
+    void reset();
+
+private:
+    void thumbnail(const cv::Mat& frame, cv::Mat& gray);
+
+    MotionGateConfig config_;
+    cv::Mat reference_;
+    cv::Mat current_;
+    cv::Mat small_;
+    cv::Mat diff_;
+    uint32_t skipped_{0};
+    float last_score_{1.f};
+};
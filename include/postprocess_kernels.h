@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Writes the indices of the rows of a row-major [rows, stride] tensor whose column `score_column`
+// is >= `threshold` into `indices` (room for `rows` entries), in row order. Returns the count.
+// Uses AVX2 gathers or NEON compares where available.
+size_t select_score_candidates(const float* data, size_t rows, size_t stride, size_t score_column, float threshold,
+                               uint32_t* indices);
+
+// IEEE half -> float for `count` elements; F16C or NEON when compiled in.
+void convert_fp16_to_fp32(const uint16_t* src, float* dst, size_t count);
+
+// Name of the SIMD path compiled into the postprocess kernels: "avx2", "neon" or "scalar".
+const char* postprocess_simd_backend();
@@ -0,0 +1,86 @@
+#pragma once
+#include <map>
+#include <mutex>
+#include "common.h"
+
+// Everything needed to build the request objects for one model.
+struct RequestTemplate {
+    std::string model_name;
+    std::string model_version;
+    std::string input_name;
+    std::string input_datatype;
+    std::vector<int64_t> input_shape; // Batch dimension first when batching
+    std::vector<std::string> output_names;
+    bool batching{false};
+};
+
+// InferInput, requested outputs and options built once for a model and input shape.
+// Per frame only the input data is rebound (Reset + AppendRaw), so the hot path allocates
+// nothing and the objects are freed with the request instead of leaking.
+class PreparedRequest {
+public:
+    PreparedRequest(const RequestTemplate& request_template, size_t batch_size);
+
+    PreparedRequest(const PreparedRequest&) = delete;
+    PreparedRequest& operator=(const PreparedRequest&) = delete;
+
+    // Points the input at `data`, which must stay alive until the request completes.
+    void bind_input(const uint8_t* data, size_t byte_size);
+    // Binds the input and outputs to registered shared-memory regions; done once per request object.
+    void bind_shared_memory(const std::string& input_region, size_t input_byte_size, const std::string& output_region,
+                            const std::vector<size_t>& output_offsets, const std::vector<size_t>& output_byte_sizes);
+
+    size_t batch_size() const { return batch_size_; }
+    tc::InferOptions& options() { return options_; }
+    const std::vector<tc::InferInput*>& inputs() const { return inputs_; }
+    const std::vector<const tc::InferRequestedOutput*>& outputs() const { return outputs_; }
+    const std::vector<std::string>& output_names() const { return output_names_; }
+
+private:
+    size_t batch_size_;
+    std::unique_ptr<tc::InferInput> input_;
+    std::vector<std::unique_ptr<tc::InferRequestedOutput>> output_owners_;
+    std::vector<tc::InferInput*> inputs_;
+    std::vector<const tc::InferRequestedOutput*> outputs_;
+    std::vector<std::string> output_names_;
+    tc::InferOptions options_;
+};
+
+// Thread-safe free list of PreparedRequest objects per batch size, backing concurrent callers
+// and in-flight asynchronous requests. Objects are created on demand and returned on release.
+class PreparedRequestPool {
+public:
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept = default;
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease();
+
+        PreparedRequest* operator->() const { return request_.get(); }
+        PreparedRequest& operator*() const { return *request_; }
+        explicit operator bool() const { return request_ != nullptr; }
+
+    private:
+        friend class PreparedRequestPool;
+        Lease(PreparedRequestPool* pool, std::unique_ptr<PreparedRequest> request)
+            : pool_{pool}, request_{std::move(request)} {}
+
+        PreparedRequestPool* pool_{nullptr};
+        std::unique_ptr<PreparedRequest> request_;
+    };
+
+    explicit PreparedRequestPool(RequestTemplate request_template);
+
+    Lease acquire(size_t batch_size = 1);
+    // Number of request objects built so far; stays flat in steady state.
+    size_t created() const;
+
+private:
+    void release(std::unique_ptr<PreparedRequest> request);
+
+    RequestTemplate template_;
+    mutable std::mutex mutex_;
+    std::map<size_t, std::vector<std::unique_ptr<PreparedRequest>>> free_;
+    size_t created_{0};
+};
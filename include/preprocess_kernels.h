@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+enum class TensorFormat { NCHW = 0, NHWC = 1 };
+
+// Stretch scales each axis independently to the model input; Letterbox keeps the aspect ratio
+// and pads the remainder with gray (114), centering the image.
+enum class ResizeMode { Stretch = 0, Letterbox = 1 };
+
+constexpr uint8_t kLetterboxPadValue = 114;
+
+// Where a source frame lands inside the model input. Model-space coordinates map back to the
+// frame as x_frame = (x - pad_x) / scale_x.
+struct ResizeGeometry {
+    cv::Size src_size;
+    cv::Size dst_size;
+    int pad_x{0};
+    int pad_y{0};
+    int content_width{0};
+    int content_height{0};
+    float scale_x{1.f};
+    float scale_y{1.f};
+};
+
+ResizeGeometry compute_resize_geometry(const cv::Size& src_size, const cv::Size& dst_size, ResizeMode mode);
+
+// Bilinear sampling coordinates for one source -> destination size pair, matching cv::resize
+// INTER_LINEAR (half-pixel centers, edge clamped). The x/y tables cover the content area only.
+struct ResizeTable {
+    cv::Size src_size;
+    cv::Size dst_size;
+    ResizeGeometry geometry;
+    std::vector<int32_t> x0; // Byte offset of the left sample within a BGR row
+    std::vector<int32_t> x1; // Byte offset of the right sample
+    std::vector<float> fx;   // Weight of the right sample
+    std::vector<int32_t> y0; // Upper source row
+    std::vector<int32_t> y1; // Lower source row
+    std::vector<float> fy;   // Weight of the lower row
+};
+
+ResizeTable build_resize_table(const cv::Size& src_size, const cv::Size& dst_size, ResizeMode mode = ResizeMode::Stretch);
+
+// Resize + BGR->RGB + normalize + layout conversion in a single pass over a CV_8UC3 image,
+// writing straight into `dst`. FP32 output is scaled to [0, 1]; UINT8 output keeps raw pixel values.
+// Pixels outside the table's content area are filled with kLetterboxPadValue.
+// Specialized at compile time per layout and datatype; AVX2 or NEON is used where available.
+template <TensorFormat Format, typename T>
+void fused_preprocess(const cv::Mat& bgr, const ResizeTable& table, uint8_t* dst);
+
+using PreprocessKernel = void (*)(const cv::Mat& bgr, const ResizeTable& table, uint8_t* dst);
+
+// Resolves the specialization for a Triton input format ("FORMAT_NCHW"/"FORMAT_NHWC") and
+// datatype ("FP32"/"UINT8"). Call once at setup, not per frame.
+PreprocessKernel select_preprocess_kernel(const std::string& format, const std::string& datatype);
+
+// Name of the SIMD path compiled into the kernels: "avx2", "neon" or "scalar".
+const char* preprocess_simd_backend();
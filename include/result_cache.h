@@ -0,0 +1,99 @@
+#pragma once
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include "common.h"
+#include "yolov10.h"
+
+// What identifies two images as the same.
+enum class CacheKeyMode {
+    Exact = 0,  // Hash of the encoded file bytes (or of the pixels when there is no file)
+    Perceptual, // Difference hash of a 17x16 grayscale thumbnail: survives resizing and recompression
+};
+
+struct ResultCacheConfig {
+    size_t capacity{10000};
+    // Larger results are not cached; bounds the fixed entry size.
+    size_t max_detections{100};
+    CacheKeyMode mode{CacheKeyMode::Exact};
+    // Backing file, memory-mapped so entries survive restarts; empty keeps the cache in memory.
+    std::string path;
+    // Model and postprocessing settings the results depend on. A backing file written under a
+    // different context is discarded instead of answering with stale detections.
+    std::string context;
+};
+
+struct ResultCacheStats {
+    uint64_t hits{0};
+    uint64_t misses{0};
+    uint64_t insertions{0};
+    uint64_t evictions{0};
+    uint64_t oversized{0}; // Results with more than max_detections, not cached
+    size_t entries{0};
+    size_t capacity{0};
+
+    double hit_rate() const { return hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0.0; }
+};
+
+struct CachedResult {
+    cv::Size frame_size; // Of the image the entry was made from
+    std::vector<Detection> detections;
+};
+
+// LRU cache of detections keyed by image content, so duplicates skip preprocessing and the round
+// trip to the server. Boxes are stored relative to the frame size, which lets a perceptual hit on
+// a resized copy return boxes in that copy's coordinates. Entries have a fixed size and live in
+// one flat array, either on the heap or in a memory-mapped file; the LRU order is rebuilt from
+// per-entry use stamps when the file is reopened. Thread-safe.
+class ResultCache {
+public:
+    explicit ResultCache(const ResultCacheConfig& config);
+    ~ResultCache();
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    static uint64_t exact_key(const uint8_t* data, size_t size);
+    static uint64_t exact_key(const cv::Mat& image);
+    static uint64_t perceptual_key(const cv::Mat& image);
+    // The configured kind of key for a decoded image.
+    uint64_t key(const cv::Mat& image) const;
+
+    // Detections scaled to `frame_size`, or to the stored size if it is empty.
+    std::optional<CachedResult> lookup(uint64_t key, const cv::Size& frame_size = cv::Size());
+    void insert(uint64_t key, const cv::Size& frame_size, const std::vector<Detection>& detections);
+    // Writes dirty pages of the backing file; also done on destruction.
+    void flush();
+
+    ResultCacheStats stats() const;
+    const ResultCacheConfig& config() const { return config_; }
+
+private:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    size_t entry_size() const;
+    uint8_t* entry(uint32_t slot) const;
+    void open_file();
+    void load_entries();
+    void unlink_slot(uint32_t slot);
+    void push_front(uint32_t slot);
+    void render_metrics(std::ostream& out) const;
+
+    ResultCacheConfig config_;
+    uint64_t context_hash_;
+    uint8_t* base_{nullptr}; // Header followed by `capacity` entries
+    size_t byte_size_{0};
+    std::vector<uint8_t> heap_;
+    int fd_{-1};
+
+    mutable std::mutex mutex_;
+    uint64_t clock_{0};
+    std::unordered_map<uint64_t, uint32_t> index_;
+    // Intrusive LRU list over slots, most recent first
+    std::vector<uint32_t> prev_, next_;
+    uint32_t head_{kNone};
+    uint32_t tail_{kNone};
+    std::vector<uint32_t> free_slots_;
+    ResultCacheStats stats_;
+    size_t collector_id_;
+};
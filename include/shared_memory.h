@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// POSIX shared-memory segment (shm_open + mmap) that can be registered with a co-located
+// Triton server as a system shared-memory region. The segment is unlinked on destruction.
+class SharedMemoryRegion {
+public:
+    // `key` must start with '/', e.g. "/yolov10_input_1234".
+    SharedMemoryRegion(const std::string& key, size_t byte_size);
+    ~SharedMemoryRegion();
+
+    SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+    SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+
+    uint8_t* data() const { return data_; }
+    size_t size() const { return byte_size_; }
+    const std::string& key() const { return key_; }
+
+private:
+    std::string key_;
+    size_t byte_size_;
+    int fd_{-1};
+    uint8_t* data_{nullptr};
+};
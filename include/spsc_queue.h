@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+// Bounded single-producer / single-consumer ring buffer.
+// Exactly one thread may push and exactly one thread may pop; no locks are taken.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity)
+        : capacity_{round_up_pow2(capacity < 2 ? 2 : capacity)},
+          mask_{capacity_ - 1},
+          slots_{std::make_unique<T[]>(capacity_)} {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    bool try_push(T&& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ == capacity_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ == capacity_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& value) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) {
+                return false;
+            }
+        }
+        value = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called concurrently with push/pop; exact when both sides are idle.
+    // head_ is read first so a concurrent pop cannot put it past the tail we compare against;
+    // pops and pushes landing between the two loads can still overshoot, hence the clamp.
+    size_t size() const {
+        const size_t head = head_.load(std::memory_order_acquire);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        const size_t used = tail - head;
+        return used > capacity_ ? capacity_ : used;
+    }
+
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    static size_t round_up_pow2(size_t v) {
+        size_t p = 1;
+        while (p < v) {
+            p <<= 1;
+        }
+        return p;
+    }
+
+    static constexpr size_t kCacheLine = 64;
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<T[]> slots_;
+
+    // Producer side
+    alignas(kCacheLine) std::atomic<size_t> tail_{0};
+    size_t head_cache_{0};
+    // Consumer side
+    alignas(kCacheLine) std::atomic<size_t> head_{0};
+    size_t tail_cache_{0};
+};
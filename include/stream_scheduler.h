@@ -0,0 +1,125 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "common.h"
+#include "metrics.h"
+#include "triton_client.h"
+
+// What a stream does when a frame arrives and its queue is full.
+enum class StreamOverflow {
+    DropOldest = 0, // Live sources: the newest frame replaces the oldest waiting one
+    Block,          // Files and replays: submit() waits, slowing capture to what inference sustains
+};
+
+struct StreamConfig {
+    std::string name;
+    // Frames older than this (since capture) when their turn comes are dropped unsent; results
+    // that arrive later than this are counted as late.
+    std::chrono::milliseconds latency_budget{200};
+    // Share of inference capacity relative to the other streams while they all have frames waiting.
+    uint32_t weight{1};
+    // Frames waiting per stream; 1 keeps only the latest frame.
+    size_t queue_capacity{1};
+    StreamOverflow overflow{StreamOverflow::DropOldest};
+};
+
+struct SchedulerConfig {
+    // Requests outstanding across all streams; the scheduler raises the client's own limit to match.
+    size_t max_in_flight{4};
+};
+
+struct StreamStats {
+    std::string name;
+    uint64_t submitted{0};
+    uint64_t completed{0};
+    uint64_t dropped_overflow{0}; // Replaced by a newer frame while waiting
+    uint64_t dropped_stale{0};    // Already past the latency budget when its turn came
+    uint64_t late{0};             // Completed, but after the latency budget
+    uint64_t errors{0};
+    size_t queued{0};
+    double p50_latency_ms{0.0}; // Capture to completion, completed frames only
+    double p99_latency_ms{0.0};
+};
+
+struct StreamResult {
+    size_t stream{0};
+    uint64_t frame_id{0};
+    InferenceResult result; // `error` is set instead of throwing
+    std::chrono::steady_clock::time_point capture_time;
+    bool late{false};
+};
+
+// Shares one TritonClient between many camera streams. Each stream has a bounded queue in front of
+// the client, a latency budget and a weight. A dispatcher thread picks streams by deficit round
+// robin, so a stream with weight 2 gets twice the requests of a weight-1 stream while both have
+// frames waiting and an idle stream's share goes to the others. Frames that waited past their
+// budget are dropped instead of sent, so a slow server costs frames rather than ever-growing delay.
+class StreamScheduler {
+public:
+    using ResultCallback = std::function<void(StreamResult&&)>;
+
+    StreamScheduler(TritonClient& triton_client, const SchedulerConfig& config = SchedulerConfig());
+    ~StreamScheduler();
+
+    StreamScheduler(const StreamScheduler&) = delete;
+    StreamScheduler& operator=(const StreamScheduler&) = delete;
+
+    // `on_result` runs on the Triton client's completion thread, in order within the stream only
+    // when max_in_flight is 1; frame ids tell results apart. Returns the stream index.
+    size_t add_stream(const StreamConfig& config, ResultCallback on_result);
+    // Queues a preprocessed frame. Returns false if the scheduler is stopping.
+    bool submit(size_t stream, uint64_t frame_id, std::vector<uint8_t> input_data,
+                std::chrono::steady_clock::time_point capture_time = std::chrono::steady_clock::now());
+    // Stops dispatching, drops what is still queued and waits for outstanding requests.
+    void stop();
+
+    std::vector<StreamStats> stats() const;
+    size_t stream_count() const;
+
+private:
+    struct QueuedFrame {
+        uint64_t frame_id;
+        std::vector<uint8_t> input_data;
+        std::chrono::steady_clock::time_point capture_time;
+    };
+
+    struct Stream {
+        size_t index;
+        StreamConfig config;
+        ResultCallback on_result;
+        std::deque<QueuedFrame> queue;
+        uint64_t deficit{0};
+        // Written under the mutex or from completion callbacks; read by stats() and /metrics
+        std::atomic<uint64_t> submitted{0};
+        std::atomic<uint64_t> completed{0};
+        std::atomic<uint64_t> dropped_overflow{0};
+        std::atomic<uint64_t> dropped_stale{0};
+        std::atomic<uint64_t> late{0};
+        std::atomic<uint64_t> errors{0};
+        Histogram latency;
+    };
+
+    void dispatch_loop();
+    // Next stream to serve by deficit round robin, or nullptr if nothing is queued. Caller holds mutex_.
+    Stream* next_stream();
+    void drop_stale(Stream& stream, std::chrono::steady_clock::time_point now);
+    void complete(Stream& stream, uint64_t frame_id, std::chrono::steady_clock::time_point capture_time,
+                  InferenceResult&& result);
+    void render_metrics(std::ostream& out) const;
+
+    TritonClient& triton_client_;
+    SchedulerConfig config_;
+    std::vector<std::unique_ptr<Stream>> streams_;
+    size_t round_robin_{0};
+    size_t in_flight_{0};
+    bool stop_{false};
+    mutable std::mutex mutex_;
+    std::condition_variable dispatch_cv_; // Frames queued or capacity freed
+    std::condition_variable space_cv_;    // Room in a blocking stream's queue
+    size_t collector_id_;
+    std::thread dispatcher_;
+};
@@ -0,0 +1,68 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// Fixed-capacity tensor shape; copying it never allocates.
+struct TensorShape {
+    static constexpr size_t kMaxRank = 8;
+
+    std::array<int64_t, kMaxRank> dims{};
+    size_t rank{0};
+
+    TensorShape() = default;
+    explicit TensorShape(const std::vector<int64_t>& shape) { assign(shape); }
+
+    void assign(const std::vector<int64_t>& shape) {
+        if (shape.size() > kMaxRank) {
+            throw std::runtime_error("Tensor rank exceeds TensorShape::kMaxRank.");
+        }
+        rank = shape.size();
+        for (size_t i = 0; i < rank; ++i) {
+            dims[i] = shape[i];
+        }
+    }
+
+    int64_t operator[](size_t i) const { return dims[i]; }
+    size_t size() const { return rank; }
+
+    size_t element_count() const {
+        size_t count = 1;
+        for (size_t i = 0; i < rank; ++i) {
+            count *= static_cast<size_t>(dims[i]);
+        }
+        return count;
+    }
+};
+
+// IEEE 754 half-precision element as stored by Triton "FP16" tensors; only used to type views.
+struct Float16 {
+    uint16_t bits;
+};
+
+// Non-owning typed view over a tensor's contiguous data. The memory belongs to whoever produced
+// the view (usually an InferenceOutput) and is only valid as long as that owner.
+template <typename T>
+struct TensorView {
+    const T* data{nullptr};
+    TensorShape shape;
+
+    size_t size() const { return shape.element_count(); }
+    bool empty() const { return data == nullptr || size() == 0; }
+    std::span<const T> span() const { return {data, size()}; }
+    const T& operator[](size_t i) const { return data[i]; }
+
+    // View of item `index` along the leading (batch) dimension, with that dimension set to 1.
+    TensorView slice(size_t index) const {
+        if (shape.rank == 0 || static_cast<int64_t>(index) >= shape[0]) {
+            throw std::runtime_error("Tensor slice index out of range.");
+        }
+        TensorView item{data, shape};
+        item.shape.dims[0] = 1;
+        item.data = data + index * item.size();
+        return item;
+    }
+};
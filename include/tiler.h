@@ -0,0 +1,81 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "common.h"
+#include "triton_client.h"
+#include "yolov10.h"
+
+// How detections of the same object seen by several tiles are combined.
+enum class TileMerge { Nms = 0, WeightedFusion };
+// Overlap measure used to decide that two boxes are the same object. A box cut by a tile border
+// covers only part of the whole box, so intersection over the smaller box matches it where IoU would not.
+enum class TileMatch { Iou = 0, IntersectionOverSmaller };
+
+struct TilingConfig {
+    // Minimum overlap between neighbouring tiles in pixels; objects up to this size appear whole in some tile.
+    int overlap{96};
+    // Also send the whole frame, resized as usual, so objects larger than a tile are still found.
+    bool full_frame{true};
+    TileMerge merge{TileMerge::Nms};
+    TileMatch match{TileMatch::IntersectionOverSmaller};
+    float match_threshold{0.5f};
+    // Tiles per request; 0 uses the model's max_batch_size (1 for models without batching).
+    size_t max_batch_size{0};
+};
+
+// Regions of a frame sent as one batch entry each: the tiles, row by row, then the full frame if
+// enabled. Tiles are the model's input size, so they reach the model without resizing.
+struct TileGrid {
+    cv::Size frame_size;
+    std::vector<cv::Rect> regions;
+    size_t size() const { return regions.size(); }
+};
+
+// Sliced inference for frames much larger than the model input: the frame is cut into
+// overlapping model-sized tiles, which are preprocessed back to back into one batched input,
+// and the tiles' detections are shifted back into frame coordinates and merged across borders.
+class FrameTiler {
+public:
+    FrameTiler(YOLOv10& task, const TritonModelInfo& model_info, const TilingConfig& config = TilingConfig());
+
+    // Built once per resolution. Safe to call from several threads.
+    std::shared_ptr<const TileGrid> grid(const cv::Size& frame_size);
+    size_t tiles_per_request() const { return tiles_per_request_; }
+    // Requests needed for `grid`; request k carries regions [k * tiles_per_request(), ...).
+    size_t request_count(const TileGrid& grid) const { return (grid.size() + tiles_per_request_ - 1) / tiles_per_request_; }
+    size_t request_batch_size(const TileGrid& grid, size_t request) const;
+
+    // Writes grid.size() model inputs back to back into `input_data`.
+    void preprocess(const cv::Mat& frame, const TileGrid& grid, std::vector<uint8_t>& input_data);
+    // Cuts a preprocessed frame into the inputs of its requests; a single request takes the buffer as is.
+    std::vector<std::vector<uint8_t>> split_requests(const TileGrid& grid, std::vector<uint8_t>&& input_data) const;
+    // Detections of every region in frame coordinates, merged; `outputs[k]` is the response to request k.
+    std::vector<Detection> postprocess(const TileGrid& grid, const std::vector<std::shared_ptr<InferenceOutput>>& outputs);
+    // Blocking preprocess, requests and postprocess for one frame.
+    std::vector<Detection> infer(TritonClient& triton_client, const cv::Mat& frame);
+
+    const TilingConfig& config() const { return config_; }
+
+private:
+    TileGrid build_grid(const cv::Size& frame_size) const;
+
+    YOLOv10& task_;
+    cv::Size tile_size_;
+    TilingConfig config_;
+    size_t tiles_per_request_;
+
+    std::mutex grids_mutex_;
+    std::unordered_map<uint64_t, std::shared_ptr<const TileGrid>> grids_;
+};
+
+// Tile origins along one axis: evenly spread so neighbours overlap by at least `overlap` and the
+// last tile ends at the frame edge. A single origin 0 when the frame fits in one tile.
+std::vector<int> tile_origins(int length, int tile, int overlap);
+
+// Merges duplicates of the same class seen by different regions, highest score first; regions[i] is
+// the grid region detection i came from, and a group takes at most one box per region. Nms keeps the
+// best box of each group; WeightedFusion replaces it with the score-weighted average of the group
+// and keeps the best score.
+std::vector<Detection> merge_detections(std::vector<Detection> detections, const std::vector<uint32_t>& regions,
+                                        TileMerge merge, TileMatch match, float threshold);
@@ -0,0 +1,149 @@
+#pragma once
+// Capture-and-replay traces. Only the standard library and POSIX are used here, so the mock
+// server can replay traces without OpenCV or the Triton client.
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Trace file, native byte order: a 64-byte TraceFileHeader, then records. Each record is a
+// TraceRecordHeader followed by `payload_size` bytes, padded to 8 bytes. The file is written
+// append-only through a growing memory map; `committed_size` in the header is updated after
+// every record, so a trace cut short by a crash is readable up to its last complete record.
+//
+// Payloads by type:
+//   Meta:   "key=value\n" lines (model and input description)
+//   Frame:  i32 width, i32 height, i32 OpenCV type, i32 elem_size, then tightly packed rows
+//   Input:  the preprocessed input tensor bytes; `index` is the batch size
+//   Output: u64 latency_ns, u32 tensor_count, u32 reserved, then per tensor:
+//           u32 name_length, u32 datatype_length, u32 rank, u32 reserved, i64 dims[rank],
+//           u64 byte_size, name, datatype, data, each part padded to 8 bytes;
+//           `index` is the request within the frame (several when tiling)
+//
+// The client sends "<frame_id>:<request_index>:<sequence>" as the Triton request id of tagged
+// requests (trace_request_id), so a replaying server can answer each request with the Output record of
+// the same frame and request index however the requests are ordered on the wire.
+constexpr char kTraceMagic[8] = {'Y', 'V', '1', '0', 'T', 'R', 'C', '1'};
+
+enum class TraceRecordType : uint32_t { Meta = 0, Frame, Input, Output };
+
+struct TraceFileHeader {
+    char magic[8];
+    uint64_t committed_size; // File bytes holding complete records, header included
+    int64_t start_unix_ns;   // Wall clock at the start of recording, for reference only
+    uint8_t reserved[40];
+};
+static_assert(sizeof(TraceFileHeader) == 64, "TraceFileHeader layout is part of the file format");
+
+struct TraceRecordHeader {
+    uint32_t type; // TraceRecordType
+    uint32_t index;
+    uint64_t frame_id;
+    int64_t time_ns; // Since the start of recording (steady clock)
+    uint64_t payload_size;
+};
+static_assert(sizeof(TraceRecordHeader) == 32, "TraceRecordHeader layout is part of the file format");
+
+// Request id for request `request_index` of frame `frame_id`; `sequence` keeps ids unique.
+std::string trace_request_id(uint64_t frame_id, uint32_t request_index, uint64_t sequence);
+// Frame id and request index of an id made by trace_request_id; false for any other id.
+bool parse_trace_request_id(const std::string& id, uint64_t& frame_id, uint32_t& request_index);
+
+// One output tensor; `data` points into the caller's or the trace's memory.
+struct TraceTensor {
+    std::string name;
+    std::string datatype;
+    std::vector<int64_t> shape;
+    const uint8_t* data{nullptr};
+    size_t byte_size{0};
+};
+
+// Appends records to a new trace file. Thread-safe; records from different threads are
+// interleaved in the order they were appended, each with its own timestamp.
+class TraceWriter {
+public:
+    explicit TraceWriter(const std::string& path);
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    // Nanoseconds since the trace was opened.
+    int64_t now_ns() const;
+
+    void append_meta(const std::map<std::string, std::string>& values);
+    void append_frame(uint64_t frame_id, int64_t time_ns, int width, int height, int type, size_t elem_size,
+                      const uint8_t* data, size_t step);
+    void append_input(uint64_t frame_id, int64_t time_ns, const uint8_t* data, size_t size, uint32_t batch_size = 1);
+    void append_output(uint64_t frame_id, int64_t time_ns, uint32_t request_index, int64_t latency_ns,
+                       const std::vector<TraceTensor>& tensors);
+
+    uint64_t size() const;
+
+private:
+    // Reserves `payload_size` bytes after a record header and returns where the payload goes.
+    uint8_t* begin_record(TraceRecordType type, uint32_t index, uint64_t frame_id, int64_t time_ns, uint64_t payload_size);
+    void commit_record();
+    void reserve(uint64_t size);
+
+    std::string path_;
+    int fd_{-1};
+    uint8_t* base_{nullptr};
+    uint64_t mapped_size_{0};
+    uint64_t write_offset_{0};
+    uint64_t pending_end_{0};
+    std::chrono::steady_clock::time_point start_;
+    mutable std::mutex mutex_;
+};
+
+struct TraceRecord {
+    TraceRecordType type;
+    uint32_t index;
+    uint64_t frame_id;
+    int64_t time_ns;
+    const uint8_t* payload;
+    uint64_t payload_size;
+};
+
+struct TraceFrame {
+    int width{0};
+    int height{0};
+    int type{0};
+    size_t elem_size{0};
+    const uint8_t* data{nullptr}; // Rows of width * elem_size bytes
+};
+
+struct TraceOutput {
+    int64_t latency_ns{0};
+    std::vector<TraceTensor> tensors;
+};
+
+// Read-only view of a trace file. Records and the tensors parsed from them point into the
+// mapping and stay valid while the reader lives.
+class TraceReader {
+public:
+    explicit TraceReader(const std::string& path);
+    ~TraceReader();
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    const std::vector<TraceRecord>& records() const { return records_; }
+    // Records of one type, in file order.
+    std::vector<const TraceRecord*> records(TraceRecordType type) const;
+    // Value from the Meta records, or `fallback` if it was not recorded.
+    std::string meta(const std::string& key, const std::string& fallback = std::string()) const;
+
+    static TraceFrame frame(const TraceRecord& record);
+    static TraceOutput output(const TraceRecord& record);
+
+private:
+    std::string path_;
+    uint8_t* base_{nullptr};
+    size_t size_{0};
+    std::vector<TraceRecord> records_;
+    std::map<std::string, std::string> meta_;
+};
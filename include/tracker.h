@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "yolov10.h"
+
+struct TrackerConfig {
+    // Minimum IoU between a track's predicted box and a detection of the same class to match them.
+    float iou_threshold{0.3f};
+    // Inferred frames a track survives without a match before it is dropped.
+    uint32_t max_misses{3};
+    // Kalman noise, in pixels: how far boxes may accelerate per frame, and detector jitter.
+    float process_noise{1.f};
+    float measurement_noise{4.f};
+};
+
+// SORT-style tracker: one constant-velocity Kalman filter per box coordinate (center, size),
+// greedy IoU association per class. Frames are counted by frame id, so predictions over frames
+// that skipped inference extrapolate along each track's velocity.
+class IouTracker {
+public:
+    explicit IouTracker(const TrackerConfig& config = TrackerConfig()) : config_{config} {}
+
+    // Matches the detections of an inferred frame to tracks and sets their track_id.
+    void update(std::vector<Detection>& detections, uint64_t frame_id);
+    // Boxes of the tracks matched on the last inferred frame, extrapolated to `frame_id`.
+    std::vector<Detection> predict(uint64_t frame_id) const;
+    size_t track_count() const { return tracks_.size(); }
+    void reset();
+
+private:
+    // Position and velocity of one coordinate with its 2x2 covariance.
+    struct Axis {
+        float position{0.f};
+        float velocity{0.f};
+        float p00{0.f}, p01{0.f}, p11{0.f};
+
+        void init(float measurement, float measurement_variance);
+        void predict(float dt, float process_variance);
+        void correct(float measurement, float measurement_variance);
+        float at(float dt) const { return position + velocity * dt; }
+    };
+
+    struct Track {
+        int id{0};
+        int class_id{0};
+        float confidence{0.f};
+        Axis axes[4]; // center x, center y, width, height
+        uint64_t frame_id{0};
+        uint32_t misses{0};
+
+        Box box_at(uint64_t target_frame) const;
+    };
+
+    TrackerConfig config_;
+    std::vector<Track> tracks_;
+    int next_id_{0};
+    // Association scratch, kept between calls
+    std::vector<Box> predicted_;
+    std::vector<std::pair<float, std::pair<size_t, size_t>>> candidates_;
+    std::vector<bool> track_matched_;
+    std::vector<bool> detection_matched_;
+};
@@ -1,7 +1,19 @@
 #pragma once
 #include "common.h"
-#include <curl/curl.h>
+#include "metrics.h"
+#include "prepared_request.h"
+#include "shared_memory.h"
+#include "tensor_view.h"
 #include <rapidjson/document.h>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
 
 struct TritonModelInfo {
     std::string output_name;
@@ -17,8 +29,15 @@ struct TritonModelInfo {
     int max_batch_size;
     int batch_size{1};
     std::vector<int64_t> input_shape;
+    std::vector<std::vector<int64_t>> output_shapes; // Including the batch dimension when batching
+    std::vector<std::string> output_datatypes;
 };
 
+// Size in bytes of one element of a Triton datatype ("FP32", "UINT8", ...). BYTES has no fixed size.
+size_t datatype_byte_size(const std::string& datatype);
+// Appends one element of a BYTES tensor in its raw wire form: a 4-byte little-endian length, then the bytes.
+void append_bytes_element(std::vector<uint8_t>& tensor, const uint8_t* data, size_t size);
+
 union TritonClientInstance {
     TritonClientInstance() {
         new (&httpClient) std::unique_ptr<tc::InferenceServerHttpClient>{};
@@ -31,35 +50,254 @@ union TritonClientInstance {
 
 enum class ProtocolType { HTTP = 0, GRPC = 1 };
 
+// One Triton server behind a TritonClient. Inference and health checks use separate
+// connections because the Triton clients are not safe to share between threads.
+struct TritonEndpoint {
+    TritonEndpoint(const std::string& url, ProtocolType protocol) : url{url}, protocol{protocol} {}
+    ~TritonEndpoint();
+
+    std::string url;
+    ProtocolType protocol;
+    TritonClientInstance client;
+    TritonClientInstance health_client;
+    std::atomic<size_t> outstanding{0};
+    // Cleared when a request or a health check fails, set again by the next passing health check
+    std::atomic<bool> healthy{true};
+    Histogram latency; // Successful requests, send to response
+};
+
+struct LoadBalancingConfig {
+    // How often every endpoint is probed with IsServerLive and IsModelReady.
+    std::chrono::milliseconds health_check_interval{1000};
+    // Re-send a blocking request to a second endpoint once it has been outstanding longer than
+    // the `hedge_quantile` latency of its endpoint; the first response wins.
+    bool hedging{false};
+    double hedge_quantile{0.95};
+    std::chrono::microseconds min_hedge_delay{1000};
+    // Hedging starts once the endpoint has this many latency samples.
+    uint64_t hedge_min_samples{50};
+};
+
+// Owns a tc::InferResult and exposes typed views over its output tensors without copying them.
+// Reusing one InferenceOutput across requests keeps the output path free of allocations.
+class InferenceOutput {
+public:
+    // Takes ownership of `result` and indexes `output_names` over its RawData.
+    void reset(tc::InferResult* result, const std::vector<std::string>& output_names);
+    // Same, but the tensor bytes were written by the server into a shared-memory region.
+    void reset(tc::InferResult* result, const std::vector<std::string>& output_names, const uint8_t* region,
+               const std::vector<size_t>& offsets, const std::vector<size_t>& byte_sizes);
+    // Copies tensors that live outside the owned result (shared memory) into an internal buffer,
+    // so the views stay valid after the client's next request reuses the region.
+    void detach();
+
+    size_t size() const { return tensors_.size(); }
+    tc::InferResult* result() const { return result_.get(); }
+    const std::string& name(size_t index) const { return tensors_.at(index).name; }
+    const std::string& datatype(size_t index) const { return tensors_.at(index).datatype; }
+    const TensorShape& shape(size_t index) const { return tensors_.at(index).shape; }
+    const uint8_t* raw_data(size_t index) const { return tensors_.at(index).data; }
+    size_t byte_size(size_t index) const { return tensors_.at(index).byte_size; }
+
+    // Typed view over output `index`; the element size must match the output datatype.
+    template <typename T>
+    TensorView<T> view(size_t index) const {
+        const Tensor& tensor = tensors_.at(index);
+        if (datatype_byte_size(tensor.datatype) != sizeof(T) || tensor.byte_size < tensor.shape.element_count() * sizeof(T)) {
+            throw std::runtime_error("Output tensor " + tensor.name + " (" + tensor.datatype + ") does not match the requested view type.");
+        }
+        return TensorView<T>{reinterpret_cast<const T*>(tensor.data), tensor.shape};
+    }
+
+private:
+    struct Tensor {
+        std::string name;
+        std::string datatype;
+        TensorShape shape;
+        const uint8_t* data{nullptr};
+        size_t byte_size{0};
+    };
+
+    void index_tensors(const std::vector<std::string>& output_names);
+
+    std::unique_ptr<tc::InferResult> result_;
+    std::vector<Tensor> tensors_;
+    std::vector<int64_t> shape_scratch_;
+    std::vector<uint8_t> detached_;
+};
+
+// Result of an asynchronous request, tagged with the caller's frame id so out-of-order
+// completions can be put back in sequence. `error` is set instead of throwing on the callback thread.
+// Batched requests share one output; `batch_index` selects this frame's slice.
+struct InferenceResult {
+    uint64_t frame_id{0};
+    std::shared_ptr<InferenceOutput> output;
+    size_t batch_index{0};
+    std::exception_ptr error;
+};
+
+using InferenceCallback = std::function<void(InferenceResult&&)>;
+
+// Which frame a blocking request belongs to. Sent as the Triton request id (trace_request_id in
+// trace.h), so server logs and a trace-replaying server can tell requests apart.
+struct RequestTag {
+    uint64_t frame_id{0};
+    uint32_t index{0}; // Request within the frame; tiled frames take several
+};
+
+struct AsyncInferRequest;
+struct HedgedInference;
+class ModelInfoCache;
+
 class TritonClient {
 private:
-    TritonClientInstance client_;
-    const std::string& server_url_;
+    // endpoints_[0] is the primary; shared memory and streaming are bound to it alone
+    std::vector<std::unique_ptr<TritonEndpoint>> endpoints_;
+    LoadBalancingConfig balancing_;
+    bool initialized_{false};
     bool verbose_;
     ProtocolType protocol_;
     std::string model_name_;
     TritonModelInfo model_info_;
     std::string model_version_;
 
+    // Asynchronous in-flight window
+    size_t max_in_flight_{4};
+    size_t in_flight_{0};
+    std::mutex in_flight_mutex_;
+    std::condition_variable in_flight_cv_;
+    // gRPC bidirectional streaming: requests are matched to completions by request id
+    bool streaming_{false};
+    std::atomic<uint64_t> next_request_id_{0};
+    std::mutex stream_mutex_;
+    std::unordered_map<std::string, std::shared_ptr<AsyncInferRequest>> stream_requests_;
+
+    // System shared-memory transport (client co-located with the server)
+    std::unique_ptr<SharedMemoryRegion> shm_input_;
+    std::unique_ptr<SharedMemoryRegion> shm_output_;
+    std::string shm_input_name_;
+    std::string shm_output_name_;
+    std::vector<size_t> shm_output_offsets_;
+    std::vector<size_t> shm_output_byte_sizes_;
+
+    tc::Error register_system_shared_memory(const std::string& name, const std::string& key, size_t byte_size);
+    void unregister_system_shared_memory(const std::string& name);
+
+    // Reusable request objects, built once per batch size after the model info is known
+    std::unique_ptr<PreparedRequestPool> request_pool_;
+    std::unique_ptr<PreparedRequest> shm_request_;
+
+    RequestTemplate request_template() const;
+    PreparedRequestPool& request_pool();
+
+    std::shared_ptr<ModelInfoCache> model_info_cache_;
+
+    // Runs `query` against each endpoint in turn until one succeeds; returns the last error otherwise.
+    tc::Error query_endpoints(const std::function<tc::Error(TritonEndpoint&)>& query);
+    // Hash of the server's model configuration, empty if no endpoint answered.
+    std::string model_fingerprint(const std::string& model_name);
+    // parse_model(), also returning the hash of the configuration it parsed when `fingerprint` is set.
+    TritonModelInfo fetch_model_info(const std::string& model_name, std::string* fingerprint);
+    TritonModelInfo load_model_info(const std::string& model_name);
+
+    void check_batch_size(size_t batch_size) const;
+    // Tagged requests get trace_request_id(), others a plain sequence number.
+    std::string next_request_id(const std::optional<RequestTag>& tag);
+    void acquire_in_flight_slot();
+    void release_in_flight_slot();
+    void complete_async_request(const std::shared_ptr<AsyncInferRequest>& request, tc::InferResult* result);
+    void on_stream_result(tc::InferResult* result);
+
+    // Load balancing across endpoints
+    std::atomic<size_t> next_endpoint_{0};
+    std::thread health_thread_;
+    bool health_stop_{false};
+    std::mutex health_mutex_;
+    std::condition_variable health_cv_;
+    // Hedged requests whose losing copy is still on the wire
+    size_t pending_hedges_{0};
+    std::mutex hedge_mutex_;
+    std::condition_variable hedge_cv_;
+
+    TritonEndpoint& primary_endpoint() { return *endpoints_.front(); }
+    // Least outstanding requests among healthy endpoints (all endpoints if none is healthy),
+    // round-robin between ties. `exclude` is skipped unless it is the only endpoint.
+    TritonEndpoint& select_endpoint(const TritonEndpoint* exclude = nullptr);
+    void create_client(TritonClientInstance& instance, const std::string& url);
+    tc::Error infer_on(TritonEndpoint& endpoint, tc::InferResult** result, PreparedRequest& request);
+    tc::Error async_infer_on(TritonEndpoint& endpoint, tc::InferenceServerClient::OnCompleteFn callback, PreparedRequest& request);
+    void record_endpoint_result(TritonEndpoint& endpoint, std::chrono::steady_clock::time_point start, bool ok);
+    bool check_endpoint_health(TritonEndpoint& endpoint);
+    void health_check_loop();
+    tc::InferResult* run_hedged_inference(const std::vector<uint8_t>& input_data, size_t batch_size, const std::string& request_id);
+    void send_hedge_copy(const std::shared_ptr<HedgedInference>& hedge, TritonEndpoint& endpoint, size_t index);
+    void complete_hedge(const std::shared_ptr<HedgedInference>& hedge, TritonEndpoint& endpoint,
+                        std::chrono::steady_clock::time_point start, tc::InferResult* result);
+
 public:
     TritonClient(const std::string& server_url, ProtocolType protocol, const std::string& model_name, const std::string& model_version = "", bool verbose = false)
-        : server_url_{server_url},
-          verbose_{verbose},
-          protocol_{protocol},
-          model_name_{model_name},
-          model_version_{model_version} {}
+        : TritonClient(std::vector<std::string>{server_url}, protocol, model_name, model_version, verbose) {}
+    // Spreads requests over several servers that serve the same model.
+    TritonClient(const std::vector<std::string>& server_urls, ProtocolType protocol, const std::string& model_name,
+                 const std::string& model_version = "", bool verbose = false, const LoadBalancingConfig& balancing = {});
+    ~TritonClient();
+
+    TritonClient(const TritonClient&) = delete;
+    TritonClient& operator=(const TritonClient&) = delete;
 
-    TritonModelInfo parse_model(const std::string& model_name, const std::string& url);
-    TritonModelInfo retrieve_model_info(const std::string& model_name, const std::string& url, const std::vector<int64_t>& shape);
+    // Fetches and validates the model configuration over the client's own protocol (ModelConfig).
+    TritonModelInfo parse_model(const std::string& model_name);
+    // parse_model() through the model info cache when one is set. `shape` is used for models with dynamic input sizes.
+    TritonModelInfo retrieve_model_info(const std::string& model_name, const std::vector<int64_t>& shape);
+    void set_model_info_cache(std::shared_ptr<ModelInfoCache> cache) { model_info_cache_ = std::move(cache); }
 
     void set_input_shape(const std::vector<int64_t>& shape);
 
+    // Connects to every endpoint; with more than one, also starts the background health checks.
     void initialize_triton_client();
-    std::tuple<std::vector<std::vector<float>>, std::vector<std::vector<int64_t>>> run_inference(const std::vector<uint8_t>& input_data);
-    std::vector<const tc::InferRequestedOutput*> create_infer_requested_output(const std::vector<std::string>& output_names);
-    std::tuple<std::vector<std::vector<float>>, std::vector<std::vector<int64_t>>> extract_inference_results(
+    // Sends `iterations` zero-filled requests to every endpoint (and through shared memory when enabled)
+    // so connection setup and the server's first-inference cost are paid before real frames arrive.
+    void warm_up(size_t iterations = 1, size_t batch_size = 1);
+    size_t endpoint_count() const { return endpoints_.size(); }
+    size_t healthy_endpoint_count() const;
+    const std::string& server_url() const { return endpoints_.front()->url; }
+    // `input_data` holds `batch_size` contiguous frames; batch_size > 1 requires a model with max_batch_size >= batch_size.
+    // Results are exposed as views in `output`, which takes ownership of the response.
+    void run_inference(const std::vector<uint8_t>& input_data, InferenceOutput& output, size_t batch_size = 1,
+                       const std::optional<RequestTag>& tag = std::nullopt);
+    void extract_inference_results(
         tc::InferResult* result,
         size_t batch_size,
         const std::vector<std::string>& output_names,
-        bool batching);
+        bool batching,
+        InferenceOutput& output);
+
+    // Registers POSIX shm regions for the input and all outputs so tensors bypass the HTTP/gRPC body.
+    // Requires the server on the same host; returns false (and keeps the network path) if registration fails
+    // or if the client has several endpoints. Only the blocking run_inference calls with batch size 1 use shared memory.
+    bool enable_shared_memory();
+    void disable_shared_memory();
+    bool shared_memory_enabled() const { return shm_input_ != nullptr; }
+    // Input region to preprocess straight into before calling run_inference_from_shared_memory().
+    uint8_t* shared_input_buffer() const { return shm_input_ ? shm_input_->data() : nullptr; }
+    size_t shared_input_byte_size() const { return shm_input_ ? shm_input_->size() : 0; }
+    // Views in `output` point into the shared output region until the next request; call
+    // InferenceOutput::detach() to keep them longer.
+    void run_inference_from_shared_memory(InferenceOutput& output, const std::optional<RequestTag>& tag = std::nullopt);
+
+    // Non-blocking inference. Blocks only while `max_in_flight` requests are already outstanding.
+    // The callback runs on the Triton client's completion thread and must not submit and wait on
+    // further requests itself. `batch_size` works as in run_inference. The request is tagged with
+    // `frame_id` and `request_index` (see RequestTag).
+    void run_inference_async(uint64_t frame_id, std::vector<uint8_t> input_data, InferenceCallback callback,
+                             size_t batch_size = 1, uint32_t request_index = 0);
+    std::future<InferenceResult> run_inference_async(uint64_t frame_id, std::vector<uint8_t> input_data, size_t batch_size = 1,
+                                                     uint32_t request_index = 0);
+    void set_max_in_flight(size_t max_in_flight);
+    size_t max_in_flight() const { return max_in_flight_; }
+    // Route asynchronous requests through a single gRPC bidirectional stream (gRPC, single endpoint only).
+    void enable_streaming();
+    void disable_streaming();
+    // Blocks until every outstanding asynchronous request has completed.
+    void wait_all();
 };
@@ -0,0 +1,130 @@
+#pragma once
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "common.h"
+#include "motion_gate.h"
+#include "spsc_queue.h"
+#include "tiler.h"
+#include "trace.h"
+#include "tracker.h"
+#include "triton_client.h"
+#include "yolov10.h"
+
+struct PipelineFrame {
+    uint64_t frame_id{0};
+    cv::Mat frame;
+    std::vector<uint8_t> input_data;
+    std::shared_ptr<InferenceOutput> output;
+    size_t batch_index{0};
+    std::vector<Detection> detections;
+    // Set by the motion gate: no request was sent and the detections were carried forward by the tracker
+    bool skipped{false};
+    // Tiled frames: the grid input_data was cut along and one response per tile request
+    std::shared_ptr<const TileGrid> tiles;
+    std::vector<std::shared_ptr<InferenceOutput>> tile_outputs;
+    std::chrono::steady_clock::time_point capture_time;
+};
+
+struct PipelineConfig {
+    size_t queue_capacity{8};
+    // Drop newly captured frames instead of blocking capture when the preprocess queue is full (live sources).
+    bool drop_when_full{false};
+    // Inference requests kept outstanding by the infer stage; 1 uses the blocking client call.
+    size_t max_in_flight{1};
+    // Skip inference on frames that barely differ from the last inferred one and report the
+    // tracker's extrapolated detections instead (static cameras).
+    bool motion_gating{false};
+    MotionGateConfig motion_gate;
+    TrackerConfig tracker;
+    // Cut each frame into overlapping model-sized tiles sent as batched requests (high-resolution sources).
+    bool tiling{false};
+    TilingConfig tiler;
+    // Records captured frames, input tensors and raw outputs with their latencies (see trace.h).
+    std::shared_ptr<TraceWriter> trace;
+};
+
+enum class PipelineStage { Capture = 0, Preprocess, Infer, Postprocess, Count };
+
+struct PipelineStageStats {
+    uint64_t frames{0};
+    double fps{0.0};
+    size_t queue_depth{0}; // Frames waiting in the queue feeding this stage
+};
+
+struct PipelineStats {
+    PipelineStageStats stages[static_cast<size_t>(PipelineStage::Count)];
+    uint64_t dropped_frames{0};
+    uint64_t skipped_frames{0}; // Frames the motion gate kept away from inference
+    double elapsed_seconds{0.0};
+};
+
+// Decode -> preprocess -> infer -> postprocess, each stage on its own thread and connected
+// by bounded SPSC queues, so throughput is bounded by the slowest stage rather than their sum.
+class VideoPipeline {
+public:
+    using ResultCallback = std::function<void(PipelineFrame&)>;
+
+    VideoPipeline(YOLOv10& task, TritonClient& triton_client, const TritonModelInfo& model_info,
+                  const PipelineConfig& config = PipelineConfig());
+    ~VideoPipeline();
+
+    // Opens a file path, RTSP/HTTP URL or a numeric device index.
+    void open(const std::string& source);
+    // Replays the frames of a recorded trace, released at their recorded capture times, instead of a source.
+    void open_replay(std::shared_ptr<const TraceReader> trace);
+    // Starts all stage threads; the callback runs on the postprocess thread, in frame order.
+    void start(ResultCallback on_result);
+    void stop();
+    // Blocks until the source is exhausted and every frame has been postprocessed.
+    void wait();
+    bool finished() const;
+
+    PipelineStats stats() const;
+
+private:
+    void capture_loop();
+    void replay_loop();
+    // Hands a captured frame to the preprocess stage; false once capture should stop.
+    bool deliver(PipelineFrame&& frame);
+    // Async request whose output is written to the trace when recording.
+    std::future<InferenceResult> submit(uint64_t frame_id, std::vector<uint8_t> input_data, size_t batch_size,
+                                        uint32_t request_index);
+    void record_output(uint64_t frame_id, uint32_t request_index, std::chrono::steady_clock::duration latency,
+                       const InferenceOutput& output);
+    void preprocess_loop();
+    void infer_loop();
+    void infer_loop_async();
+    void postprocess_loop();
+    void run_stage(PipelineStage stage, void (VideoPipeline::*loop)());
+
+    YOLOv10& task_;
+    TritonClient& triton_client_;
+    const TritonModelInfo& model_info_;
+    PipelineConfig config_;
+    cv::VideoCapture capture_;
+    std::shared_ptr<const TraceReader> replay_;
+    ResultCallback on_result_;
+
+    SpscQueue<PipelineFrame> capture_queue_;
+    SpscQueue<PipelineFrame> preprocess_queue_;
+    SpscQueue<PipelineFrame> infer_queue_;
+    // Input tensors returned from the infer stage to the preprocess stage for reuse.
+    SpscQueue<std::vector<uint8_t>> recycled_buffers_;
+
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> stage_done_[static_cast<size_t>(PipelineStage::Count)]{};
+    std::atomic<uint64_t> stage_frames_[static_cast<size_t>(PipelineStage::Count)]{};
+    std::atomic<uint64_t> dropped_frames_{0};
+    std::atomic<uint64_t> skipped_frames_{0};
+    // Motion gate runs on the preprocess thread, the tracker on the postprocess thread
+    MotionGate motion_gate_;
+    IouTracker tracker_;
+    std::unique_ptr<FrameTiler> tiler_;
+    std::chrono::steady_clock::time_point start_time_;
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+    std::vector<std::thread> threads_;
+};
@@ -4,7 +4,10 @@
 #include <string>
 #include <fstream>
 #include <variant>
+#include <unordered_map>
 #include "common.h"
+#include "preprocess_kernels.h"
+#include "tensor_view.h"
 
 struct Box {
     float x1, y1, x2, y2;
@@ -13,24 +16,112 @@ struct Box {
 struct Detection {
     // Detection-specific fields
     Box bbox;
-    float class_id;
+    int class_id;
     float class_confidence;
+    int track_id{-1}; // Set by IouTracker; -1 for untracked detections
 };
 
+// Structure-of-arrays detections for any number of frames; frame_index[i] is the batch index
+// detection i came from. Lets downstream consumers stream over one field at a time.
+struct DetectionBatch {
+    std::vector<float> x1, y1, x2, y2;
+    std::vector<float> score;
+    std::vector<int32_t> class_id;
+    std::vector<uint32_t> frame_index;
+
+    size_t size() const { return score.size(); }
+    bool empty() const { return score.empty(); }
+    void clear();
+    void reserve(size_t count);
+    Detection detection(size_t i) const;
+};
+
+struct PostprocessConfig {
+    float confidence_threshold{0.1f};
+    // Per-class overrides of confidence_threshold, keyed by class id.
+    std::unordered_map<int, float> class_thresholds;
+    // Only these classes are reported; empty keeps every class.
+    std::vector<int> allowed_classes;
+    // Keeps the highest-scoring detections per frame; 0 keeps all of them.
+    size_t max_detections{0};
+};
+
+class InferenceOutput;
 
 class YOLOv10 {
 public:
-    YOLOv10(int input_width, int input_height);
+    // `input_format` / `input_datatype` are the Triton model's (e.g. "FORMAT_NCHW", "FP32"); they select
+    // the compile-time specialized preprocessing kernel once, here. "BYTES" selects encoded input:
+    // frames are resized client-side and sent as JPEG for the server to decode.
+    YOLOv10(int input_width, int input_height, const std::string& input_format = "FORMAT_NCHW",
+            const std::string& input_datatype = "FP32");
 
-    std::vector<Detection> postprocess(const cv::Size& frame_size, std::vector<std::vector<float>>& infer_results,
-                                    const std::vector<std::vector<int64_t>>& infer_shapes);
+    // Thresholds, class filter and top-K applied by every postprocess call.
+    void set_postprocess_config(const PostprocessConfig& config);
+    const PostprocessConfig& postprocess_config() const { return postprocess_config_; }
 
-    std::vector<uint8_t> preprocess(const cv::Mat& img, const std::string& format, int img_type1, int img_type3,
-                                    size_t img_channels, const cv::Size& img_size);
+    // Decodes the detections of frame `batch_index` from a [N,300,6] output, reading the
+    // response buffer in place. Detections come out in descending score order when top-K is active.
+    std::vector<Detection> postprocess(const cv::Size& frame_size, const TensorView<float>& output, size_t batch_index = 0);
+    std::vector<Detection> postprocess(const cv::Size& frame_size, const TensorView<Float16>& output, size_t batch_index = 0);
+    // Dispatches on the datatype of the first output ("FP32" or "FP16").
+    std::vector<Detection> postprocess(const cv::Size& frame_size, const InferenceOutput& output, size_t batch_index = 0);
+    // Appends the detections of frame `batch_index` to `detections`.
+    void postprocess(const cv::Size& frame_size, const InferenceOutput& output, size_t batch_index, DetectionBatch& detections);
+    // Decodes every frame of a batched output; frame_sizes[i] is the original size of frame i.
+    std::vector<std::vector<Detection>> postprocess_batch(const std::vector<cv::Size>& frame_sizes,
+                                                          const TensorView<float>& output);
+    // Same, into a cleared structure-of-arrays batch.
+    void postprocess_batch(const std::vector<cv::Size>& frame_sizes, const InferenceOutput& output, DetectionBatch& detections);
+
+    // Resizes, converts BGR->RGB, normalizes and lays out the frame in one pass, writing
+    // input_byte_size() bytes into the caller-owned `dst`. Not available for encoded input.
+    void preprocess(const cv::Mat& img, uint8_t* dst);
+    // Same as above into `input_data`, which is resized as needed and can be reused across frames.
+    // For encoded input it holds one length-prefixed BYTES element instead.
+    void preprocess(const cv::Mat& img, std::vector<uint8_t>& input_data);
+    std::vector<uint8_t> preprocess(const cv::Mat& img);
+    // Bytes per frame of tensor input; 0 for encoded input, whose size varies per frame.
+    size_t input_byte_size() const { return input_byte_size_; }
+    bool encoded_input() const { return encoded_input_; }
+    void set_jpeg_quality(int quality) { jpeg_quality_ = quality; }
+
+    // Switching modes drops the cached resize tables.
+    void set_resize_mode(ResizeMode mode);
+    ResizeMode resize_mode() const { return resize_mode_; }
+    // Placement of a frame of `frame_size` inside the model input; used to map boxes back.
+    ResizeGeometry resize_geometry(const cv::Size& frame_size) const;
     
     std::vector<std::string> read_label_names(const std::string& file_name);
 
 private:
+    const ResizeTable& resize_table(const cv::Size& frame_size);
+    void encode(const cv::Mat& img, std::vector<uint8_t>& input_data);
+    // Rows of one frame's [rows, cols] output that pass the config, left in selected_; returns the count.
+    size_t select_detections(const float* data, int64_t rows, int64_t cols);
+    const float* fp32_rows(const TensorView<Float16>& frame_output);
+    template <typename Emit>
+    void decode(const cv::Size& frame_size, const float* data, int64_t rows, int64_t cols, Emit&& emit);
+
     int input_width_;
     int input_height_;
+    bool encoded_input_;
+    PreprocessKernel preprocess_kernel_;
+    size_t input_byte_size_;
+    int jpeg_quality_{90};
+    cv::Mat resized_;
+    std::vector<uint8_t> encoded_;
+    ResizeMode resize_mode_{ResizeMode::Stretch};
+    // Sampling tables per source resolution, built on first use; fixed-resolution streams
+    // only pay a lookup per frame.
+    std::unordered_map<uint64_t, ResizeTable> resize_tables_;
+
+    PostprocessConfig postprocess_config_;
+    // Config compiled to a lookup: threshold per class id (infinity = filtered out), the threshold
+    // for ids past the table, and the lowest of them, used for the vectorized score scan.
+    std::vector<float> class_thresholds_;
+    float default_threshold_{0.1f};
+    float min_threshold_{0.1f};
+    std::vector<uint32_t> selected_;
+    std::vector<float> fp16_scratch_;
 };
@@ -0,0 +1,92 @@
+#pragma once
+// Public C++ API of libyolov10client. Only standard types cross this header, so callers do not
+// need the Triton client or OpenCV headers and the library can change its internals without
+// breaking them. The C API in yolov10client_c.h wraps the same objects.
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace yolov10 {
+
+struct ClientOptions {
+    std::vector<std::string> servers{"localhost:8001"}; // host:port endpoints to balance over
+    bool http{false};                                    // HTTP instead of gRPC
+    std::string model{"yolov10m"};
+    float confidence_threshold{0.1f};
+    size_t max_detections{0}; // 0 keeps every detection
+    bool letterbox{false};
+    size_t warmup_requests{0};
+    bool model_cache{true}; // Reuse the on-disk model configuration cache
+};
+
+enum class ImageFormat : uint32_t {
+    Bgr = 0, // 8-bit interleaved BGR pixels; width, height and stride are required
+    Encoded, // A complete JPEG, PNG, BMP or WebP file; width, height and stride are ignored
+};
+
+// Borrowed image bytes; nothing is copied before preprocessing.
+struct ImageView {
+    const uint8_t* data{nullptr};
+    size_t size{0};
+    ImageFormat format{ImageFormat::Bgr};
+    int width{0};
+    int height{0};
+    size_t stride{0}; // Bytes per row; 0 means width * 3
+};
+
+struct Detection {
+    float x1, y1, x2, y2; // Pixels in the input image
+    float score;
+    int32_t class_id;
+};
+
+// A warm connection to the inference server: the channel and the model configuration are set up
+// once in the constructor. detect() is thread-safe; calls on one Client are serialized, so use
+// one Client per thread for parallel requests. Errors are thrown as std::runtime_error.
+class Client {
+public:
+    explicit Client(const ClientOptions& options = ClientOptions());
+    ~Client();
+    Client(Client&&) noexcept;
+    Client& operator=(Client&&) noexcept;
+
+    std::vector<Detection> detect(const ImageView& image);
+
+    const std::string& model() const;
+    int input_width() const;
+    int input_height() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Connection to a running yolov10d daemon over its Unix domain socket. Images are handed over as
+// file descriptors (memfd, shm_open, a regular file) instead of over the socket. The daemon maps
+// a memfd sealed with F_SEAL_SHRINK in place and reads other descriptors with pread.
+// Not thread-safe; open one connection per thread.
+class DaemonConnection {
+public:
+    explicit DaemonConnection(const std::string& socket_path = default_socket_path());
+    ~DaemonConnection();
+    DaemonConnection(DaemonConnection&&) noexcept;
+    DaemonConnection& operator=(DaemonConnection&&) noexcept;
+
+    // $YOLOV10_DAEMON_SOCKET, else /tmp/yolov10d.sock.
+    static std::string default_socket_path();
+
+    // `image.data` is ignored; the image is `image.size` bytes at `offset` in `fd`. The caller
+    // keeps the descriptor; the daemon gets a duplicate.
+    std::vector<Detection> detect_fd(int fd, uint64_t offset, const ImageView& image);
+    // Sends the bytes inline; simpler for small encoded images that are not already in a file.
+    std::vector<Detection> detect(const ImageView& image);
+
+private:
+    std::vector<Detection> request(int fd, uint64_t offset, const ImageView& image);
+
+    int socket_{-1};
+};
+
+} // namespace yolov10
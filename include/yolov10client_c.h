@@ -0,0 +1,73 @@
+#ifndef YOLOV10CLIENT_C_H
+#define YOLOV10CLIENT_C_H
+/* C API of libyolov10client, for callers that cannot use the C++ API in yolov10client.h.
+ * Functions return 0 on success and -1 on failure; the message of the last failure on a handle is
+ * available from yolov10_client_last_error() or yolov10_daemon_last_error() until the next call
+ * on that handle. Handles are not thread-safe. */
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct yolov10_client yolov10_client;
+typedef struct yolov10_daemon_connection yolov10_daemon_connection;
+
+typedef enum {
+    YOLOV10_IMAGE_BGR = 0,     /* 8-bit interleaved BGR; width, height and stride are required */
+    YOLOV10_IMAGE_ENCODED = 1, /* A complete JPEG, PNG, BMP or WebP file */
+} yolov10_image_format;
+
+typedef struct {
+    const char* servers; /* Comma-separated host:port endpoints */
+    int use_http;
+    const char* model;
+    float confidence_threshold;
+    uint32_t max_detections; /* 0 keeps every detection */
+    int letterbox;
+    uint32_t warmup_requests;
+} yolov10_client_options;
+
+typedef struct {
+    const uint8_t* data; /* Ignored when the image is passed as a descriptor */
+    size_t size;
+    yolov10_image_format format;
+    int32_t width;
+    int32_t height;
+    size_t stride; /* Bytes per row; 0 means width * 3 */
+} yolov10_image;
+
+typedef struct {
+    float x1, y1, x2, y2;
+    float score;
+    int32_t class_id;
+} yolov10_detection;
+
+/* Fills in the defaults: localhost:8001 over gRPC, model yolov10m, threshold 0.1. */
+void yolov10_client_options_init(yolov10_client_options* options);
+
+/* Returns NULL on failure and, if `error` is not NULL, writes the message into it. */
+yolov10_client* yolov10_client_create(const yolov10_client_options* options, char* error, size_t error_size);
+void yolov10_client_destroy(yolov10_client* client);
+
+/* Writes up to `capacity` detections to `detections` and the number found to `count`, which may
+ * exceed `capacity`. */
+int yolov10_client_detect(yolov10_client* client, const yolov10_image* image, yolov10_detection* detections,
+                          size_t capacity, size_t* count);
+
+/* `socket_path` may be NULL for the default ($YOLOV10_DAEMON_SOCKET or /tmp/yolov10d.sock). */
+yolov10_daemon_connection* yolov10_daemon_connect(const char* socket_path, char* error, size_t error_size);
+void yolov10_daemon_close(yolov10_daemon_connection* connection);
+/* `fd` < 0 sends `image->data` inline; otherwise the image is `image->size` bytes at `offset` in `fd`. */
+int yolov10_daemon_detect(yolov10_daemon_connection* connection, int fd, uint64_t offset, const yolov10_image* image,
+                          yolov10_detection* detections, size_t capacity, size_t* count);
+
+const char* yolov10_client_last_error(const yolov10_client* client);
+const char* yolov10_daemon_last_error(const yolov10_daemon_connection* connection);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* YOLOV10CLIENT_C_H */
@@ -0,0 +1,38 @@
+"""Decodes the JPEGs sent by the client into the FP32 NCHW tensor yolov10m expects.
+
+The client has already resized (and letterboxed) each frame to the network input, so this
+step only decodes, converts BGR to RGB and scales to [0, 1]. Needs numpy and
+opencv-python-headless in the Python backend environment.
+"""
+import json
+
+import cv2
+import numpy as np
+import triton_python_backend_utils as pb_utils
+
+
+class TritonPythonModel:
+    def initialize(self, args):
+        config = json.loads(args["model_config"])
+        dims = pb_utils.get_output_config_by_name(config, "images")["dims"]
+        self.channels, self.height, self.width = (int(d) for d in dims)
+
+    def execute(self, requests):
+        responses = []
+        for request in requests:
+            encoded = pb_utils.get_input_tensor_by_name(request, "encoded").as_numpy().reshape(-1)
+            images = np.empty((len(encoded), self.channels, self.height, self.width), dtype=np.float32)
+            error = None
+            for i, data in enumerate(encoded):
+                image = cv2.imdecode(np.frombuffer(data, dtype=np.uint8), cv2.IMREAD_COLOR)
+                if image is None:
+                    error = pb_utils.TritonError("decode_jpeg: element {} is not a decodable image".format(i))
+                    break
+                if image.shape[0] != self.height or image.shape[1] != self.width:
+                    image = cv2.resize(image, (self.width, self.height), interpolation=cv2.INTER_LINEAR)
+                images[i] = image[:, :, ::-1].transpose(2, 0, 1) * (1.0 / 255.0)
+            if error is not None:
+                responses.append(pb_utils.InferenceResponse(output_tensors=[], error=error))
+            else:
+                responses.append(pb_utils.InferenceResponse(output_tensors=[pb_utils.Tensor("images", images)]))
+        return responses
@@ -0,0 +1,13 @@
+"""Scales the client's UINT8 RGB NCHW tensor to the FP32 [0, 1] input yolov10m expects."""
+import numpy as np
+import triton_python_backend_utils as pb_utils
+
+
+class TritonPythonModel:
+    def execute(self, requests):
+        responses = []
+        for request in requests:
+            pixels = pb_utils.get_input_tensor_by_name(request, "pixels").as_numpy()
+            images = pixels.astype(np.float32) * (1.0 / 255.0)
+            responses.append(pb_utils.InferenceResponse(output_tensors=[pb_utils.Tensor("images", images)]))
+        return responses
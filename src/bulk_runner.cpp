@@ -0,0 +1,461 @@
+#include "bulk_runner.h"
+#include <cctype>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+bool is_image_file(const std::filesystem::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    for (const char* known : {".jpg", ".jpeg", ".png", ".bmp", ".webp", ".tif", ".tiff"}) {
+        if (extension == known) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void append_json_string(std::string& out, const std::string& value) {
+    out += '"';
+    for (unsigned char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    out += '"';
+}
+
+template <typename T>
+void put(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool read_file(const std::string& path, std::vector<uint8_t>& bytes) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return false;
+    }
+    bytes.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size())));
+}
+
+std::string exception_message(const std::exception_ptr& error) {
+    try {
+        std::rethrow_exception(error);
+    } catch (const std::exception& e) {
+        return e.what();
+    } catch (...) {
+        return "unknown error";
+    }
+}
+
+} // namespace
+
+BulkRunner::BulkRunner(TritonClient& triton_client, const TritonModelInfo& model_info, const PostprocessConfig& postprocess_config,
+                       ResizeMode resize_mode, const BulkConfig& config)
+    : triton_client_{triton_client},
+      model_info_{model_info},
+      postprocess_config_{postprocess_config},
+      resize_mode_{resize_mode},
+      config_{config},
+      slots_(std::max<size_t>(1, config.window)) {
+    config_.window = slots_.size();
+    config_.decode_threads = std::max<size_t>(1, config_.decode_threads);
+    config_.checkpoint_interval = std::max<size_t>(1, config_.checkpoint_interval);
+}
+
+BulkRunner::~BulkRunner() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    admit_cv_.notify_all();
+    decode_cv_.notify_all();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    triton_client_.wait_all();
+}
+
+std::string BulkRunner::prepare_manifest() const {
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(config_.input, ec)) {
+        return config_.input;
+    }
+    if (!std::filesystem::is_directory(config_.input, ec)) {
+        std::stringstream err_msg;
+        err_msg << "Bulk input is neither a directory nor a manifest file: " << config_.input;
+        throw std::runtime_error(err_msg.str());
+    }
+    // The listing is written once and reused on resume, so image indices stay stable
+    const std::string manifest = config_.output + ".manifest";
+    if (config_.resume && std::filesystem::exists(manifest, ec)) {
+        return manifest;
+    }
+    const std::string tmp_manifest = manifest + ".tmp";
+    std::ofstream out(tmp_manifest, std::ios::trunc);
+    if (!out) {
+        std::stringstream err_msg;
+        err_msg << "Failed to create manifest: " << tmp_manifest;
+        throw std::runtime_error(err_msg.str());
+    }
+    const auto options = std::filesystem::directory_options::skip_permission_denied;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(config_.input, options)) {
+        if (entry.is_regular_file(ec) && is_image_file(entry.path())) {
+            out << entry.path().string() << '\n';
+        }
+    }
+    out.close();
+    std::filesystem::rename(tmp_manifest, manifest);
+    return manifest;
+}
+
+BulkStats BulkRunner::run() {
+    const std::string manifest = prepare_manifest();
+    BulkStats stats;
+
+    // A checkpoint holds the next image index and the output size after the last record before it
+    uint64_t first_index = 0;
+    uint64_t output_offset = 0;
+    std::error_code ec;
+    if (config_.resume && std::filesystem::exists(config_.output, ec)) {
+        std::ifstream checkpoint(config_.output + ".ckpt");
+        if (checkpoint >> first_index >> output_offset) {
+            if (std::filesystem::file_size(config_.output) < output_offset) {
+                std::stringstream err_msg;
+                err_msg << "Checkpoint " << config_.output << ".ckpt is ahead of the output file; cannot resume.";
+                throw std::runtime_error(err_msg.str());
+            }
+            // Drop records written after the checkpoint; they are produced again
+            std::filesystem::resize_file(config_.output, output_offset);
+        } else {
+            first_index = 0;
+        }
+    }
+    if (first_index > 0) {
+        output_.open(config_.output, std::ios::in | std::ios::out | std::ios::binary);
+        output_.seekp(static_cast<std::streamoff>(output_offset));
+    } else {
+        output_.open(config_.output, std::ios::out | std::ios::trunc | std::ios::binary);
+        if (config_.format == BulkOutputFormat::Binary) {
+            output_.write(kBulkBinaryMagic, sizeof(kBulkBinaryMagic));
+        }
+    }
+    if (!output_) {
+        std::stringstream err_msg;
+        err_msg << "Failed to open bulk output: " << config_.output;
+        throw std::runtime_error(err_msg.str());
+    }
+    stats.resumed_from = first_index;
+    next_write_ = first_index;
+    admitted_ = first_index;
+
+    triton_client_.set_max_in_flight(config_.max_in_flight);
+    const auto start_time = std::chrono::steady_clock::now();
+    threads_.emplace_back([this, manifest, first_index] {
+        try {
+            read_loop(manifest, first_index);
+        } catch (...) {
+            fail(std::current_exception());
+        }
+    });
+    for (size_t i = 0; i < config_.decode_threads; ++i) {
+        threads_.emplace_back([this] {
+            try {
+                decode_loop();
+            } catch (...) {
+                fail(std::current_exception());
+            }
+        });
+    }
+
+    YOLOv10 task(model_info_.input_width, model_info_.input_height, model_info_.input_format, model_info_.input_datatype);
+    task.set_resize_mode(resize_mode_);
+    task.set_postprocess_config(postprocess_config_);
+    std::vector<Detection> detections;
+    while (true) {
+        Slot* slot = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            write_cv_.wait(lock, [this] {
+                return error_ || slots_[next_write_ % slots_.size()].ready || (input_done_ && next_write_ == admitted_);
+            });
+            if (error_ || !slots_[next_write_ % slots_.size()].ready) {
+                break;
+            }
+            slot = &slots_[next_write_ % slots_.size()];
+        }
+
+        // The slot belongs to the writer until next_write_ moves past it
+        detections.clear();
+        if (slot->error.empty() && slot->result.error) {
+            slot->error = exception_message(slot->result.error);
+        }
+        if (slot->cached) {
+            detections = std::move(*slot->cached);
+        } else if (slot->error.empty()) {
+            try {
+                detections = task.postprocess(slot->frame_size, *slot->result.output, slot->result.batch_index);
+                if (result_cache_ && slot->cache_key) {
+                    result_cache_->insert(*slot->cache_key, slot->frame_size, detections);
+                }
+            } catch (const std::exception& e) {
+                slot->error = e.what();
+            }
+        }
+        write_record(*slot, detections);
+        ++stats.processed;
+        stats.failed += slot->error.empty() ? 0 : 1;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            slot->result = InferenceResult{};
+            slot->cache_key.reset();
+            slot->cached.reset();
+            slot->ready = false;
+            ++next_write_;
+        }
+        admit_cv_.notify_one();
+        if (stats.processed % config_.checkpoint_interval == 0) {
+            write_checkpoint(next_write_);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+            std::cout << "Bulk: " << next_write_ << " images written (" << stats.processed / seconds << " img/s, "
+                      << stats.failed << " failed)" << std::endl;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    admit_cv_.notify_all();
+    decode_cv_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+    threads_.clear();
+    triton_client_.wait_all();
+    write_checkpoint(next_write_);
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+    stats.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    return stats;
+}
+
+void BulkRunner::read_loop(const std::string& manifest, uint64_t first_index) {
+    std::ifstream in(manifest);
+    if (!in) {
+        std::stringstream err_msg;
+        err_msg << "Failed to open manifest: " << manifest;
+        throw std::runtime_error(err_msg.str());
+    }
+    std::string line;
+    uint64_t index = 0;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || index++ < first_index) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        admit_cv_.wait(lock, [this] { return stop_ || admitted_ < next_write_ + slots_.size(); });
+        if (stop_) {
+            return;
+        }
+        Slot& slot = slots_[admitted_ % slots_.size()];
+        slot.index = admitted_;
+        slot.path = line;
+        slot.frame_size = cv::Size();
+        slot.error.clear();
+        decode_queue_.emplace_back(admitted_, std::move(line));
+        ++admitted_;
+        decode_cv_.notify_one();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        input_done_ = true;
+    }
+    decode_cv_.notify_all();
+    write_cv_.notify_all();
+}
+
+void BulkRunner::decode_loop() {
+    // Preprocessing keeps per-resolution tables, so every decode thread has its own task
+    YOLOv10 task(model_info_.input_width, model_info_.input_height, model_info_.input_format, model_info_.input_datatype);
+    task.set_resize_mode(resize_mode_);
+    while (true) {
+        std::pair<uint64_t, std::string> item;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            decode_cv_.wait(lock, [this] { return stop_ || !decode_queue_.empty() || input_done_; });
+            if (stop_ || decode_queue_.empty()) {
+                return;
+            }
+            item = std::move(decode_queue_.front());
+            decode_queue_.pop_front();
+        }
+        const uint64_t index = item.first;
+        Slot& slot = slots_[index % slots_.size()];
+        try {
+            cv::Mat image;
+            if (result_cache_ && result_cache_->config().mode == CacheKeyMode::Exact) {
+                // Exact keys hash the file itself, so a duplicate is not even decoded
+                std::vector<uint8_t> encoded;
+                if (read_file(item.second, encoded)) {
+                    slot.cache_key = ResultCache::exact_key(encoded.data(), encoded.size());
+                    if (auto hit = result_cache_->lookup(*slot.cache_key)) {
+                        slot.frame_size = hit->frame_size;
+                        complete_cached(index, std::move(hit->detections));
+                        continue;
+                    }
+                    image = cv::imdecode(encoded, cv::IMREAD_COLOR);
+                }
+            } else {
+                image = cv::imread(item.second, cv::IMREAD_COLOR);
+            }
+            if (image.empty()) {
+                complete(index, InferenceResult{}, "failed to read image");
+                continue;
+            }
+            slot.frame_size = image.size();
+            if (result_cache_ && result_cache_->config().mode == CacheKeyMode::Perceptual) {
+                slot.cache_key = ResultCache::perceptual_key(image);
+                if (auto hit = result_cache_->lookup(*slot.cache_key, image.size())) {
+                    complete_cached(index, std::move(hit->detections));
+                    continue;
+                }
+            }
+            std::vector<uint8_t> input_data;
+            task.preprocess(image, input_data);
+            image.release();
+            std::lock_guard<std::mutex> lock(submit_mutex_);
+            triton_client_.run_inference_async(index, std::move(input_data), [this](InferenceResult&& result) {
+                const uint64_t frame_id = result.frame_id;
+                complete(frame_id, std::move(result), std::string());
+            });
+        } catch (const std::exception& e) {
+            complete(index, InferenceResult{}, e.what());
+        }
+    }
+}
+
+void BulkRunner::complete(uint64_t index, InferenceResult&& result, std::string error) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot& slot = slots_[index % slots_.size()];
+        slot.result = std::move(result);
+        slot.error = std::move(error);
+        slot.ready = true;
+    }
+    write_cv_.notify_one();
+}
+
+void BulkRunner::complete_cached(uint64_t index, std::vector<Detection>&& detections) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot& slot = slots_[index % slots_.size()];
+        slot.cached = std::move(detections);
+        slot.error.clear();
+        slot.ready = true;
+    }
+    write_cv_.notify_one();
+}
+
+void BulkRunner::write_record(const Slot& slot, const std::vector<Detection>& detections) {
+    std::string record;
+    if (config_.format == BulkOutputFormat::Jsonl) {
+        char number[64];
+        record += "{\"index\":" + std::to_string(slot.index) + ",\"path\":";
+        append_json_string(record, slot.path);
+        if (!slot.error.empty()) {
+            record += ",\"error\":";
+            append_json_string(record, slot.error);
+            record += "}\n";
+        } else {
+            record += ",\"width\":" + std::to_string(slot.frame_size.width) + ",\"height\":" +
+                      std::to_string(slot.frame_size.height) + ",\"detections\":[";
+            for (size_t i = 0; i < detections.size(); ++i) {
+                const Detection& detection = detections[i];
+                std::snprintf(number, sizeof(number), "%s{\"class_id\":%d,\"score\":%.4f,", i ? "," : "",
+                              detection.class_id, detection.class_confidence);
+                record += number;
+                std::snprintf(number, sizeof(number), "\"box\":[%.1f,%.1f,%.1f,%.1f]}", detection.bbox.x1,
+                              detection.bbox.y1, detection.bbox.x2, detection.bbox.y2);
+                record += number;
+            }
+            record += "]}\n";
+        }
+    } else {
+        put(record, static_cast<uint64_t>(slot.index));
+        put(record, static_cast<uint32_t>(slot.path.size()));
+        record += slot.path;
+        put(record, static_cast<int32_t>(slot.frame_size.width));
+        put(record, static_cast<int32_t>(slot.frame_size.height));
+        put(record, static_cast<uint32_t>(slot.error.size()));
+        record += slot.error;
+        put(record, static_cast<uint32_t>(slot.error.empty() ? detections.size() : 0));
+        for (size_t i = 0; slot.error.empty() && i < detections.size(); ++i) {
+            const Detection& detection = detections[i];
+            put(record, detection.bbox.x1);
+            put(record, detection.bbox.y1);
+            put(record, detection.bbox.x2);
+            put(record, detection.bbox.y2);
+            put(record, detection.class_confidence);
+            put(record, static_cast<int32_t>(detection.class_id));
+        }
+    }
+    output_.write(record.data(), static_cast<std::streamsize>(record.size()));
+    if (!output_) {
+        std::stringstream err_msg;
+        err_msg << "Failed to write bulk output: " << config_.output;
+        throw std::runtime_error(err_msg.str());
+    }
+}
+
+void BulkRunner::write_checkpoint(uint64_t next_index) {
+    output_.flush();
+    const auto offset = static_cast<uint64_t>(output_.tellp());
+    const std::string checkpoint = config_.output + ".ckpt";
+    const std::string tmp_checkpoint = checkpoint + ".tmp";
+    {
+        std::ofstream out(tmp_checkpoint, std::ios::trunc);
+        out << next_index << ' ' << offset << '\n';
+        if (!out.flush()) {
+            std::cerr << "Failed to write checkpoint " << tmp_checkpoint << std::endl;
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp_checkpoint, checkpoint, ec);
+    if (ec) {
+        std::cerr << "Failed to update checkpoint " << checkpoint << ": " << ec.message() << std::endl;
+    }
+}
+
+void BulkRunner::fail(std::exception_ptr error) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_) {
+            error_ = error;
+        }
+        stop_ = true;
+    }
+    admit_cv_.notify_all();
+    decode_cv_.notify_all();
+    write_cv_.notify_all();
+}
@@ -0,0 +1,100 @@
+#include "daemon_protocol.h"
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+
+[[noreturn]] void throw_socket_error(const char* what) {
+    std::stringstream err_msg;
+    err_msg << "Daemon socket " << what << " failed: " << std::strerror(errno);
+    throw std::runtime_error(err_msg.str());
+}
+
+} // namespace
+
+void send_message(int socket, const void* header, size_t header_size, const void* payload, size_t payload_size, int fd) {
+    iovec iov[2] = {{const_cast<void*>(header), header_size}, {const_cast<void*>(payload), payload_size}};
+    int iov_count = payload_size > 0 ? 2 : 1;
+    iovec* next = iov;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    bool attach_fd = fd >= 0;
+    while (iov_count > 0) {
+        msghdr message{};
+        message.msg_iov = next;
+        message.msg_iovlen = iov_count;
+        if (attach_fd) {
+            std::memset(control, 0, sizeof(control));
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+            cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+            std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+        }
+        ssize_t sent = sendmsg(socket, &message, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_socket_error("send");
+        }
+        attach_fd = false; // The descriptor travels with the first byte only
+        while (iov_count > 0 && static_cast<size_t>(sent) >= next->iov_len) {
+            sent -= static_cast<ssize_t>(next->iov_len);
+            ++next;
+            --iov_count;
+        }
+        if (iov_count > 0) {
+            next->iov_base = static_cast<char*>(next->iov_base) + sent;
+            next->iov_len -= static_cast<size_t>(sent);
+        }
+    }
+}
+
+bool receive_exact(int socket, void* data, size_t size, int* fd) {
+    if (fd) {
+        *fd = -1;
+    }
+    size_t received = 0;
+    while (received < size) {
+        iovec iov{static_cast<char*>(data) + received, size - received};
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+        msghdr message{};
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        ssize_t n = recvmsg(socket, &message, MSG_CMSG_CLOEXEC);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_socket_error("receive");
+        }
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+                int passed;
+                std::memcpy(&passed, CMSG_DATA(cmsg), sizeof(int));
+                if (fd && *fd == -1) {
+                    *fd = passed;
+                } else {
+                    close(passed);
+                }
+            }
+        }
+        if (n == 0) {
+            if (received == 0) {
+                return false;
+            }
+            throw std::runtime_error("Daemon socket closed in the middle of a message.");
+        }
+        received += static_cast<size_t>(n);
+    }
+    return true;
+}
@@ -0,0 +1,123 @@
+#include "dynamic_batcher.h"
+#include "metrics.h"
+#include <algorithm>
+#include <stdexcept>
+#include <sstream>
+
+DynamicBatcher::DynamicBatcher(TritonClient& triton_client, const TritonModelInfo& model_info, const BatcherConfig& config)
+    : triton_client_{triton_client},
+      // Encoded images vary in size; their length-prefixed elements are simply concatenated
+      frame_byte_size_{model_info.input_datatype == "BYTES"
+                           ? 0
+                           : static_cast<size_t>(model_info.input_channels) * model_info.input_height *
+                                 model_info.input_width * datatype_byte_size(model_info.input_datatype)},
+      max_batch_size_{config.max_batch_size},
+      max_queue_delay_{config.max_queue_delay} {
+    if (model_info.max_batch_size <= 0) {
+        throw std::runtime_error("Dynamic batching requires a model with max_batch_size > 0.");
+    }
+    if (max_batch_size_ == 0 || max_batch_size_ > static_cast<size_t>(model_info.max_batch_size)) {
+        max_batch_size_ = model_info.max_batch_size;
+    }
+    const size_t max_in_flight = std::max<size_t>(1, config.max_in_flight);
+    if (triton_client_.max_in_flight() < max_in_flight) {
+        triton_client_.set_max_in_flight(max_in_flight);
+    }
+    worker_ = std::thread(&DynamicBatcher::worker_loop, this);
+}
+
+DynamicBatcher::~DynamicBatcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    worker_.join();
+    // Completion callbacks own their frames and do not touch the batcher, but callers expect every
+    // future to be ready once the batcher is gone
+    triton_client_.wait_all();
+}
+
+std::future<InferenceResult> DynamicBatcher::submit(uint64_t frame_id, std::vector<uint8_t> input_data) {
+    if (frame_byte_size_ != 0 && input_data.size() != frame_byte_size_) {
+        std::stringstream err_msg;
+        err_msg << "Unexpected input size for batching: " << input_data.size() << " bytes, expecting " << frame_byte_size_;
+        throw std::runtime_error(err_msg.str());
+    }
+    PendingFrame pending{frame_id, std::move(input_data), {}, std::chrono::steady_clock::now()};
+    auto future = pending.promise.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(pending));
+        YOLOV10_GAUGE_SET(MetricGauge::BatcherQueue, queue_.size());
+    }
+    cv_.notify_one();
+    return future;
+}
+
+BatcherStats DynamicBatcher::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void DynamicBatcher::worker_loop() {
+    while (true) {
+        std::vector<PendingFrame> batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return; // stopping and drained
+            }
+            // Wait for the batch to fill, but never keep the oldest frame longer than max_queue_delay.
+            const auto deadline = queue_.front().enqueue_time + max_queue_delay_;
+            cv_.wait_until(lock, deadline, [this] { return stop_ || queue_.size() >= max_batch_size_; });
+
+            const size_t count = std::min(queue_.size(), max_batch_size_);
+            batch.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                batch.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+            YOLOV10_GAUGE_SET(MetricGauge::BatcherQueue, queue_.size());
+            stats_.batches += 1;
+            stats_.frames += count;
+        }
+        // Blocks only while the client's in-flight window is full; frames keep queueing meanwhile
+        // and go out as the next, fuller batch.
+        send_batch(std::move(batch));
+    }
+}
+
+void DynamicBatcher::send_batch(std::vector<PendingFrame>&& batch) {
+    const size_t batch_size = batch.size();
+    // The asynchronous client owns the request body until the response arrives
+    std::vector<uint8_t> input_data;
+    input_data.reserve(frame_byte_size_ != 0 ? frame_byte_size_ * batch_size : batch.front().input_data.size() * batch_size);
+    for (const PendingFrame& frame : batch) {
+        input_data.insert(input_data.end(), frame.input_data.begin(), frame.input_data.end());
+    }
+
+    auto frames = std::make_shared<std::vector<PendingFrame>>(std::move(batch));
+    try {
+        triton_client_.run_inference_async(next_batch_id_++, std::move(input_data), [frames](InferenceResult&& batch_result) {
+            // Every frame shares the batch response and reads its own slice of it
+            for (size_t i = 0; i < frames->size(); ++i) {
+                PendingFrame& frame = (*frames)[i];
+                if (batch_result.error) {
+                    frame.promise.set_exception(batch_result.error);
+                    continue;
+                }
+                InferenceResult result;
+                result.frame_id = frame.frame_id;
+                result.output = batch_result.output;
+                result.batch_index = i;
+                frame.promise.set_value(std::move(result));
+            }
+        }, batch_size);
+    } catch (...) {
+        for (PendingFrame& frame : *frames) {
+            frame.promise.set_exception(std::current_exception());
+        }
+    }
+}
@@ -1,6 +1,15 @@
 #include <iostream>
+#include <iomanip>
+#include <map>
+#include <sstream>
 #include "yolov10.h"
+#include "bulk_runner.h"
 #include "triton_client.h"
+#include "metrics.h"
+#include "model_info_cache.h"
+#include "result_cache.h"
+#include "stream_scheduler.h"
+#include "video_pipeline.h"
 
 void draw(cv::Mat& image, const std::string& label, float conf, int left, int top) {
     const float FONT_SCALE = 0.5;
@@ -24,52 +33,566 @@ std::vector<Detection> infer_image(const cv::Mat& source,
     const std::unique_ptr<TritonClient>& tritonClient, 
     const TritonModelInfo& modelInfo) {
     
-    auto start_pre = std::chrono::steady_clock::now();
-    std::vector<uint8_t> input_data = task->preprocess(source, modelInfo.input_format, modelInfo.single_channel_type, 
-                                                        modelInfo.three_channel_type, modelInfo.input_channels, 
-                                                        cv::Size(modelInfo.input_width, modelInfo.input_height));
-    
-    auto end_pre = std::chrono::steady_clock::now();
-    auto diff_pre = std::chrono::duration_cast<std::chrono::milliseconds>(end_pre - start_pre).count();
-    std::cout << "Preprocess time: " << diff_pre << " ms" << std::endl;
-    auto start_infer = std::chrono::steady_clock::now();
-    auto [infer_results, infer_shapes] = tritonClient->run_inference(input_data);
-
-    auto end_infer = std::chrono::steady_clock::now();
-    auto diff_infer = std::chrono::duration_cast<std::chrono::milliseconds>(end_infer - start_infer).count();
-    std::cout << "Infer time: " << diff_infer << " ms" << std::endl;
-    
-    return task->postprocess(cv::Size(source.cols, source.rows), infer_results, infer_shapes);
+    std::vector<uint8_t> input_data;
+    if (tritonClient->shared_memory_enabled()) {
+        // Preprocess straight into the region the server reads from
+        task->preprocess(source, tritonClient->shared_input_buffer());
+    } else {
+        task->preprocess(source, input_data);
+    }
+
+    InferenceOutput output;
+    if (tritonClient->shared_memory_enabled()) {
+        tritonClient->run_inference_from_shared_memory(output);
+    } else {
+        tritonClient->run_inference(input_data, output);
+    }
+
+    return task->postprocess(cv::Size(source.cols, source.rows), output);
+}
+
+// Stage timings collected by the metrics subsystem (see include/metrics.h).
+void print_stage_latencies() {
+    const ClientMetrics& metrics = client_metrics();
+    for (size_t i = 0; i < static_cast<size_t>(MetricStage::Count); ++i) {
+        const Histogram& latency = metrics.latency(static_cast<MetricStage>(i));
+        if (latency.count() > 0) {
+            std::cout << metric_stage_name(static_cast<MetricStage>(i)) << " time: " << std::fixed << std::setprecision(2)
+                      << latency.sum_us() / 1000.0 / latency.count() << " ms" << std::endl;
+        }
+    }
+}
+
+void print_pipeline_stats(const PipelineStats& stats) {
+    static const char* stage_names[] = {"capture", "preprocess", "infer", "postprocess"};
+    std::cout << "[" << std::fixed << std::setprecision(1) << stats.elapsed_seconds << "s]";
+    for (size_t i = 0; i < static_cast<size_t>(PipelineStage::Count); ++i) {
+        std::cout << " " << stage_names[i] << ": " << stats.stages[i].fps << " fps";
+        if (i > 0) {
+            std::cout << " (queue " << stats.stages[i].queue_depth << ")";
+        }
+    }
+    std::cout << " dropped: " << stats.dropped_frames;
+    if (stats.skipped_frames > 0) {
+        std::cout << " skipped: " << stats.skipped_frames;
+    }
+    std::cout << std::endl;
+}
+
+// `replay`, when set, stands in for `source`: its recorded frames are fed at their recorded pace.
+int run_video(const std::string& source, const std::string& output_path, const PipelineConfig& config,
+              YOLOv10& task, TritonClient& tritonClient, const TritonModelInfo& modelInfo,
+              const std::vector<std::string>& class_names, std::shared_ptr<const TraceReader> replay = nullptr) {
+    VideoPipeline pipeline(task, tritonClient, modelInfo, config);
+    if (replay) {
+        pipeline.open_replay(std::move(replay));
+    } else {
+        pipeline.open(source);
+    }
+
+    cv::VideoWriter writer;
+    pipeline.start([&](PipelineFrame& frame) {
+        if (output_path.empty()) {
+            return;
+        }
+        for (const Detection& detection : frame.detections) {
+            cv::Rect bbox = cv::Rect(cv::Point(detection.bbox.x1, detection.bbox.y1), cv::Point(detection.bbox.x2, detection.bbox.y2));
+            cv::rectangle(frame.frame, bbox, cv::Scalar(255, 0, 0), 2);
+            draw(frame.frame, class_names[detection.class_id], detection.class_confidence, bbox.x, bbox.y - 1);
+        }
+        if (!writer.isOpened()) {
+            writer.open(output_path, cv::VideoWriter::fourcc('m', 'p', '4', 'v'), 25.0, cv::Size(frame.frame.cols, frame.frame.rows));
+        }
+        writer.write(frame.frame);
+    });
+
+    while (!pipeline.finished()) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        print_pipeline_stats(pipeline.stats());
+    }
+    pipeline.wait();
+    print_pipeline_stats(pipeline.stats());
+    if (config.trace) {
+        std::cout << "Trace: " << config.trace->size() << " bytes recorded" << std::endl;
+    }
+    return 0;
+}
+
+bool is_live_source(const std::string& source) {
+    const bool device_index = !source.empty() && std::all_of(source.begin(), source.end(), ::isdigit);
+    return device_index || source.rfind("rtsp://", 0) == 0 || source.rfind("http://", 0) == 0 || source.rfind("https://", 0) == 0;
+}
+
+void print_stream_stats(const std::vector<StreamStats>& streams) {
+    for (const StreamStats& s : streams) {
+        std::cout << "  " << s.name << ": " << s.completed << "/" << s.submitted << " done, dropped " << s.dropped_overflow
+                  << " (overflow) " << s.dropped_stale << " (stale), late " << s.late << ", errors " << s.errors
+                  << ", p50 " << std::fixed << std::setprecision(1) << s.p50_latency_ms << " ms, p99 " << s.p99_latency_ms
+                  << " ms" << std::endl;
+    }
+}
+
+// Several sources sharing one client through the scheduler: one capture/preprocess thread per
+// source, postprocessing in the completion callback. Live sources keep only their newest frame;
+// files block so every frame is inferred.
+int run_streams(const std::vector<std::string>& sources, const std::vector<uint32_t>& weights,
+                std::chrono::milliseconds latency_budget, size_t max_in_flight,
+                const std::function<std::unique_ptr<YOLOv10>()>& make_task, TritonClient& tritonClient) {
+    struct Source {
+        cv::VideoCapture capture;
+        std::unique_ptr<YOLOv10> preprocessor;
+        std::unique_ptr<YOLOv10> postprocessor;
+        std::mutex postprocess_mutex;
+        cv::Size frame_size;
+        std::atomic<uint64_t> detections{0};
+    };
+    SchedulerConfig scheduler_config;
+    scheduler_config.max_in_flight = max_in_flight;
+    StreamScheduler scheduler(tritonClient, scheduler_config);
+
+    std::vector<std::unique_ptr<Source>> streams;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        auto source = std::make_unique<Source>();
+        const bool live = is_live_source(sources[i]);
+        const bool opened = live && std::all_of(sources[i].begin(), sources[i].end(), ::isdigit)
+                                ? source->capture.open(std::stoi(sources[i]))
+                                : source->capture.open(sources[i]);
+        if (!opened || !source->capture.isOpened()) {
+            std::stringstream err_msg;
+            err_msg << "Failed to open video source: " << sources[i];
+            throw std::runtime_error(err_msg.str());
+        }
+        source->preprocessor = make_task();
+        source->postprocessor = make_task();
+        StreamConfig config;
+        config.name = "stream" + std::to_string(i);
+        config.latency_budget = latency_budget;
+        config.weight = i < weights.size() ? weights[i] : 1;
+        config.overflow = live ? StreamOverflow::DropOldest : StreamOverflow::Block;
+        Source* target = source.get();
+        scheduler.add_stream(config, [target](StreamResult&& result) {
+            if (result.result.error || !result.result.output) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(target->postprocess_mutex);
+            target->detections.fetch_add(target->postprocessor->postprocess(target->frame_size, *result.result.output).size(),
+                                         std::memory_order_relaxed);
+        });
+        streams.push_back(std::move(source));
+    }
+
+    std::atomic<size_t> running{streams.size()};
+    std::vector<std::thread> captures;
+    for (size_t i = 0; i < streams.size(); ++i) {
+        captures.emplace_back([&, i] {
+            Source& source = *streams[i];
+            cv::Mat frame;
+            uint64_t frame_id = 0;
+            while (source.capture.read(frame) && !frame.empty()) {
+                const auto capture_time = std::chrono::steady_clock::now();
+                {
+                    std::lock_guard<std::mutex> lock(source.postprocess_mutex);
+                    source.frame_size = frame.size();
+                }
+                std::vector<uint8_t> input_data;
+                source.preprocessor->preprocess(frame, input_data);
+                if (!scheduler.submit(i, frame_id++, std::move(input_data), capture_time)) {
+                    break;
+                }
+            }
+            running.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    const auto drained = [&] {
+        const std::vector<StreamStats> stats = scheduler.stats();
+        return std::all_of(stats.begin(), stats.end(), [](const StreamStats& s) { return s.queued == 0; });
+    };
+    while (running.load(std::memory_order_acquire) > 0 || !drained()) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        std::cout << "Streams:" << std::endl;
+        print_stream_stats(scheduler.stats());
+    }
+    for (auto& capture : captures) {
+        capture.join();
+    }
+    scheduler.stop();
+    std::cout << "Streams done:" << std::endl;
+    print_stream_stats(scheduler.stats());
+    return 0;
+}
+
+void print_cache_stats(const ResultCache& cache) {
+    const ResultCacheStats stats = cache.stats();
+    std::cout << "Result cache: " << stats.hits << " hits, " << stats.misses << " misses (" << std::fixed << std::setprecision(1)
+              << 100.0 * stats.hit_rate() << "% hit rate), " << stats.evictions << " evictions, " << stats.entries << "/"
+              << stats.capacity << " entries" << std::endl;
+}
+
+// Everything a cached result depends on besides the image. `tiling` is null for untiled results.
+std::string result_cache_context(const std::string& model_name, const TritonModelInfo& model_info,
+                                 const PostprocessConfig& postprocess, bool letterbox, int jpeg_quality,
+                                 const TilingConfig* tiling) {
+    std::stringstream context;
+    context << model_name << ' ' << model_info.input_width << 'x' << model_info.input_height << ' '
+            << model_info.input_datatype << ' ' << (letterbox ? "letterbox" : "stretch") << ' '
+            << postprocess.confidence_threshold << ' ' << postprocess.max_detections;
+    if (model_info.input_datatype == "BYTES") {
+        // The server sees the recompressed frame
+        context << " q" << jpeg_quality;
+    }
+    if (tiling) {
+        context << " tile " << tiling->overlap << ' ' << static_cast<int>(tiling->merge) << ' '
+                << static_cast<int>(tiling->match) << ' ' << tiling->match_threshold << ' '
+                << (tiling->full_frame ? "full" : "tiles") << ' ' << tiling->max_batch_size << '/'
+                << model_info.max_batch_size;
+    } else {
+        context << " untiled";
+    }
+    std::map<int, float> class_thresholds(postprocess.class_thresholds.begin(), postprocess.class_thresholds.end());
+    for (const auto& [class_id, threshold] : class_thresholds) {
+        context << " c" << class_id << ':' << threshold;
+    }
+    for (int class_id : postprocess.allowed_classes) {
+        context << " a" << class_id;
+    }
+    return context.str();
+}
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " <path_to_image>" << std::endl;
+    std::cerr << "       " << program << " --video <file|rtsp_url|device_index> [--output <video_file>] [--drop-frames] [--motion-gate] [--tile] [--record <trace>]" << std::endl;
+    std::cerr << "       " << program << " --replay <trace> [--output <video_file>]" << std::endl;
+    std::cerr << "       " << program << " --streams <source,source,...> [--stream-budget <ms>] [--stream-weights <w,w,...>]" << std::endl;
+    std::cerr << "       " << program << " --bulk <image_dir|manifest> [--bulk-output <file>] [--bulk-format jsonl|binary] [--decode-threads <n>] [--resume]" << std::endl;
+    std::cerr << "Options: --server <host:port,...>  Triton endpoints to balance over (default localhost:8001)" << std::endl;
+    std::cerr << "         --http               use the HTTP protocol instead of gRPC" << std::endl;
+    std::cerr << "         --model <name>       model to run (default yolov10m)" << std::endl;
+    std::cerr << "         --warmup <n>         send n dummy requests to every server before starting" << std::endl;
+    std::cerr << "         --no-model-cache     always fetch the model configuration from the server" << std::endl;
+    std::cerr << "         --hedge              re-send slow blocking requests to a second endpoint" << std::endl;
+    std::cerr << "         --max-in-flight <n>  outstanding async inference requests (default 1)" << std::endl;
+    std::cerr << "         --motion-gate        skip inference on frames without motion and track detections instead" << std::endl;
+    std::cerr << "         --motion-threshold <f>  fraction of changed pixels that counts as motion (default 0.002)" << std::endl;
+    std::cerr << "         --max-skip <n>       run inference at least every n+1 frames while gated (default 30)" << std::endl;
+    std::cerr << "         --tile               cut large frames into overlapping model-sized tiles (small objects)" << std::endl;
+    std::cerr << "         --tile-overlap <px>  minimum overlap between neighbouring tiles (default 96)" << std::endl;
+    std::cerr << "         --tile-merge nms|wbf merge duplicates across tiles by NMS or weighted box fusion (default nms)" << std::endl;
+    std::cerr << "         --record <trace>     record frames, inputs, outputs and latencies of a --video run" << std::endl;
+    std::cerr << "         --replay <trace>     run the recorded frames again at their recorded pace" << std::endl;
+    std::cerr << "         --stream-budget <ms> drop stream frames that waited longer than this (default 200)" << std::endl;
+    std::cerr << "         --stream-weights <w,...>  relative share of inference per stream (default 1 each)" << std::endl;
+    std::cerr << "         --grpc-stream        send async requests over a gRPC bidirectional stream" << std::endl;
+    std::cerr << "         --jpeg-quality <q>   JPEG quality for models that take encoded images (default 90)" << std::endl;
+    std::cerr << "         --result-cache <n>   cache the detections of up to n images and skip duplicates" << std::endl;
+    std::cerr << "         --result-cache-file <path>  keep the result cache in a memory-mapped file across runs" << std::endl;
+    std::cerr << "         --result-cache-key exact|perceptual  match identical files or resized/re-encoded copies (default exact)" << std::endl;
+    std::cerr << "         --letterbox          keep the aspect ratio and pad instead of stretching" << std::endl;
+    std::cerr << "         --shm                exchange tensors through system shared memory (server on this host)" << std::endl;
+    std::cerr << "         --conf <t>           confidence threshold (default 0.1)" << std::endl;
+    std::cerr << "         --class-conf <id:t,...>  per-class confidence thresholds" << std::endl;
+    std::cerr << "         --classes <id,...>   only report these class ids" << std::endl;
+    std::cerr << "         --max-det <n>        keep the n highest-scoring detections per frame" << std::endl;
+    std::cerr << "         --metrics-port <p>   serve Prometheus metrics on http://127.0.0.1:<p>/metrics" << std::endl;
+}
+
+std::vector<std::string> split_list(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+// "0:0.5,2:0.25" -> {0: 0.5, 2: 0.25}
+std::unordered_map<int, float> parse_class_thresholds(const std::string& list) {
+    std::unordered_map<int, float> thresholds;
+    for (const std::string& item : split_list(list)) {
+        const size_t separator = item.find(':');
+        if (separator == std::string::npos) {
+            throw std::runtime_error("Expected <class_id>:<threshold> in --class-conf, got " + item);
+        }
+        thresholds[std::stoi(item.substr(0, separator))] = std::stof(item.substr(separator + 1));
+    }
+    return thresholds;
 }
 
 int main(int argc, char** argv) {
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << "<path_to_image>" << std::endl;
+        print_usage(argv[0]);
         return 1; 
     }
 
+    std::string image_path;
+    std::string video_source;
+    std::string video_output;
+    std::string record_path;
+    std::string replay_path;
+    std::vector<std::string> stream_sources;
+    std::vector<uint32_t> stream_weights;
+    std::chrono::milliseconds stream_budget{200};
+    bool drop_frames = false;
+    size_t max_in_flight = 1;
+    bool motion_gating = false;
+    MotionGateConfig motion_gate_config;
+    bool tiling = false;
+    TilingConfig tiling_config;
+    int jpeg_quality = 90;
+    bool grpc_stream = false;
+    bool letterbox = false;
+    size_t result_cache_capacity = 0;
+    ResultCacheConfig result_cache_config;
+    bool shared_memory = false;
+    PostprocessConfig postprocess_config;
+    int metrics_port = 0;
+    std::vector<std::string> server_urls;
+    ProtocolType protocol = ProtocolType::GRPC;
+    std::string model_name = "yolov10m";
+    size_t warmup_requests = 0;
+    BulkConfig bulk_config;
+    bulk_config.output = "detections.jsonl";
+    bool max_in_flight_set = false;
+    bool model_cache = true;
+    LoadBalancingConfig balancing;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--server" && i + 1 < argc) {
+            for (const std::string& url : split_list(argv[++i])) {
+                server_urls.push_back(url);
+            }
+        } else if (arg == "--http") {
+            protocol = ProtocolType::HTTP;
+        } else if (arg == "--model" && i + 1 < argc) {
+            model_name = argv[++i];
+        } else if (arg == "--bulk" && i + 1 < argc) {
+            bulk_config.input = argv[++i];
+        } else if (arg == "--bulk-output" && i + 1 < argc) {
+            bulk_config.output = argv[++i];
+        } else if (arg == "--bulk-format" && i + 1 < argc) {
+            const std::string format = argv[++i];
+            if (format != "jsonl" && format != "binary") {
+                print_usage(argv[0]);
+                return 1;
+            }
+            bulk_config.format = format == "binary" ? BulkOutputFormat::Binary : BulkOutputFormat::Jsonl;
+        } else if (arg == "--decode-threads" && i + 1 < argc) {
+            bulk_config.decode_threads = std::stoul(argv[++i]);
+        } else if (arg == "--resume") {
+            bulk_config.resume = true;
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            warmup_requests = std::stoul(argv[++i]);
+        } else if (arg == "--no-model-cache") {
+            model_cache = false;
+        } else if (arg == "--hedge") {
+            balancing.hedging = true;
+        } else if (arg == "--video" && i + 1 < argc) {
+            video_source = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            video_output = argv[++i];
+        } else if (arg == "--record" && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (arg == "--streams" && i + 1 < argc) {
+            stream_sources = split_list(argv[++i]);
+        } else if (arg == "--stream-budget" && i + 1 < argc) {
+            stream_budget = std::chrono::milliseconds(std::stoul(argv[++i]));
+        } else if (arg == "--stream-weights" && i + 1 < argc) {
+            for (const std::string& weight : split_list(argv[++i])) {
+                stream_weights.push_back(static_cast<uint32_t>(std::stoul(weight)));
+            }
+        } else if (arg == "--drop-frames") {
+            drop_frames = true;
+        } else if (arg == "--motion-gate") {
+            motion_gating = true;
+        } else if (arg == "--motion-threshold" && i + 1 < argc) {
+            motion_gate_config.changed_fraction = std::stof(argv[++i]);
+        } else if (arg == "--max-skip" && i + 1 < argc) {
+            motion_gate_config.max_skip = std::stoul(argv[++i]);
+        } else if (arg == "--tile") {
+            tiling = true;
+        } else if (arg == "--tile-overlap" && i + 1 < argc) {
+            tiling_config.overlap = std::stoi(argv[++i]);
+        } else if (arg == "--tile-merge" && i + 1 < argc) {
+            const std::string merge = argv[++i];
+            if (merge != "nms" && merge != "wbf") {
+                print_usage(argv[0]);
+                return 1;
+            }
+            tiling_config.merge = merge == "wbf" ? TileMerge::WeightedFusion : TileMerge::Nms;
+        } else if (arg == "--max-in-flight" && i + 1 < argc) {
+            max_in_flight = std::stoul(argv[++i]);
+            max_in_flight_set = true;
+        } else if (arg == "--grpc-stream") {
+            grpc_stream = true;
+        } else if (arg == "--jpeg-quality" && i + 1 < argc) {
+            jpeg_quality = std::stoi(argv[++i]);
+        } else if (arg == "--result-cache" && i + 1 < argc) {
+            result_cache_capacity = std::stoul(argv[++i]);
+        } else if (arg == "--result-cache-file" && i + 1 < argc) {
+            result_cache_config.path = argv[++i];
+        } else if (arg == "--result-cache-key" && i + 1 < argc) {
+            const std::string mode = argv[++i];
+            if (mode != "exact" && mode != "perceptual") {
+                print_usage(argv[0]);
+                return 1;
+            }
+            result_cache_config.mode = mode == "perceptual" ? CacheKeyMode::Perceptual : CacheKeyMode::Exact;
+        } else if (arg == "--letterbox") {
+            letterbox = true;
+        } else if (arg == "--shm") {
+            shared_memory = true;
+        } else if (arg == "--conf" && i + 1 < argc) {
+            postprocess_config.confidence_threshold = std::stof(argv[++i]);
+        } else if (arg == "--class-conf" && i + 1 < argc) {
+            postprocess_config.class_thresholds = parse_class_thresholds(argv[++i]);
+        } else if (arg == "--classes" && i + 1 < argc) {
+            for (const std::string& class_id : split_list(argv[++i])) {
+                postprocess_config.allowed_classes.push_back(std::stoi(class_id));
+            }
+        } else if (arg == "--max-det" && i + 1 < argc) {
+            postprocess_config.max_detections = std::stoul(argv[++i]);
+        } else if (arg == "--metrics-port" && i + 1 < argc) {
+            metrics_port = std::stoi(argv[++i]);
+        } else if (arg.rfind("--", 0) == 0) {
+            print_usage(argv[0]);
+            return 1;
+        } else {
+            image_path = arg;
+        }
+    }
+    if (image_path.empty() && video_source.empty() && replay_path.empty() && bulk_config.input.empty() && stream_sources.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::unique_ptr<MetricsServer> metrics_server;
+    if (metrics_port > 0) {
+        metrics_server = std::make_unique<MetricsServer>(metrics_port);
+    }
+
     std::cout << "START TRITON CLIENT" << std::endl;
     std::vector<int64_t> input_sizes{1, 3, 640, 640}; 
-    std::string server_address = "localhost";
-    std::string model_name = "yolov10m";
-    std::string url = server_address + ":8001"; // 8000 HTTP
-    ProtocolType protocol = ProtocolType::GRPC; // ProtocolType::HTTP
+    if (server_urls.empty()) {
+        server_urls.push_back(protocol == ProtocolType::GRPC ? "localhost:8001" : "localhost:8000");
+    }
+    const auto startup_begin = std::chrono::steady_clock::now();
 
     // Create Triton client
-    std::unique_ptr<TritonClient> tritonClient = std::make_unique<TritonClient>(url, protocol, model_name);
+    std::unique_ptr<TritonClient> tritonClient = std::make_unique<TritonClient>(server_urls, protocol, model_name, "", false, balancing);
+    if (model_cache) {
+        tritonClient->set_model_info_cache(std::make_shared<ModelInfoCache>());
+    }
     tritonClient->initialize_triton_client();
+    if (grpc_stream) {
+        tritonClient->enable_streaming();
+    }
 
-    TritonModelInfo modelInfo = tritonClient->retrieve_model_info(model_name, server_address, input_sizes);
-    std::unique_ptr<YOLOv10> task = std::make_unique<YOLOv10>(modelInfo.input_width, modelInfo.input_height);
+    TritonModelInfo modelInfo = tritonClient->retrieve_model_info(model_name, input_sizes);
+    if (shared_memory && tritonClient->enable_shared_memory()) {
+        std::cout << "Using system shared memory for inputs and outputs" << std::endl;
+    }
+    if (warmup_requests > 0) {
+        tritonClient->warm_up(warmup_requests);
+    }
+    std::cout << "Client ready in " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startup_begin).count()
+              << " ms" << std::endl;
+    const auto make_task = [&] {
+        auto task = std::make_unique<YOLOv10>(modelInfo.input_width, modelInfo.input_height, modelInfo.input_format,
+                                              modelInfo.input_datatype);
+        if (letterbox) {
+            task->set_resize_mode(ResizeMode::Letterbox);
+        }
+        task->set_postprocess_config(postprocess_config);
+        task->set_jpeg_quality(jpeg_quality);
+        return task;
+    };
+    std::unique_ptr<YOLOv10> task = make_task();
+    std::shared_ptr<ResultCache> result_cache;
+    if (result_cache_capacity > 0 || !result_cache_config.path.empty()) {
+        result_cache_config.capacity = result_cache_capacity > 0 ? result_cache_capacity : result_cache_config.capacity;
+        if (postprocess_config.max_detections > 0) {
+            result_cache_config.max_detections = postprocess_config.max_detections;
+        }
+        // Only single images are tiled; bulk mode always sends whole frames
+        const bool tiled_results = tiling && bulk_config.input.empty();
+        result_cache_config.context = result_cache_context(model_name, modelInfo, postprocess_config, letterbox, jpeg_quality,
+                                                           tiled_results ? &tiling_config : nullptr);
+        result_cache = std::make_shared<ResultCache>(result_cache_config);
+    }
+    if (!stream_sources.empty()) {
+        // One request per stream in flight unless told otherwise
+        const size_t stream_in_flight = max_in_flight_set ? max_in_flight : stream_sources.size();
+        return run_streams(stream_sources, stream_weights, stream_budget, stream_in_flight, make_task, *tritonClient);
+    }
+    if (!bulk_config.input.empty()) {
+        // Bulk mode keeps several requests outstanding unless told otherwise
+        bulk_config.max_in_flight = max_in_flight_set ? max_in_flight : bulk_config.max_in_flight;
+        BulkRunner runner(*tritonClient, modelInfo, postprocess_config, letterbox ? ResizeMode::Letterbox : ResizeMode::Stretch, bulk_config);
+        runner.set_result_cache(result_cache);
+        const BulkStats stats = runner.run();
+        std::cout << "Bulk done: " << stats.processed << " images (" << stats.failed << " failed) in " << std::fixed
+                  << std::setprecision(1) << stats.elapsed_seconds << " s";
+        if (stats.resumed_from > 0) {
+            std::cout << ", resumed at image " << stats.resumed_from;
+        }
+        std::cout << std::endl;
+        print_stage_latencies();
+        if (result_cache) {
+            print_cache_stats(*result_cache);
+        }
+        return stats.failed == 0 ? 0 : 2;
+    }
     const auto class_names = task->read_label_names("../labels/classes.txt");
+    if (!video_source.empty() || !replay_path.empty()) {
+        PipelineConfig pipeline_config;
+        pipeline_config.drop_when_full = drop_frames;
+        pipeline_config.max_in_flight = max_in_flight;
+        pipeline_config.motion_gating = motion_gating;
+        pipeline_config.motion_gate = motion_gate_config;
+        pipeline_config.tiling = tiling;
+        pipeline_config.tiler = tiling_config;
+        std::shared_ptr<const TraceReader> replay;
+        if (!replay_path.empty()) {
+            replay = std::make_shared<TraceReader>(replay_path);
+            std::cout << "Replaying " << replay->records(TraceRecordType::Frame).size() << " frames of " << replay_path
+                      << " (recorded from " << replay->meta("source", "unknown source") << ")" << std::endl;
+        }
+        if (!record_path.empty()) {
+            pipeline_config.trace = std::make_shared<TraceWriter>(record_path);
+            pipeline_config.trace->append_meta({{"model", model_name},
+                                                {"source", replay ? replay->meta("source", replay_path) : video_source}});
+        }
+        return run_video(video_source, video_output, pipeline_config, *task, *tritonClient, modelInfo, class_names, replay);
+    }
     auto start = std::chrono::steady_clock::now();
-    std::string image_path = argv[1]; 
     cv::Mat image = cv::imread(image_path);
     if (image.empty()) {
         std::cerr << "Error loading image: " << image_path << std::endl;
         return 1; 
     }
-    std::vector<Detection> predictions = infer_image(image, task, tritonClient, modelInfo);
+    std::vector<Detection> predictions;
+    std::optional<uint64_t> cache_key;
+    std::optional<CachedResult> cached;
+    if (result_cache) {
+        cache_key = result_cache->key(image);
+        cached = result_cache->lookup(*cache_key, image.size());
+    }
+    if (cached) {
+        predictions = std::move(cached->detections);
+    } else if (tiling) {
+        FrameTiler tiler(*task, modelInfo, tiling_config);
+        predictions = tiler.infer(*tritonClient, image);
+    } else {
+        predictions = infer_image(image, task, tritonClient, modelInfo);
+    }
+    if (result_cache && !cached) {
+        result_cache->insert(*cache_key, image.size(), predictions);
+    }
     auto end = std::chrono::steady_clock::now();
     auto diff = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
     
@@ -78,6 +601,10 @@ int main(int argc, char** argv) {
         cv::rectangle(image, bbox, cv::Scalar(255, 0, 0), 2);
         draw(image, class_names[detection.class_id], detection.class_confidence, bbox.x, bbox.y - 1);
     }    
+    print_stage_latencies();
+    if (result_cache) {
+        print_cache_stats(*result_cache);
+    }
     std::cout << "Total time: " << diff << " ms" << std::endl;
     std::string processedFrameFilename = "processed_image.jpg";
     std::cout << "Saving image processed: " << processedFrameFilename << std::endl;
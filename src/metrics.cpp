@@ -0,0 +1,226 @@
+#include "metrics.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+size_t Histogram::bucket_index(uint64_t value_us) {
+    if (value_us < kSubBuckets) {
+        return static_cast<size_t>(value_us);
+    }
+    const int magnitude = 63 - __builtin_clzll(value_us);
+    if (magnitude > kMaxMagnitude) {
+        return kBucketCount - 1;
+    }
+    const size_t sub_bucket = (value_us >> (magnitude - kSubBucketBits)) & (kSubBuckets - 1);
+    return static_cast<size_t>(magnitude - kSubBucketBits + 1) * kSubBuckets + sub_bucket;
+}
+
+uint64_t Histogram::bucket_upper_bound(size_t index) {
+    if (index < static_cast<size_t>(kSubBuckets)) {
+        return index;
+    }
+    const int magnitude = static_cast<int>(index / kSubBuckets) + kSubBucketBits - 1;
+    const uint64_t sub_bucket = index % kSubBuckets;
+    const uint64_t width = uint64_t{1} << (magnitude - kSubBucketBits);
+    return (kSubBuckets + sub_bucket) * width + width - 1;
+}
+
+uint64_t Histogram::count_at_or_below(uint64_t bound_us) const {
+    uint64_t count = 0;
+    for (size_t i = 0; i < kBucketCount && bucket_upper_bound(i) <= bound_us; ++i) {
+        count += bucket(i);
+    }
+    return count;
+}
+
+uint64_t Histogram::quantile_us(double q) const {
+    const uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * total + 0.5));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        seen += bucket(i);
+        if (seen >= rank) {
+            return bucket_upper_bound(i);
+        }
+    }
+    return bucket_upper_bound(kBucketCount - 1);
+}
+
+const char* metric_stage_name(MetricStage stage) {
+    static const char* names[] = {"preprocess", "serialize", "network", "deserialize", "postprocess"};
+    return names[static_cast<size_t>(stage)];
+}
+
+std::string ClientMetrics::render_prometheus() const {
+    // Exported bucket bounds; the fine-grained buckets are folded into these.
+    static const uint64_t bounds_us[] = {50,    100,    250,    500,     1000,    2500,    5000,   10000,
+                                         25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 10000000};
+    std::ostringstream out;
+    out << "# HELP yolov10_stage_latency_seconds Client-side latency per stage.\n";
+    out << "# TYPE yolov10_stage_latency_seconds histogram\n";
+    for (size_t s = 0; s < latency_.size(); ++s) {
+        const char* stage = metric_stage_name(static_cast<MetricStage>(s));
+        const Histogram& histogram = latency_[s];
+        // Read the total first so the +Inf bucket is never below a concurrently growing bucket
+        const uint64_t count = histogram.count();
+        for (uint64_t bound : bounds_us) {
+            out << "yolov10_stage_latency_seconds_bucket{stage=\"" << stage << "\",le=\"" << bound / 1e6 << "\"} "
+                << std::min(count, histogram.count_at_or_below(bound)) << "\n";
+        }
+        out << "yolov10_stage_latency_seconds_bucket{stage=\"" << stage << "\",le=\"+Inf\"} " << count << "\n";
+        out << "yolov10_stage_latency_seconds_sum{stage=\"" << stage << "\"} " << histogram.sum_us() / 1e6 << "\n";
+        out << "yolov10_stage_latency_seconds_count{stage=\"" << stage << "\"} " << count << "\n";
+    }
+
+    out << "# HELP yolov10_stage_latency_quantile_seconds Latency quantiles per stage, from the full-resolution histogram.\n";
+    out << "# TYPE yolov10_stage_latency_quantile_seconds gauge\n";
+    for (size_t s = 0; s < latency_.size(); ++s) {
+        const char* stage = metric_stage_name(static_cast<MetricStage>(s));
+        for (double q : {0.5, 0.9, 0.99, 0.999}) {
+            out << "yolov10_stage_latency_quantile_seconds{stage=\"" << stage << "\",quantile=\"" << q << "\"} "
+                << latency_[s].quantile_us(q) / 1e6 << "\n";
+        }
+    }
+
+    static const char* counter_names[] = {"yolov10_frames_total", "yolov10_requests_total", "yolov10_errors_total",
+                                          "yolov10_dropped_frames_total", "yolov10_hedged_requests_total",
+                                          "yolov10_endpoint_ejections_total", "yolov10_skipped_frames_total"};
+    static const char* counter_help[] = {"Frames postprocessed.", "Inference requests sent.",
+                                         "Failed inference requests and pipeline errors.",
+                                         "Frames dropped because the pipeline was full.",
+                                         "Duplicate requests sent to a second endpoint after the hedge delay.",
+                                         "Endpoints taken out of rotation after a failed request or health check.",
+                                         "Frames the motion gate answered from the tracker without inference."};
+    for (size_t i = 0; i < counters_.size(); ++i) {
+        out << "# HELP " << counter_names[i] << " " << counter_help[i] << "\n";
+        out << "# TYPE " << counter_names[i] << " counter\n";
+        out << counter_names[i] << " " << counters_[i].value() << "\n";
+    }
+
+    static const char* queue_names[] = {"capture", "preprocess", "infer"};
+    out << "# HELP yolov10_queue_depth Frames waiting in front of each pipeline stage.\n";
+    out << "# TYPE yolov10_queue_depth gauge\n";
+    for (size_t i = 0; i < 3; ++i) {
+        out << "yolov10_queue_depth{queue=\"" << queue_names[i] << "\"} " << gauges_[i].value() << "\n";
+    }
+    out << "# HELP yolov10_in_flight_requests Asynchronous requests awaiting a response.\n";
+    out << "# TYPE yolov10_in_flight_requests gauge\n";
+    out << "yolov10_in_flight_requests " << gauge(MetricGauge::InFlight).value() << "\n";
+    out << "# HELP yolov10_batcher_queue_depth Frames waiting in the dynamic batcher.\n";
+    out << "# TYPE yolov10_batcher_queue_depth gauge\n";
+    out << "yolov10_batcher_queue_depth " << gauge(MetricGauge::BatcherQueue).value() << "\n";
+    std::lock_guard<std::mutex> lock(collectors_mutex_);
+    for (const auto& [id, collector] : collectors_) {
+        collector(out);
+    }
+    return out.str();
+}
+
+size_t ClientMetrics::add_collector(Collector collector) {
+    std::lock_guard<std::mutex> lock(collectors_mutex_);
+    collectors_.emplace(next_collector_, std::move(collector));
+    return next_collector_++;
+}
+
+void ClientMetrics::remove_collector(size_t id) {
+    std::lock_guard<std::mutex> lock(collectors_mutex_);
+    collectors_.erase(id);
+}
+
+ClientMetrics& client_metrics() {
+    static ClientMetrics metrics;
+    return metrics;
+}
+
+MetricsServer::MetricsServer(int port, const std::string& bind_address) {
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        throw std::runtime_error("Failed to create metrics socket.");
+    }
+    int one = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (::inet_pton(AF_INET, bind_address.c_str(), &address.sin_addr) != 1 ||
+        ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listen_fd_, 16) != 0) {
+        ::close(listen_fd_);
+        std::stringstream err_msg;
+        err_msg << "Failed to serve metrics on " << bind_address << ":" << port << ": " << std::strerror(errno);
+        throw std::runtime_error(err_msg.str());
+    }
+    thread_ = std::thread(&MetricsServer::serve, this);
+}
+
+MetricsServer::~MetricsServer() {
+    stop_.store(true, std::memory_order_release);
+    // Unblocks accept()
+    ::shutdown(listen_fd_, SHUT_RDWR);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    ::close(listen_fd_);
+}
+
+// One connection at a time: scrapes are infrequent and the response is rendered in microseconds.
+void MetricsServer::serve() {
+    int last_errno = 0;
+    while (!stop_.load(std::memory_order_acquire)) {
+        const int fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            // EMFILE and friends persist until something else changes; don't spin on them
+            if (errno != last_errno && !stop_.load(std::memory_order_acquire)) {
+                last_errno = errno;
+                std::cerr << "Metrics endpoint accept failed: " << std::strerror(errno) << std::endl;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+        last_errno = 0;
+        timeval timeout{1, 0};
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        std::string request;
+        char chunk[1024];
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+            const ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) {
+                break;
+            }
+            request.append(chunk, static_cast<size_t>(n));
+        }
+
+        std::string status = "200 OK";
+        std::string body;
+        if (request.rfind("GET /metrics", 0) == 0) {
+            body = client_metrics().render_prometheus();
+        } else {
+            status = "404 Not Found";
+            body = "Only GET /metrics is served.\n";
+        }
+        const std::string response = "HTTP/1.1 " + status +
+                                     "\r\nContent-Type: text/plain; version=0.0.4\r\nConnection: close\r\nContent-Length: " +
+                                     std::to_string(body.size()) + "\r\n\r\n" + body;
+        size_t written = 0;
+        while (written < response.size()) {
+            const ssize_t n = ::send(fd, response.data() + written, response.size() - written, MSG_NOSIGNAL);
+            if (n <= 0) {
+                break;
+            }
+            written += static_cast<size_t>(n);
+        }
+        ::close(fd);
+    }
+}
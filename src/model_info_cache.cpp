@@ -0,0 +1,163 @@
+#include "model_info_cache.h"
+#include <cctype>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h>
+
+namespace {
+
+constexpr const char* kFormatTag = "yolov10-model-info";
+constexpr int kFormatVersion = 2;
+
+void write_dims(std::ostream& out, const std::vector<int64_t>& dims) {
+    out << dims.size();
+    for (int64_t dim : dims) {
+        out << ' ' << dim;
+    }
+}
+
+bool read_dims(std::istream& in, std::vector<int64_t>& dims) {
+    size_t count = 0;
+    if (!(in >> count) || count > 16) {
+        return false;
+    }
+    dims.resize(count);
+    for (int64_t& dim : dims) {
+        if (!(in >> dim)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Reads "<key> <value...>" and checks the key, so a reordered or truncated file is rejected.
+bool expect_key(std::istream& in, const char* key) {
+    std::string word;
+    return static_cast<bool>(in >> word) && word == key;
+}
+
+} // namespace
+
+ModelInfoCache::ModelInfoCache(std::string directory, std::chrono::seconds max_age)
+    : directory_{std::move(directory)}, max_age_{max_age} {}
+
+std::string ModelInfoCache::default_directory() {
+    if (const char* dir = std::getenv("YOLOV10_CACHE_DIR"); dir && *dir) {
+        return dir;
+    }
+    if (const char* dir = std::getenv("XDG_CACHE_HOME"); dir && *dir) {
+        return std::string(dir) + "/yolov10-triton";
+    }
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return std::string(home) + "/.cache/yolov10-triton";
+    }
+    return (std::filesystem::temp_directory_path() / "yolov10-triton").string();
+}
+
+std::string ModelInfoCache::fingerprint(const std::string& data) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : data) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    std::stringstream stream;
+    stream << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return stream.str();
+}
+
+std::string ModelInfoCache::path(const std::string& server, const std::string& model_name,
+                                 const std::string& model_version) const {
+    // URLs make poor file names; the server is only told apart by its hash
+    std::string file_name = model_name + "@" + (model_version.empty() ? "latest" : model_version) + "." + fingerprint(server);
+    for (char& c : file_name) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_' && c != '.' && c != '@') {
+            c = '_';
+        }
+    }
+    return directory_ + "/" + file_name + ".info";
+}
+
+bool ModelInfoCache::fresh(const Entry& entry) const {
+    return std::chrono::system_clock::now() - entry.stored < max_age_;
+}
+
+std::optional<ModelInfoCache::Entry> ModelInfoCache::load(const std::string& server, const std::string& model_name,
+                                                         const std::string& model_version) const {
+    std::ifstream in(path(server, model_name, model_version));
+    if (!in) {
+        return std::nullopt;
+    }
+    Entry entry;
+    TritonModelInfo& info = entry.info;
+    std::string tag;
+    int version = 0;
+    int64_t stored_seconds = 0;
+    size_t output_count = 0;
+    const bool ok = in >> tag >> version && tag == kFormatTag && version == kFormatVersion &&
+                    expect_key(in, "fingerprint") && in >> entry.fingerprint &&
+                    expect_key(in, "stored") && in >> stored_seconds &&
+                    expect_key(in, "input") && in >> std::quoted(info.input_name) >> info.input_datatype >> info.input_format &&
+                    expect_key(in, "input_chw") && in >> info.input_channels >> info.input_height >> info.input_width &&
+                    expect_key(in, "input_shape") && read_dims(in, info.input_shape) &&
+                    expect_key(in, "max_batch_size") && in >> info.max_batch_size &&
+                    expect_key(in, "batch_size") && in >> info.batch_size &&
+                    expect_key(in, "outputs") && in >> output_count && output_count <= 64;
+    if (!ok) {
+        return std::nullopt;
+    }
+    for (size_t i = 0; i < output_count; ++i) {
+        std::string name;
+        std::string datatype;
+        std::vector<int64_t> shape;
+        if (!expect_key(in, "output") || !(in >> std::quoted(name) >> datatype) || !read_dims(in, shape)) {
+            return std::nullopt;
+        }
+        info.output_names.push_back(std::move(name));
+        info.output_datatypes.push_back(std::move(datatype));
+        info.output_shapes.push_back(std::move(shape));
+    }
+    entry.stored = std::chrono::system_clock::time_point(std::chrono::seconds(stored_seconds));
+    return entry;
+}
+
+void ModelInfoCache::store(const std::string& server, const std::string& model_name, const std::string& model_version,
+                           const TritonModelInfo& info, const std::string& fingerprint) const {
+    const std::string file_path = path(server, model_name, model_version);
+    // Written to a temporary file and renamed, so a concurrently starting worker never reads half an entry
+    const std::string tmp_path = file_path + ".tmp." + std::to_string(getpid());
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    {
+        std::ofstream out(tmp_path, std::ios::trunc);
+        if (!out) {
+            std::cerr << "Model info cache: cannot write " << tmp_path << std::endl;
+            return;
+        }
+        const auto stored = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch());
+        out << kFormatTag << ' ' << kFormatVersion << '\n';
+        out << "fingerprint " << fingerprint << '\n';
+        out << "stored " << stored.count() << '\n';
+        out << "input " << std::quoted(info.input_name) << ' ' << info.input_datatype << ' ' << info.input_format << '\n';
+        out << "input_chw " << info.input_channels << ' ' << info.input_height << ' ' << info.input_width << '\n';
+        out << "input_shape ";
+        write_dims(out, info.input_shape);
+        out << "\nmax_batch_size " << info.max_batch_size << '\n';
+        out << "batch_size " << info.batch_size << '\n';
+        out << "outputs " << info.output_names.size() << '\n';
+        for (size_t i = 0; i < info.output_names.size(); ++i) {
+            out << "output " << std::quoted(info.output_names[i]) << ' ' << info.output_datatypes.at(i) << ' ';
+            write_dims(out, info.output_shapes.at(i));
+            out << '\n';
+        }
+        if (!out.flush()) {
+            std::cerr << "Model info cache: failed to write " << tmp_path << std::endl;
+            std::filesystem::remove(tmp_path, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(tmp_path, file_path, ec);
+    if (ec) {
+        std::cerr << "Model info cache: cannot update " << file_path << ": " << ec.message() << std::endl;
+        std::filesystem::remove(tmp_path, ec);
+    }
+}
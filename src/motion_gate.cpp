@@ -0,0 +1,41 @@
+#include "motion_gate.h"
+
+void MotionGate::thumbnail(const cv::Mat& frame, cv::Mat& gray) {
+    const int width = std::max(8, std::min(config_.thumbnail_width, frame.cols));
+    const int height = std::max(1, static_cast<int>(static_cast<int64_t>(frame.rows) * width / std::max(frame.cols, 1)));
+    // INTER_AREA averages each block, which also suppresses sensor noise and compression artifacts
+    cv::resize(frame, small_, cv::Size(width, height), 0, 0, cv::INTER_AREA);
+    if (small_.channels() == 3) {
+        cv::cvtColor(small_, gray, cv::COLOR_BGR2GRAY);
+    } else if (small_.channels() == 4) {
+        cv::cvtColor(small_, gray, cv::COLOR_BGRA2GRAY);
+    } else {
+        small_.copyTo(gray);
+    }
+}
+
+bool MotionGate::should_infer(const cv::Mat& frame) {
+    thumbnail(frame, current_);
+    bool infer = reference_.empty() || reference_.size() != current_.size() || skipped_ >= config_.max_skip;
+    if (!infer) {
+        cv::absdiff(current_, reference_, diff_);
+        const int changed = cv::countNonZero(diff_ > config_.pixel_threshold);
+        last_score_ = static_cast<float>(changed) / static_cast<float>(diff_.total());
+        infer = last_score_ >= config_.changed_fraction;
+    } else {
+        last_score_ = 1.f;
+    }
+    if (infer) {
+        std::swap(reference_, current_);
+        skipped_ = 0;
+    } else {
+        ++skipped_;
+    }
+    return infer;
+}
+
+void MotionGate::reset() {
+    reference_.release();
+    skipped_ = 0;
+    last_score_ = 1.f;
+}
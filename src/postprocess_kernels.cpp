@@ -0,0 +1,110 @@
+#include "postprocess_kernels.h"
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__F16C__)
+#include <immintrin.h>
+#elif defined(__aarch64__) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define YOLOV10_NEON 1
+#endif
+
+namespace {
+
+float half_to_float(uint16_t half) {
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+    uint32_t exponent = (half >> 10) & 0x1fu;
+    uint32_t mantissa = half & 0x3ffu;
+    uint32_t bits;
+    if (exponent == 0x1f) {
+        bits = sign | 0x7f800000u | (mantissa << 13); // Inf / NaN
+    } else if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            // Subnormal half: renormalize into a float exponent
+            exponent = 127 - 15 + 1;
+            while ((mantissa & 0x400u) == 0) {
+                mantissa <<= 1;
+                --exponent;
+            }
+            bits = sign | (exponent << 23) | ((mantissa & 0x3ffu) << 13);
+        }
+    } else {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+size_t select_score_candidates(const float* data, size_t rows, size_t stride, size_t score_column, float threshold,
+                               uint32_t* indices) {
+    const float* scores = data + score_column;
+    size_t count = 0;
+    size_t row = 0;
+#if defined(__AVX2__)
+    const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                               _mm256_set1_epi32(static_cast<int>(stride)));
+    const __m256 vthreshold = _mm256_set1_ps(threshold);
+    for (; row + 8 <= rows; row += 8) {
+        const __m256 v = _mm256_i32gather_ps(scores + row * stride, offsets, sizeof(float));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(v, vthreshold, _CMP_GE_OQ)));
+        while (mask != 0) {
+            indices[count++] = static_cast<uint32_t>(row + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+#elif defined(YOLOV10_NEON)
+    for (; row + 4 <= rows; row += 4) {
+        const float* p = scores + row * stride;
+        const float lanes[4] = {p[0], p[stride], p[2 * stride], p[3 * stride]};
+        const uint32x4_t ge = vcgeq_f32(vld1q_f32(lanes), vdupq_n_f32(threshold));
+        // Most rows fail the threshold; skip the whole group with one horizontal max
+        if (vmaxvq_u32(ge) == 0) {
+            continue;
+        }
+        uint32_t mask[4];
+        vst1q_u32(mask, ge);
+        for (uint32_t lane = 0; lane < 4; ++lane) {
+            if (mask[lane] != 0) {
+                indices[count++] = static_cast<uint32_t>(row + lane);
+            }
+        }
+    }
+#endif
+    for (; row < rows; ++row) {
+        if (scores[row * stride] >= threshold) {
+            indices[count++] = static_cast<uint32_t>(row);
+        }
+    }
+    return count;
+}
+
+void convert_fp16_to_fp32(const uint16_t* src, float* dst, size_t count) {
+    size_t i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= count; i += 8) {
+        const __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(half));
+    }
+#elif defined(YOLOV10_NEON)
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i))));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = half_to_float(src[i]);
+    }
+}
+
+const char* postprocess_simd_backend() {
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(YOLOV10_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
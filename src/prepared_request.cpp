@@ -0,0 +1,112 @@
+#include "prepared_request.h"
+#include <stdexcept>
+#include <sstream>
+
+PreparedRequest::PreparedRequest(const RequestTemplate& request_template, size_t batch_size)
+    : batch_size_{batch_size},
+      output_names_{request_template.output_names},
+      options_{request_template.model_name} {
+    options_.model_version_ = request_template.model_version;
+
+    std::vector<int64_t> input_shape = request_template.input_shape;
+    if (request_template.batching && !input_shape.empty()) {
+        input_shape[0] = static_cast<int64_t>(batch_size);
+    }
+    tc::InferInput* input;
+    tc::Error err = tc::InferInput::Create(&input, request_template.input_name, input_shape, request_template.input_datatype);
+    if (!err.IsOk()) {
+        std::stringstream err_msg;
+        err_msg << "Failed to create inference input. Error details: " << err;
+        throw std::runtime_error(err_msg.str());
+    }
+    input_.reset(input);
+    inputs_.push_back(input_.get());
+
+    for (const auto& output_name : output_names_) {
+        tc::InferRequestedOutput* output;
+        err = tc::InferRequestedOutput::Create(&output, output_name);
+        if (!err.IsOk()) {
+            std::stringstream err_msg;
+            err_msg << "Unable to create output for inference request. Output name: " << output_name << ". Error details: " << err;
+            throw std::runtime_error(err_msg.str());
+        }
+        output_owners_.emplace_back(output);
+        outputs_.push_back(output);
+    }
+}
+
+void PreparedRequest::bind_input(const uint8_t* data, size_t byte_size) {
+    tc::Error err = input_->Reset();
+    if (err.IsOk()) {
+        err = input_->AppendRaw(data, byte_size);
+    }
+    if (!err.IsOk()) {
+        std::stringstream err_msg;
+        err_msg << "Failed to set input data for inference. Error details: " << err;
+        throw std::runtime_error(err_msg.str());
+    }
+}
+
+void PreparedRequest::bind_shared_memory(const std::string& input_region, size_t input_byte_size,
+                                         const std::string& output_region, const std::vector<size_t>& output_offsets,
+                                         const std::vector<size_t>& output_byte_sizes) {
+    tc::Error err = input_->SetSharedMemory(input_region, input_byte_size, 0);
+    if (!err.IsOk()) {
+        std::stringstream err_msg;
+        err_msg << "Failed to bind input to shared memory. Error details: " << err;
+        throw std::runtime_error(err_msg.str());
+    }
+    for (size_t i = 0; i < output_owners_.size(); ++i) {
+        err = output_owners_[i]->SetSharedMemory(output_region, output_byte_sizes[i], output_offsets[i]);
+        if (!err.IsOk()) {
+            std::stringstream err_msg;
+            err_msg << "Failed to bind output " << output_names_[i] << " to shared memory. Error details: " << err;
+            throw std::runtime_error(err_msg.str());
+        }
+    }
+}
+
+PreparedRequestPool::Lease& PreparedRequestPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        if (pool_ && request_) {
+            pool_->release(std::move(request_));
+        }
+        pool_ = other.pool_;
+        request_ = std::move(other.request_);
+        other.pool_ = nullptr;
+    }
+    return *this;
+}
+
+PreparedRequestPool::Lease::~Lease() {
+    if (pool_ && request_) {
+        pool_->release(std::move(request_));
+    }
+}
+
+PreparedRequestPool::PreparedRequestPool(RequestTemplate request_template)
+    : template_{std::move(request_template)} {}
+
+PreparedRequestPool::Lease PreparedRequestPool::acquire(size_t batch_size) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& free_list = free_[batch_size];
+        if (!free_list.empty()) {
+            std::unique_ptr<PreparedRequest> request = std::move(free_list.back());
+            free_list.pop_back();
+            return Lease(this, std::move(request));
+        }
+        ++created_;
+    }
+    return Lease(this, std::make_unique<PreparedRequest>(template_, batch_size));
+}
+
+size_t PreparedRequestPool::created() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return created_;
+}
+
+void PreparedRequestPool::release(std::unique_ptr<PreparedRequest> request) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_[request->batch_size()].push_back(std::move(request));
+}
@@ -0,0 +1,276 @@
+#include "preprocess_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <sstream>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__aarch64__) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define YOLOV10_NEON 1
+#endif
+
+namespace {
+
+void build_axis(int src_len, int dst_len, int stride, std::vector<int32_t>& i0, std::vector<int32_t>& i1,
+                std::vector<float>& weight) {
+    i0.resize(dst_len);
+    i1.resize(dst_len);
+    weight.resize(dst_len);
+    const double scale = static_cast<double>(src_len) / dst_len;
+    for (int d = 0; d < dst_len; ++d) {
+        double pos = (d + 0.5) * scale - 0.5;
+        int s = static_cast<int>(std::floor(pos));
+        float w = static_cast<float>(pos - s);
+        if (s < 0) {
+            s = 0;
+            w = 0.f;
+        }
+        if (s >= src_len - 1) {
+            s = src_len - 1;
+            w = 0.f;
+        }
+        i0[d] = s * stride;
+        i1[d] = std::min(s + 1, src_len - 1) * stride;
+        weight[d] = w;
+    }
+}
+
+// Horizontal interpolation of one BGR source row into three planar RGB float rows.
+void interpolate_row(const uint8_t* src, const ResizeTable& table, float* const rgb[3]) {
+    const int width = table.geometry.content_width;
+    const int32_t* x0 = table.x0.data();
+    const int32_t* x1 = table.x1.data();
+    const float* fx = table.fx.data();
+    float* r = rgb[0];
+    float* g = rgb[1];
+    float* b = rgb[2];
+    for (int x = 0; x < width; ++x) {
+        const uint8_t* p0 = src + x0[x];
+        const uint8_t* p1 = src + x1[x];
+        const float w = fx[x];
+        const float b0 = p0[0], g0 = p0[1], r0 = p0[2];
+        b[x] = b0 + w * (static_cast<float>(p1[0]) - b0);
+        g[x] = g0 + w * (static_cast<float>(p1[1]) - g0);
+        r[x] = r0 + w * (static_cast<float>(p1[2]) - r0);
+    }
+}
+
+inline uint8_t saturate_u8(float v) {
+    return static_cast<uint8_t>(std::clamp(std::nearbyint(v), 0.f, 255.f));
+}
+
+// out[x] = (top[x] + fy * (bottom[x] - top[x])) * scale
+template <typename T>
+void blend_rows(const float* top, const float* bottom, float fy, float scale, T* out, int width) {
+    int x = 0;
+#if defined(__AVX2__)
+    const __m256 vfy = _mm256_set1_ps(fy);
+    const __m256 vscale = _mm256_set1_ps(scale);
+    for (; x + 8 <= width; x += 8) {
+        const __m256 a = _mm256_loadu_ps(top + x);
+        const __m256 b = _mm256_loadu_ps(bottom + x);
+        const __m256 v = _mm256_mul_ps(_mm256_add_ps(a, _mm256_mul_ps(vfy, _mm256_sub_ps(b, a))), vscale);
+        if constexpr (std::is_same_v<T, float>) {
+            _mm256_storeu_ps(out + x, v);
+        } else {
+            const __m256i i32 = _mm256_cvtps_epi32(v);
+            const __m128i i16 = _mm_packus_epi32(_mm256_castsi256_si128(i32), _mm256_extracti128_si256(i32, 1));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(i16, i16));
+        }
+    }
+#elif defined(YOLOV10_NEON)
+    for (; x + 8 <= width; x += 8) {
+        const float32x4_t a0 = vld1q_f32(top + x);
+        const float32x4_t a1 = vld1q_f32(top + x + 4);
+        const float32x4_t v0 = vmulq_n_f32(vmlaq_n_f32(a0, vsubq_f32(vld1q_f32(bottom + x), a0), fy), scale);
+        const float32x4_t v1 = vmulq_n_f32(vmlaq_n_f32(a1, vsubq_f32(vld1q_f32(bottom + x + 4), a1), fy), scale);
+        if constexpr (std::is_same_v<T, float>) {
+            vst1q_f32(out + x, v0);
+            vst1q_f32(out + x + 4, v1);
+        } else {
+            const uint16x8_t u16 = vcombine_u16(vqmovun_s32(vcvtnq_s32_f32(v0)), vqmovun_s32(vcvtnq_s32_f32(v1)));
+            vst1_u8(out + x, vqmovn_u16(u16));
+        }
+    }
+#endif
+    for (; x < width; ++x) {
+        const float v = (top[x] + fy * (bottom[x] - top[x])) * scale;
+        if constexpr (std::is_same_v<T, float>) {
+            out[x] = v;
+        } else {
+            out[x] = saturate_u8(v);
+        }
+    }
+}
+
+template <typename T>
+void interleave_rgb(const float* const rgb[3], T* out, int width) {
+    int x = 0;
+#if defined(YOLOV10_NEON)
+    if constexpr (std::is_same_v<T, float>) {
+        for (; x + 4 <= width; x += 4) {
+            float32x4x3_t v;
+            v.val[0] = vld1q_f32(rgb[0] + x);
+            v.val[1] = vld1q_f32(rgb[1] + x);
+            v.val[2] = vld1q_f32(rgb[2] + x);
+            vst3q_f32(out + 3 * x, v);
+        }
+    }
+#endif
+    for (; x < width; ++x) {
+        for (int c = 0; c < 3; ++c) {
+            if constexpr (std::is_same_v<T, float>) {
+                out[3 * x + c] = rgb[c][x];
+            } else {
+                out[3 * x + c] = saturate_u8(rgb[c][x]);
+            }
+        }
+    }
+}
+
+} // namespace
+
+ResizeGeometry compute_resize_geometry(const cv::Size& src_size, const cv::Size& dst_size, ResizeMode mode) {
+    if (src_size.width <= 0 || src_size.height <= 0 || dst_size.width <= 0 || dst_size.height <= 0) {
+        throw std::runtime_error("Resize geometry requires non-empty source and destination sizes.");
+    }
+    ResizeGeometry geometry;
+    geometry.src_size = src_size;
+    geometry.dst_size = dst_size;
+    if (mode == ResizeMode::Stretch) {
+        geometry.content_width = dst_size.width;
+        geometry.content_height = dst_size.height;
+    } else {
+        const double r = std::min(static_cast<double>(dst_size.width) / src_size.width,
+                                  static_cast<double>(dst_size.height) / src_size.height);
+        geometry.content_width = std::clamp(static_cast<int>(std::lround(src_size.width * r)), 1, dst_size.width);
+        geometry.content_height = std::clamp(static_cast<int>(std::lround(src_size.height * r)), 1, dst_size.height);
+        geometry.pad_x = (dst_size.width - geometry.content_width) / 2;
+        geometry.pad_y = (dst_size.height - geometry.content_height) / 2;
+    }
+    geometry.scale_x = static_cast<float>(geometry.content_width) / src_size.width;
+    geometry.scale_y = static_cast<float>(geometry.content_height) / src_size.height;
+    return geometry;
+}
+
+ResizeTable build_resize_table(const cv::Size& src_size, const cv::Size& dst_size, ResizeMode mode) {
+    ResizeTable table;
+    table.src_size = src_size;
+    table.dst_size = dst_size;
+    table.geometry = compute_resize_geometry(src_size, dst_size, mode);
+    build_axis(src_size.width, table.geometry.content_width, 3, table.x0, table.x1, table.fx);
+    build_axis(src_size.height, table.geometry.content_height, 1, table.y0, table.y1, table.fy);
+    return table;
+}
+
+template <TensorFormat Format, typename T>
+void fused_preprocess(const cv::Mat& bgr, const ResizeTable& table, uint8_t* dst_bytes) {
+    if (bgr.type() != CV_8UC3 || bgr.cols != table.src_size.width || bgr.rows != table.src_size.height) {
+        throw std::runtime_error("Fused preprocess expects a CV_8UC3 image matching the resize table's source size.");
+    }
+    constexpr float scale = std::is_same_v<T, float> ? 1.f / 255.f : 1.f;
+    const T pad = static_cast<T>(kLetterboxPadValue * scale);
+    T* dst = reinterpret_cast<T*>(dst_bytes);
+    const int width = table.dst_size.width;
+    const int height = table.dst_size.height;
+    const size_t plane = static_cast<size_t>(width) * height;
+    const ResizeGeometry& geometry = table.geometry;
+    const int content_width = geometry.content_width;
+    const int right_pad = width - geometry.pad_x - content_width;
+
+    // Two horizontally interpolated source rows plus one blended row per channel; reused across calls.
+    thread_local std::vector<float> scratch;
+    scratch.resize(static_cast<size_t>(content_width) * 9);
+    float* top[3] = {scratch.data(), scratch.data() + content_width, scratch.data() + 2 * content_width};
+    float* bottom[3] = {scratch.data() + 3 * content_width, scratch.data() + 4 * content_width,
+                        scratch.data() + 5 * content_width};
+    float* blended[3] = {scratch.data() + 6 * content_width, scratch.data() + 7 * content_width,
+                         scratch.data() + 8 * content_width};
+
+    int top_row = -1;
+    int bottom_row = -1;
+    for (int y = 0; y < height; ++y) {
+        const int cy = y - geometry.pad_y;
+        if (cy < 0 || cy >= geometry.content_height) {
+            if constexpr (Format == TensorFormat::NCHW) {
+                for (int c = 0; c < 3; ++c) {
+                    std::fill_n(dst + c * plane + static_cast<size_t>(y) * width, width, pad);
+                }
+            } else {
+                std::fill_n(dst + static_cast<size_t>(y) * width * 3, width * 3, pad);
+            }
+            continue;
+        }
+
+        const int y0 = table.y0[cy];
+        const int y1 = table.y1[cy];
+        // Adjacent output rows usually share source rows; only interpolate rows not already cached.
+        if (y0 != top_row) {
+            if (y0 == bottom_row) {
+                std::swap(top, bottom);
+                std::swap(top_row, bottom_row);
+            } else {
+                interpolate_row(bgr.ptr<uint8_t>(y0), table, top);
+                top_row = y0;
+            }
+        }
+        if (y1 != bottom_row) {
+            interpolate_row(bgr.ptr<uint8_t>(y1), table, bottom);
+            bottom_row = y1;
+        }
+
+        const float fy = table.fy[cy];
+        if constexpr (Format == TensorFormat::NCHW) {
+            for (int c = 0; c < 3; ++c) {
+                T* row = dst + c * plane + static_cast<size_t>(y) * width;
+                std::fill_n(row, geometry.pad_x, pad);
+                blend_rows<T>(top[c], bottom[c], fy, scale, row + geometry.pad_x, content_width);
+                std::fill_n(row + geometry.pad_x + content_width, right_pad, pad);
+            }
+        } else {
+            T* row = dst + static_cast<size_t>(y) * width * 3;
+            for (int c = 0; c < 3; ++c) {
+                blend_rows<float>(top[c], bottom[c], fy, scale, blended[c], content_width);
+            }
+            std::fill_n(row, geometry.pad_x * 3, pad);
+            interleave_rgb<T>(blended, row + geometry.pad_x * 3, content_width);
+            std::fill_n(row + (geometry.pad_x + content_width) * 3, right_pad * 3, pad);
+        }
+    }
+}
+
+template void fused_preprocess<TensorFormat::NCHW, float>(const cv::Mat&, const ResizeTable&, uint8_t*);
+template void fused_preprocess<TensorFormat::NHWC, float>(const cv::Mat&, const ResizeTable&, uint8_t*);
+template void fused_preprocess<TensorFormat::NCHW, uint8_t>(const cv::Mat&, const ResizeTable&, uint8_t*);
+template void fused_preprocess<TensorFormat::NHWC, uint8_t>(const cv::Mat&, const ResizeTable&, uint8_t*);
+
+PreprocessKernel select_preprocess_kernel(const std::string& format, const std::string& datatype) {
+    const bool nhwc = format == "FORMAT_NHWC";
+    if (!nhwc && format != "FORMAT_NCHW" && format != "FORMAT_NONE") {
+        std::stringstream err_msg;
+        err_msg << "Unsupported input format for preprocessing: " << format;
+        throw std::runtime_error(err_msg.str());
+    }
+    if (datatype == "FP32") {
+        return nhwc ? &fused_preprocess<TensorFormat::NHWC, float> : &fused_preprocess<TensorFormat::NCHW, float>;
+    }
+    if (datatype == "UINT8") {
+        return nhwc ? &fused_preprocess<TensorFormat::NHWC, uint8_t> : &fused_preprocess<TensorFormat::NCHW, uint8_t>;
+    }
+    std::stringstream err_msg;
+    err_msg << "Unsupported input datatype for preprocessing: " << datatype;
+    throw std::runtime_error(err_msg.str());
+}
+
+const char* preprocess_simd_backend() {
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(YOLOV10_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
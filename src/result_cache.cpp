@@ -0,0 +1,374 @@
+#include "result_cache.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "metrics.h"
+
+namespace {
+
+// Backing file layout, native endianness: a FileHeader, then `capacity` entries of an
+// EntryHeader followed by `max_detections` PackedDetections. last_used == 0 marks a free entry.
+constexpr char kResultCacheMagic[8] = {'Y', 'V', '1', '0', 'R', 'C', '0', '1'};
+
+struct FileHeader {
+    char magic[8];
+    uint64_t context;
+    uint32_t capacity;
+    uint32_t max_detections;
+    uint8_t reserved[40];
+};
+static_assert(sizeof(FileHeader) == 64, "FileHeader layout is part of the file format");
+
+struct EntryHeader {
+    uint64_t key;
+    uint64_t last_used;
+    uint64_t checksum; // Over key, size and detections; rejects entries torn by a crash
+    int32_t width;
+    int32_t height;
+    uint32_t count;
+    uint32_t reserved;
+};
+static_assert(sizeof(EntryHeader) == 40, "EntryHeader layout is part of the file format");
+
+struct PackedDetection {
+    float x1, y1, x2, y2; // Relative to the frame size
+    float score;
+    int32_t class_id;
+};
+static_assert(sizeof(PackedDetection) == 24, "PackedDetection layout is part of the file format");
+
+constexpr uint64_t kPrime1 = 0x9e3779b97f4a7c15ull;
+constexpr uint64_t kPrime2 = 0xc2b2ae3d27d4eb4full;
+
+uint64_t rotl(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+uint64_t finalize(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+// One multiply per 8 bytes; not cryptographic, but 64 bits keep accidental collisions negligible.
+uint64_t hash_bytes(const uint8_t* data, size_t size, uint64_t seed) {
+    uint64_t h = seed ^ (size * kPrime1);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        h = rotl(h ^ (word * kPrime2), 31) * kPrime1;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, data + i, size - i);
+    h = rotl(h ^ (tail * kPrime2), 31) * kPrime1;
+    return finalize(h);
+}
+
+uint64_t entry_checksum(const EntryHeader& header, const PackedDetection* detections) {
+    uint64_t h = hash_bytes(reinterpret_cast<const uint8_t*>(detections), header.count * sizeof(PackedDetection), header.key);
+    const int32_t size[3] = {header.width, header.height, static_cast<int32_t>(header.count)};
+    return hash_bytes(reinterpret_cast<const uint8_t*>(size), sizeof(size), h);
+}
+
+} // namespace
+
+ResultCache::ResultCache(const ResultCacheConfig& config) : config_{config} {
+    config_.capacity = std::max<size_t>(1, config_.capacity);
+    if (config_.capacity >= kNone) {
+        std::stringstream err_msg;
+        err_msg << "Result cache capacity " << config_.capacity << " is too large.";
+        throw std::runtime_error(err_msg.str());
+    }
+    context_hash_ = hash_bytes(reinterpret_cast<const uint8_t*>(config_.context.data()), config_.context.size(), 0);
+    byte_size_ = sizeof(FileHeader) + config_.capacity * entry_size();
+    if (config_.path.empty()) {
+        heap_.assign(byte_size_, 0);
+        base_ = heap_.data();
+    } else {
+        open_file();
+    }
+    stats_.capacity = config_.capacity;
+    prev_.assign(config_.capacity, kNone);
+    next_.assign(config_.capacity, kNone);
+    load_entries();
+    collector_id_ = client_metrics().add_collector([this](std::ostream& out) { render_metrics(out); });
+}
+
+ResultCache::~ResultCache() {
+    client_metrics().remove_collector(collector_id_);
+    if (fd_ != -1) {
+        flush();
+        munmap(base_, byte_size_);
+        close(fd_);
+    }
+}
+
+size_t ResultCache::entry_size() const {
+    return sizeof(EntryHeader) + config_.max_detections * sizeof(PackedDetection);
+}
+
+uint8_t* ResultCache::entry(uint32_t slot) const {
+    return base_ + sizeof(FileHeader) + slot * entry_size();
+}
+
+void ResultCache::open_file() {
+    fd_ = open(config_.path.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP);
+    if (fd_ == -1) {
+        std::stringstream err_msg;
+        err_msg << "Failed to open result cache " << config_.path << ": " << std::strerror(errno);
+        throw std::runtime_error(err_msg.str());
+    }
+    // Each process keeps its own index, LRU and free list over the mapping, so two of them on one
+    // file would overwrite each other's slots. Held until close().
+    if (flock(fd_, LOCK_EX | LOCK_NB) == -1) {
+        std::stringstream err_msg;
+        if (errno == EWOULDBLOCK) {
+            err_msg << "Result cache " << config_.path << " is already in use by another process; give each process its own file.";
+        } else {
+            err_msg << "Failed to lock result cache " << config_.path << ": " << std::strerror(errno);
+        }
+        close(fd_);
+        throw std::runtime_error(err_msg.str());
+    }
+    FileHeader header{};
+    struct stat st {};
+    const bool reusable = fstat(fd_, &st) == 0 && static_cast<size_t>(st.st_size) == byte_size_ &&
+                          pread(fd_, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                          std::memcmp(header.magic, kResultCacheMagic, sizeof(header.magic)) == 0 &&
+                          header.context == context_hash_ && header.capacity == config_.capacity &&
+                          header.max_detections == config_.max_detections;
+    if (!reusable) {
+        // Another model, other settings or another geometry: start empty rather than translate
+        if (ftruncate(fd_, 0) == -1 || ftruncate(fd_, static_cast<off_t>(byte_size_)) == -1) {
+            std::stringstream err_msg;
+            err_msg << "Failed to size result cache " << config_.path << " to " << byte_size_ << " bytes: " << std::strerror(errno);
+            close(fd_);
+            throw std::runtime_error(err_msg.str());
+        }
+    }
+    void* addr = mmap(nullptr, byte_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (addr == MAP_FAILED) {
+        std::stringstream err_msg;
+        err_msg << "Failed to map result cache " << config_.path << ": " << std::strerror(errno);
+        close(fd_);
+        throw std::runtime_error(err_msg.str());
+    }
+    base_ = static_cast<uint8_t*>(addr);
+    if (!reusable) {
+        std::memcpy(header.magic, kResultCacheMagic, sizeof(header.magic));
+        header.context = context_hash_;
+        header.capacity = static_cast<uint32_t>(config_.capacity);
+        header.max_detections = static_cast<uint32_t>(config_.max_detections);
+        std::memcpy(base_, &header, sizeof(header));
+    }
+}
+
+void ResultCache::load_entries() {
+    std::vector<std::pair<uint64_t, uint32_t>> used; // (last_used, slot)
+    for (uint32_t slot = 0; slot < config_.capacity; ++slot) {
+        auto* header = reinterpret_cast<EntryHeader*>(entry(slot));
+        if (header->last_used == 0) {
+            continue;
+        }
+        const auto* detections = reinterpret_cast<const PackedDetection*>(header + 1);
+        if (header->count > config_.max_detections || header->checksum != entry_checksum(*header, detections) ||
+            !index_.emplace(header->key, slot).second) {
+            header->last_used = 0;
+            continue;
+        }
+        used.emplace_back(header->last_used, slot);
+        clock_ = std::max(clock_, header->last_used);
+    }
+    // Least recently used first, so each push_front leaves the newest at the head
+    std::sort(used.begin(), used.end());
+    for (const auto& [last_used, slot] : used) {
+        push_front(slot);
+    }
+    for (uint32_t slot = static_cast<uint32_t>(config_.capacity); slot-- > 0;) {
+        if (reinterpret_cast<const EntryHeader*>(entry(slot))->last_used == 0) {
+            free_slots_.push_back(slot);
+        }
+    }
+    stats_.entries = index_.size();
+}
+
+void ResultCache::unlink_slot(uint32_t slot) {
+    if (prev_[slot] != kNone) {
+        next_[prev_[slot]] = next_[slot];
+    } else {
+        head_ = next_[slot];
+    }
+    if (next_[slot] != kNone) {
+        prev_[next_[slot]] = prev_[slot];
+    } else {
+        tail_ = prev_[slot];
+    }
+    prev_[slot] = next_[slot] = kNone;
+}
+
+void ResultCache::push_front(uint32_t slot) {
+    prev_[slot] = kNone;
+    next_[slot] = head_;
+    if (head_ != kNone) {
+        prev_[head_] = slot;
+    }
+    head_ = slot;
+    if (tail_ == kNone) {
+        tail_ = slot;
+    }
+}
+
+uint64_t ResultCache::exact_key(const uint8_t* data, size_t size) {
+    return hash_bytes(data, size, 0);
+}
+
+uint64_t ResultCache::exact_key(const cv::Mat& image) {
+    const int32_t shape[3] = {image.cols, image.rows, image.type()};
+    uint64_t h = hash_bytes(reinterpret_cast<const uint8_t*>(shape), sizeof(shape), 0);
+    const size_t row_bytes = image.cols * image.elemSize();
+    for (int y = 0; y < image.rows; ++y) {
+        h = hash_bytes(image.ptr<uint8_t>(y), row_bytes, h);
+    }
+    return h;
+}
+
+uint64_t ResultCache::perceptual_key(const cv::Mat& image) {
+    cv::Mat gray;
+    if (image.channels() == 1) {
+        gray = image;
+    } else {
+        cv::cvtColor(image, gray, image.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    }
+    cv::Mat thumbnail;
+    cv::resize(gray, thumbnail, cv::Size(17, 16), 0, 0, cv::INTER_AREA);
+    // One bit per horizontally adjacent pair: brighter than its right neighbour
+    uint64_t bits[4] = {0, 0, 0, 0};
+    for (int y = 0; y < 16; ++y) {
+        const uint8_t* row = thumbnail.ptr<uint8_t>(y);
+        for (int x = 0; x < 16; ++x) {
+            const int bit = y * 16 + x;
+            bits[bit / 64] |= static_cast<uint64_t>(row[x] > row[x + 1]) << (bit % 64);
+        }
+    }
+    // Boxes are stored relative to the frame, so only frames of the same shape may share an entry
+    const int32_t aspect = static_cast<int32_t>(std::lround(1000.0 * image.cols / std::max(1, image.rows)));
+    return hash_bytes(reinterpret_cast<const uint8_t*>(bits), sizeof(bits), static_cast<uint64_t>(aspect));
+}
+
+uint64_t ResultCache::key(const cv::Mat& image) const {
+    return config_.mode == CacheKeyMode::Perceptual ? perceptual_key(image) : exact_key(image);
+}
+
+std::optional<CachedResult> ResultCache::lookup(uint64_t key, const cv::Size& frame_size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        ++stats_.misses;
+        return std::nullopt;
+    }
+    ++stats_.hits;
+    const uint32_t slot = it->second;
+    auto* header = reinterpret_cast<EntryHeader*>(entry(slot));
+    header->last_used = ++clock_;
+    unlink_slot(slot);
+    push_front(slot);
+
+    CachedResult result;
+    result.frame_size = cv::Size(header->width, header->height);
+    const cv::Size target = frame_size.empty() ? result.frame_size : frame_size;
+    const auto* packed = reinterpret_cast<const PackedDetection*>(header + 1);
+    result.detections.reserve(header->count);
+    for (uint32_t i = 0; i < header->count; ++i) {
+        Detection detection;
+        detection.bbox = Box{packed[i].x1 * target.width, packed[i].y1 * target.height, packed[i].x2 * target.width,
+                             packed[i].y2 * target.height};
+        detection.class_id = packed[i].class_id;
+        detection.class_confidence = packed[i].score;
+        result.detections.push_back(detection);
+    }
+    return result;
+}
+
+void ResultCache::insert(uint64_t key, const cv::Size& frame_size, const std::vector<Detection>& detections) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (detections.size() > config_.max_detections || frame_size.empty()) {
+        ++stats_.oversized;
+        return;
+    }
+    uint32_t slot;
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        slot = it->second;
+        unlink_slot(slot);
+    } else if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    } else {
+        slot = tail_;
+        unlink_slot(slot);
+        index_.erase(reinterpret_cast<const EntryHeader*>(entry(slot))->key);
+        ++stats_.evictions;
+    }
+
+    auto* header = reinterpret_cast<EntryHeader*>(entry(slot));
+    // Marked free while it is rewritten; the checksum catches a crash in between
+    header->last_used = 0;
+    header->key = key;
+    header->width = frame_size.width;
+    header->height = frame_size.height;
+    header->count = static_cast<uint32_t>(detections.size());
+    auto* packed = reinterpret_cast<PackedDetection*>(header + 1);
+    const float inv_width = 1.f / frame_size.width;
+    const float inv_height = 1.f / frame_size.height;
+    for (size_t i = 0; i < detections.size(); ++i) {
+        const Detection& detection = detections[i];
+        packed[i] = PackedDetection{detection.bbox.x1 * inv_width, detection.bbox.y1 * inv_height,
+                                    detection.bbox.x2 * inv_width, detection.bbox.y2 * inv_height,
+                                    detection.class_confidence, detection.class_id};
+    }
+    header->checksum = entry_checksum(*header, packed);
+    header->last_used = ++clock_;
+
+    index_[key] = slot;
+    push_front(slot);
+    ++stats_.insertions;
+    stats_.entries = index_.size();
+}
+
+void ResultCache::flush() {
+    if (fd_ != -1) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        msync(base_, byte_size_, MS_SYNC);
+    }
+}
+
+ResultCacheStats ResultCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void ResultCache::render_metrics(std::ostream& out) const {
+    const ResultCacheStats s = stats();
+    out << "# HELP yolov10_result_cache_lookups_total Result cache lookups by outcome.\n";
+    out << "# TYPE yolov10_result_cache_lookups_total counter\n";
+    out << "yolov10_result_cache_lookups_total{outcome=\"hit\"} " << s.hits << "\n";
+    out << "yolov10_result_cache_lookups_total{outcome=\"miss\"} " << s.misses << "\n";
+    out << "# HELP yolov10_result_cache_evictions_total Entries evicted to make room for newer results.\n";
+    out << "# TYPE yolov10_result_cache_evictions_total counter\n";
+    out << "yolov10_result_cache_evictions_total " << s.evictions << "\n";
+    out << "# HELP yolov10_result_cache_entries Results held in the cache.\n";
+    out << "# TYPE yolov10_result_cache_entries gauge\n";
+    out << "yolov10_result_cache_entries " << s.entries << "\n";
+}
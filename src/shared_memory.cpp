@@ -0,0 +1,44 @@
+#include "shared_memory.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+
+SharedMemoryRegion::SharedMemoryRegion(const std::string& key, size_t byte_size)
+    : key_{key}, byte_size_{byte_size} {
+    fd_ = shm_open(key_.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+    if (fd_ == -1) {
+        std::stringstream err_msg;
+        err_msg << "Failed to open shared memory segment " << key_ << ": " << std::strerror(errno);
+        throw std::runtime_error(err_msg.str());
+    }
+    if (ftruncate(fd_, static_cast<off_t>(byte_size_)) == -1) {
+        std::stringstream err_msg;
+        err_msg << "Failed to size shared memory segment " << key_ << " to " << byte_size_ << " bytes: " << std::strerror(errno);
+        close(fd_);
+        shm_unlink(key_.c_str());
+        throw std::runtime_error(err_msg.str());
+    }
+    void* addr = mmap(nullptr, byte_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (addr == MAP_FAILED) {
+        std::stringstream err_msg;
+        err_msg << "Failed to map shared memory segment " << key_ << ": " << std::strerror(errno);
+        close(fd_);
+        shm_unlink(key_.c_str());
+        throw std::runtime_error(err_msg.str());
+    }
+    data_ = static_cast<uint8_t*>(addr);
+}
+
+SharedMemoryRegion::~SharedMemoryRegion() {
+    if (data_) {
+        munmap(data_, byte_size_);
+    }
+    if (fd_ != -1) {
+        close(fd_);
+        shm_unlink(key_.c_str());
+    }
+}
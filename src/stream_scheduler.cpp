@@ -0,0 +1,249 @@
+#include "stream_scheduler.h"
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+// Stream names are user-supplied; quote them as Prometheus label values.
+std::string label_value(const std::string& value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+} // namespace
+
+StreamScheduler::StreamScheduler(TritonClient& triton_client, const SchedulerConfig& config)
+    : triton_client_{triton_client}, config_{config} {
+    config_.max_in_flight = std::max<size_t>(1, config_.max_in_flight);
+    if (triton_client_.max_in_flight() < config_.max_in_flight) {
+        triton_client_.set_max_in_flight(config_.max_in_flight);
+    }
+    collector_id_ = client_metrics().add_collector([this](std::ostream& out) { render_metrics(out); });
+    dispatcher_ = std::thread(&StreamScheduler::dispatch_loop, this);
+}
+
+StreamScheduler::~StreamScheduler() {
+    client_metrics().remove_collector(collector_id_);
+    stop();
+}
+
+size_t StreamScheduler::add_stream(const StreamConfig& config, ResultCallback on_result) {
+    auto stream = std::make_unique<Stream>();
+    stream->config = config;
+    stream->config.weight = std::max<uint32_t>(1, config.weight);
+    stream->config.queue_capacity = std::max<size_t>(1, config.queue_capacity);
+    if (stream->config.name.empty()) {
+        stream->config.name = "stream" + std::to_string(stream_count());
+    }
+    stream->on_result = std::move(on_result);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stream->index = streams_.size();
+    streams_.push_back(std::move(stream));
+    return streams_.size() - 1;
+}
+
+size_t StreamScheduler::stream_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return streams_.size();
+}
+
+bool StreamScheduler::submit(size_t stream_index, uint64_t frame_id, std::vector<uint8_t> input_data,
+                             std::chrono::steady_clock::time_point capture_time) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stream_index >= streams_.size()) {
+        std::stringstream err_msg;
+        err_msg << "Unknown stream " << stream_index << "; " << streams_.size() << " streams are registered.";
+        throw std::runtime_error(err_msg.str());
+    }
+    Stream& stream = *streams_[stream_index];
+    if (stream.config.overflow == StreamOverflow::Block) {
+        space_cv_.wait(lock, [&] { return stop_ || stream.queue.size() < stream.config.queue_capacity; });
+    }
+    if (stop_) {
+        return false;
+    }
+    stream.submitted.fetch_add(1, std::memory_order_relaxed);
+    if (stream.queue.size() >= stream.config.queue_capacity) {
+        stream.queue.pop_front();
+        stream.dropped_overflow.fetch_add(1, std::memory_order_relaxed);
+        YOLOV10_COUNT(MetricCounter::DroppedFrames, 1);
+    }
+    stream.queue.push_back(QueuedFrame{frame_id, std::move(input_data), capture_time});
+    lock.unlock();
+    dispatch_cv_.notify_all();
+    return true;
+}
+
+void StreamScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_) {
+            return;
+        }
+        stop_ = true;
+    }
+    dispatch_cv_.notify_all();
+    space_cv_.notify_all();
+    if (dispatcher_.joinable()) {
+        dispatcher_.join();
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (auto& stream : streams_) {
+        stream->queue.clear();
+    }
+    // Callbacks of outstanding requests still reference the streams
+    dispatch_cv_.wait(lock, [this] { return in_flight_ == 0; });
+}
+
+StreamScheduler::Stream* StreamScheduler::next_stream() {
+    const size_t count = streams_.size();
+    for (size_t visited = 0; visited < count; ++visited) {
+        Stream& stream = *streams_[round_robin_];
+        if (stream.queue.empty()) {
+            // An idle stream does not bank credit for later
+            stream.deficit = 0;
+            round_robin_ = (round_robin_ + 1) % count;
+            continue;
+        }
+        if (stream.deficit == 0) {
+            stream.deficit = stream.config.weight; // Start of this stream's turn
+        }
+        if (--stream.deficit == 0) {
+            round_robin_ = (round_robin_ + 1) % count;
+        }
+        return &stream;
+    }
+    return nullptr;
+}
+
+void StreamScheduler::drop_stale(Stream& stream, std::chrono::steady_clock::time_point now) {
+    while (!stream.queue.empty() && now - stream.queue.front().capture_time > stream.config.latency_budget) {
+        stream.queue.pop_front();
+        stream.dropped_stale.fetch_add(1, std::memory_order_relaxed);
+        YOLOV10_COUNT(MetricCounter::DroppedFrames, 1);
+    }
+}
+
+void StreamScheduler::dispatch_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        dispatch_cv_.wait(lock, [this] {
+            return stop_ || (in_flight_ < config_.max_in_flight &&
+                             std::any_of(streams_.begin(), streams_.end(), [](const auto& s) { return !s->queue.empty(); }));
+        });
+        if (stop_) {
+            return;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        for (auto& stream : streams_) {
+            drop_stale(*stream, now);
+        }
+        space_cv_.notify_all();
+        Stream* stream = next_stream();
+        if (!stream) {
+            continue;
+        }
+        QueuedFrame frame = std::move(stream->queue.front());
+        stream->queue.pop_front();
+        ++in_flight_;
+        lock.unlock();
+
+        const uint64_t frame_id = frame.frame_id;
+        const auto capture_time = frame.capture_time;
+        try {
+            triton_client_.run_inference_async(frame_id, std::move(frame.input_data),
+                                               [this, stream, frame_id, capture_time](InferenceResult&& result) {
+                                                   complete(*stream, frame_id, capture_time, std::move(result));
+                                               });
+        } catch (...) {
+            InferenceResult result;
+            result.frame_id = frame_id;
+            result.error = std::current_exception();
+            complete(*stream, frame_id, capture_time, std::move(result));
+        }
+        lock.lock();
+    }
+}
+
+void StreamScheduler::complete(Stream& stream, uint64_t frame_id, std::chrono::steady_clock::time_point capture_time,
+                               InferenceResult&& result) {
+    const auto latency = std::chrono::steady_clock::now() - capture_time;
+    StreamResult stream_result;
+    stream_result.frame_id = frame_id;
+    stream_result.capture_time = capture_time;
+    stream_result.late = latency > stream.config.latency_budget;
+    if (result.error) {
+        stream.errors.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        stream.completed.fetch_add(1, std::memory_order_relaxed);
+        stream.latency.record(latency);
+        if (stream_result.late) {
+            stream.late.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    stream_result.stream = stream.index;
+    stream_result.result = std::move(result);
+    if (stream.on_result) {
+        stream.on_result(std::move(stream_result));
+    }
+    // Notify under the lock: stop() may tear the scheduler down as soon as it sees no request in flight
+    std::lock_guard<std::mutex> lock(mutex_);
+    --in_flight_;
+    dispatch_cv_.notify_all();
+}
+
+std::vector<StreamStats> StreamScheduler::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<StreamStats> stats;
+    for (const auto& stream : streams_) {
+        StreamStats s;
+        s.name = stream->config.name;
+        s.submitted = stream->submitted.load(std::memory_order_relaxed);
+        s.completed = stream->completed.load(std::memory_order_relaxed);
+        s.dropped_overflow = stream->dropped_overflow.load(std::memory_order_relaxed);
+        s.dropped_stale = stream->dropped_stale.load(std::memory_order_relaxed);
+        s.late = stream->late.load(std::memory_order_relaxed);
+        s.errors = stream->errors.load(std::memory_order_relaxed);
+        s.queued = stream->queue.size();
+        s.p50_latency_ms = stream->latency.quantile_us(0.5) / 1000.0;
+        s.p99_latency_ms = stream->latency.quantile_us(0.99) / 1000.0;
+        stats.push_back(std::move(s));
+    }
+    return stats;
+}
+
+void StreamScheduler::render_metrics(std::ostream& out) const {
+    const std::vector<StreamStats> streams = stats();
+    if (streams.empty()) {
+        return;
+    }
+    out << "# HELP yolov10_stream_frames_total Frames per camera stream by outcome.\n";
+    out << "# TYPE yolov10_stream_frames_total counter\n";
+    for (const StreamStats& s : streams) {
+        const std::string name = label_value(s.name);
+        const std::pair<const char*, uint64_t> outcomes[] = {{"submitted", s.submitted},
+                                                             {"completed", s.completed},
+                                                             {"dropped_overflow", s.dropped_overflow},
+                                                             {"dropped_stale", s.dropped_stale},
+                                                             {"late", s.late},
+                                                             {"error", s.errors}};
+        for (const auto& [outcome, value] : outcomes) {
+            out << "yolov10_stream_frames_total{stream=\"" << name << "\",outcome=\"" << outcome << "\"} " << value << "\n";
+        }
+    }
+    out << "# HELP yolov10_stream_queue_depth Frames waiting in each stream's scheduler queue.\n";
+    out << "# TYPE yolov10_stream_queue_depth gauge\n";
+    for (const StreamStats& s : streams) {
+        out << "yolov10_stream_queue_depth{stream=\"" << label_value(s.name) << "\"} " << s.queued << "\n";
+    }
+}
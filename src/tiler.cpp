@@ -0,0 +1,229 @@
+#include "tiler.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+std::vector<int> tile_origins(int length, int tile, int overlap) {
+    if (length <= tile) {
+        return {0};
+    }
+    const int stride = std::max(1, tile - overlap);
+    const int count = 1 + (length - tile + stride - 1) / stride;
+    std::vector<int> origins(count);
+    for (int i = 0; i < count; ++i) {
+        origins[i] = static_cast<int>(std::lround(static_cast<double>(i) * (length - tile) / (count - 1)));
+    }
+    return origins;
+}
+
+namespace {
+
+float box_area(const Box& box) {
+    return std::max(0.f, box.x2 - box.x1) * std::max(0.f, box.y2 - box.y1);
+}
+
+float box_overlap(const Box& a, const Box& b, TileMatch match) {
+    const float w = std::min(a.x2, b.x2) - std::max(a.x1, b.x1);
+    const float h = std::min(a.y2, b.y2) - std::max(a.y1, b.y1);
+    if (w <= 0.f || h <= 0.f) {
+        return 0.f;
+    }
+    const float intersection = w * h;
+    const float area_a = box_area(a);
+    const float area_b = box_area(b);
+    const float denominator = match == TileMatch::Iou ? area_a + area_b - intersection : std::min(area_a, area_b);
+    return denominator > 0.f ? intersection / denominator : 0.f;
+}
+
+} // namespace
+
+FrameTiler::FrameTiler(YOLOv10& task, const TritonModelInfo& model_info, const TilingConfig& config)
+    : task_{task}, tile_size_{model_info.input_width, model_info.input_height}, config_{config} {
+    if (task_.encoded_input()) {
+        throw std::runtime_error("Tiling needs a tensor input; the model takes encoded images.");
+    }
+    if (config_.overlap < 0 || config_.overlap >= std::min(tile_size_.width, tile_size_.height)) {
+        std::stringstream err_msg;
+        err_msg << "Tile overlap " << config_.overlap << " must be smaller than the " << tile_size_.width << "x"
+                << tile_size_.height << " model input.";
+        throw std::runtime_error(err_msg.str());
+    }
+    const size_t model_batch = model_info.max_batch_size > 0 ? static_cast<size_t>(model_info.max_batch_size) : 1;
+    tiles_per_request_ = config_.max_batch_size > 0 ? std::min(config_.max_batch_size, model_batch) : model_batch;
+}
+
+TileGrid FrameTiler::build_grid(const cv::Size& frame_size) const {
+    TileGrid grid;
+    grid.frame_size = frame_size;
+    const std::vector<int> xs = tile_origins(frame_size.width, tile_size_.width, config_.overlap);
+    const std::vector<int> ys = tile_origins(frame_size.height, tile_size_.height, config_.overlap);
+    for (int y : ys) {
+        for (int x : xs) {
+            grid.regions.emplace_back(x, y, std::min(tile_size_.width, frame_size.width),
+                                      std::min(tile_size_.height, frame_size.height));
+        }
+    }
+    // A frame that fits in one tile is already seen whole
+    if (config_.full_frame && grid.regions.size() > 1) {
+        grid.regions.emplace_back(0, 0, frame_size.width, frame_size.height);
+    }
+    return grid;
+}
+
+std::shared_ptr<const TileGrid> FrameTiler::grid(const cv::Size& frame_size) {
+    constexpr size_t max_cached_grids = 16;
+    const uint64_t key = (static_cast<uint64_t>(frame_size.width) << 32) | static_cast<uint32_t>(frame_size.height);
+    std::lock_guard<std::mutex> lock(grids_mutex_);
+    auto it = grids_.find(key);
+    if (it == grids_.end()) {
+        if (grids_.size() >= max_cached_grids) {
+            grids_.clear();
+        }
+        it = grids_.emplace(key, std::make_shared<const TileGrid>(build_grid(frame_size))).first;
+    }
+    return it->second;
+}
+
+size_t FrameTiler::request_batch_size(const TileGrid& grid, size_t request) const {
+    const size_t first = request * tiles_per_request_;
+    return first < grid.size() ? std::min(tiles_per_request_, grid.size() - first) : 0;
+}
+
+void FrameTiler::preprocess(const cv::Mat& frame, const TileGrid& grid, std::vector<uint8_t>& input_data) {
+    const size_t entry_size = task_.input_byte_size();
+    input_data.resize(entry_size * grid.size());
+    for (size_t i = 0; i < grid.size(); ++i) {
+        // ROIs share the frame's pixels; the preprocessing kernels read them row by row
+        task_.preprocess(frame(grid.regions[i]), input_data.data() + i * entry_size);
+    }
+}
+
+std::vector<Detection> FrameTiler::postprocess(const TileGrid& grid, const std::vector<std::shared_ptr<InferenceOutput>>& outputs) {
+    if (outputs.size() != request_count(grid)) {
+        std::stringstream err_msg;
+        err_msg << "Expected " << request_count(grid) << " tile responses, got " << outputs.size() << ".";
+        throw std::runtime_error(err_msg.str());
+    }
+    std::vector<Detection> detections;
+    std::vector<uint32_t> regions;
+    for (size_t i = 0; i < grid.size(); ++i) {
+        const cv::Rect& region = grid.regions[i];
+        const InferenceOutput& output = *outputs[i / tiles_per_request_];
+        for (Detection detection : task_.postprocess(region.size(), output, i % tiles_per_request_)) {
+            detection.bbox.x1 += region.x;
+            detection.bbox.x2 += region.x;
+            detection.bbox.y1 += region.y;
+            detection.bbox.y2 += region.y;
+            detections.push_back(detection);
+            regions.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    detections = merge_detections(std::move(detections), regions, config_.merge, config_.match, config_.match_threshold);
+    // Top-K was applied per region; apply it again to the merged frame
+    const size_t max_detections = task_.postprocess_config().max_detections;
+    if (max_detections > 0 && detections.size() > max_detections) {
+        detections.resize(max_detections);
+    }
+    return detections;
+}
+
+std::vector<std::vector<uint8_t>> FrameTiler::split_requests(const TileGrid& grid, std::vector<uint8_t>&& input_data) const {
+    const size_t requests = request_count(grid);
+    std::vector<std::vector<uint8_t>> request_inputs(requests);
+    if (requests == 1) {
+        request_inputs[0] = std::move(input_data);
+        return request_inputs;
+    }
+    const size_t entry_size = task_.input_byte_size();
+    for (size_t k = 0; k < requests; ++k) {
+        const uint8_t* first = input_data.data() + k * tiles_per_request_ * entry_size;
+        request_inputs[k].assign(first, first + request_batch_size(grid, k) * entry_size);
+    }
+    return request_inputs;
+}
+
+std::vector<Detection> FrameTiler::infer(TritonClient& triton_client, const cv::Mat& frame) {
+    const std::shared_ptr<const TileGrid> tiles = grid(frame.size());
+    std::vector<uint8_t> input_data;
+    preprocess(frame, *tiles, input_data);
+    const std::vector<std::vector<uint8_t>> request_inputs = split_requests(*tiles, std::move(input_data));
+    std::vector<std::shared_ptr<InferenceOutput>> outputs(request_inputs.size());
+    for (size_t k = 0; k < request_inputs.size(); ++k) {
+        outputs[k] = std::make_shared<InferenceOutput>();
+        triton_client.run_inference(request_inputs[k], *outputs[k], request_batch_size(*tiles, k));
+        if (triton_client.shared_memory_enabled()) {
+            // The next request reuses the shared output region
+            outputs[k]->detach();
+        }
+    }
+    return postprocess(*tiles, outputs);
+}
+
+std::vector<Detection> merge_detections(std::vector<Detection> detections, const std::vector<uint32_t>& regions,
+                                        TileMerge merge, TileMatch match, float threshold) {
+    if (regions.size() != detections.size()) {
+        throw std::runtime_error("merge_detections needs the source region of every detection.");
+    }
+    std::vector<size_t> order(detections.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return detections[a].class_confidence > detections[b].class_confidence;
+    });
+
+    struct Group {
+        Detection best;
+        Box fused;
+        std::vector<uint32_t> regions; // Regions already represented in the group
+        float weight{0.f};
+        Box weighted{0.f, 0.f, 0.f, 0.f};
+    };
+    std::vector<Group> groups;
+    for (size_t index : order) {
+        const Detection& detection = detections[index];
+        const uint32_t region = regions[index];
+        Group* target = nullptr;
+        for (Group& group : groups) {
+            // The model's output is NMS-free: two boxes from the same region are two objects, even
+            // when one lies inside the other. Only copies seen by different regions are merged.
+            if (group.best.class_id == detection.class_id &&
+                std::find(group.regions.begin(), group.regions.end(), region) == group.regions.end() &&
+                box_overlap(group.fused, detection.bbox, match) > threshold) {
+                target = &group;
+                break;
+            }
+        }
+        if (!target) {
+            groups.push_back(Group{detection, detection.bbox, {region}});
+            target = &groups.back();
+        } else {
+            target->regions.push_back(region);
+            if (merge == TileMerge::Nms) {
+                continue;
+            }
+        }
+        if (merge == TileMerge::WeightedFusion) {
+            const float w = detection.class_confidence;
+            target->weight += w;
+            target->weighted.x1 += w * detection.bbox.x1;
+            target->weighted.y1 += w * detection.bbox.y1;
+            target->weighted.x2 += w * detection.bbox.x2;
+            target->weighted.y2 += w * detection.bbox.y2;
+            if (target->weight > 0.f) {
+                const float inv = 1.f / target->weight;
+                target->fused = Box{target->weighted.x1 * inv, target->weighted.y1 * inv, target->weighted.x2 * inv,
+                                    target->weighted.y2 * inv};
+            }
+        }
+    }
+
+    std::vector<Detection> merged;
+    merged.reserve(groups.size());
+    for (const Group& group : groups) {
+        Detection detection = group.best;
+        detection.bbox = group.fused;
+        merged.push_back(detection);
+    }
+    return merged;
+}
@@ -0,0 +1,353 @@
+#include "trace.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint64_t kTraceGrowth = 64ull << 20;
+
+uint64_t pad8(uint64_t size) {
+    return (size + 7) & ~uint64_t{7};
+}
+
+template <typename T>
+void put(uint8_t*& out, const T& value) {
+    std::memcpy(out, &value, sizeof(value));
+    out += sizeof(value);
+}
+
+void put_bytes(uint8_t*& out, const void* data, size_t size) {
+    if (size > 0) {
+        std::memcpy(out, data, size);
+    }
+    std::memset(out + size, 0, pad8(size) - size);
+    out += pad8(size);
+}
+
+// Bounds-checked cursor over a record payload.
+class PayloadReader {
+public:
+    PayloadReader(const TraceRecord& record) : data_{record.payload}, size_{record.payload_size} {}
+
+    template <typename T>
+    T get() {
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+    const uint8_t* take(uint64_t size) {
+        if (size > size_ - offset_) {
+            throw std::runtime_error("Truncated trace record.");
+        }
+        const uint8_t* at = data_ + offset_;
+        offset_ += size;
+        return at;
+    }
+    const uint8_t* take_padded(uint64_t size) {
+        const uint8_t* at = take(size);
+        take(pad8(size) - size);
+        return at;
+    }
+
+private:
+    const uint8_t* data_;
+    uint64_t size_;
+    uint64_t offset_{0};
+};
+
+} // namespace
+
+std::string trace_request_id(uint64_t frame_id, uint32_t request_index, uint64_t sequence) {
+    return std::to_string(frame_id) + ':' + std::to_string(request_index) + ':' + std::to_string(sequence);
+}
+
+bool parse_trace_request_id(const std::string& id, uint64_t& frame_id, uint32_t& request_index) {
+    const size_t first = id.find(':');
+    const size_t second = first == std::string::npos ? std::string::npos : id.find(':', first + 1);
+    if (second == std::string::npos || first == 0 || second == first + 1) {
+        return false;
+    }
+    const auto all_digits = [&](size_t begin, size_t end) {
+        return std::all_of(id.begin() + begin, id.begin() + end, [](char c) { return c >= '0' && c <= '9'; });
+    };
+    if (!all_digits(0, first) || !all_digits(first + 1, second)) {
+        return false;
+    }
+    try {
+        const uint64_t index = std::stoull(id.substr(first + 1, second - first - 1));
+        if (index > UINT32_MAX) {
+            return false;
+        }
+        frame_id = std::stoull(id.substr(0, first));
+        request_index = static_cast<uint32_t>(index);
+    } catch (const std::out_of_range&) {
+        return false;
+    }
+    return true;
+}
+
+TraceWriter::TraceWriter(const std::string& path) : path_{path}, start_{std::chrono::steady_clock::now()} {
+    fd_ = open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP);
+    if (fd_ == -1) {
+        std::stringstream err_msg;
+        err_msg << "Failed to create trace " << path_ << ": " << std::strerror(errno);
+        throw std::runtime_error(err_msg.str());
+    }
+    reserve(sizeof(TraceFileHeader));
+    TraceFileHeader header{};
+    std::memcpy(header.magic, kTraceMagic, sizeof(header.magic));
+    header.committed_size = sizeof(TraceFileHeader);
+    header.start_unix_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    std::memcpy(base_, &header, sizeof(header));
+    write_offset_ = sizeof(TraceFileHeader);
+}
+
+TraceWriter::~TraceWriter() {
+    if (base_) {
+        munmap(base_, mapped_size_);
+    }
+    if (fd_ != -1) {
+        // Drop the unused tail of the last growth step
+        if (ftruncate(fd_, static_cast<off_t>(write_offset_)) == -1) {
+            std::cerr << "Failed to trim trace " << path_ << ": " << std::strerror(errno) << std::endl;
+        }
+        close(fd_);
+    }
+}
+
+int64_t TraceWriter::now_ns() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count();
+}
+
+uint64_t TraceWriter::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return write_offset_;
+}
+
+void TraceWriter::reserve(uint64_t size) {
+    if (size <= mapped_size_) {
+        return;
+    }
+    const uint64_t new_size = std::max(size, mapped_size_ + std::max(mapped_size_, kTraceGrowth));
+    if (ftruncate(fd_, static_cast<off_t>(new_size)) == -1) {
+        std::stringstream err_msg;
+        err_msg << "Failed to grow trace " << path_ << " to " << new_size << " bytes: " << std::strerror(errno);
+        throw std::runtime_error(err_msg.str());
+    }
+    if (base_) {
+        munmap(base_, mapped_size_);
+        base_ = nullptr;
+    }
+    void* addr = mmap(nullptr, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (addr == MAP_FAILED) {
+        std::stringstream err_msg;
+        err_msg << "Failed to map trace " << path_ << ": " << std::strerror(errno);
+        throw std::runtime_error(err_msg.str());
+    }
+    base_ = static_cast<uint8_t*>(addr);
+    mapped_size_ = new_size;
+}
+
+uint8_t* TraceWriter::begin_record(TraceRecordType type, uint32_t index, uint64_t frame_id, int64_t time_ns,
+                                   uint64_t payload_size) {
+    pending_end_ = write_offset_ + sizeof(TraceRecordHeader) + pad8(payload_size);
+    reserve(pending_end_);
+    const TraceRecordHeader header{static_cast<uint32_t>(type), index, frame_id, time_ns, payload_size};
+    std::memcpy(base_ + write_offset_, &header, sizeof(header));
+    return base_ + write_offset_ + sizeof(header);
+}
+
+void TraceWriter::commit_record() {
+    write_offset_ = pending_end_;
+    // Readers trust only what committed_size covers
+    reinterpret_cast<TraceFileHeader*>(base_)->committed_size = write_offset_;
+}
+
+void TraceWriter::append_meta(const std::map<std::string, std::string>& values) {
+    std::string text;
+    for (const auto& [key, value] : values) {
+        text += key + "=" + value + "\n";
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint8_t* out = begin_record(TraceRecordType::Meta, 0, 0, now_ns(), text.size());
+    put_bytes(out, text.data(), text.size());
+    commit_record();
+}
+
+void TraceWriter::append_frame(uint64_t frame_id, int64_t time_ns, int width, int height, int type, size_t elem_size,
+                               const uint8_t* data, size_t step) {
+    const size_t row_bytes = static_cast<size_t>(width) * elem_size;
+    const uint64_t payload_size = 4 * sizeof(int32_t) + row_bytes * height;
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint8_t* out = begin_record(TraceRecordType::Frame, 0, frame_id, time_ns, payload_size);
+    put(out, static_cast<int32_t>(width));
+    put(out, static_cast<int32_t>(height));
+    put(out, static_cast<int32_t>(type));
+    put(out, static_cast<int32_t>(elem_size));
+    for (int y = 0; y < height; ++y) {
+        std::memcpy(out, data + y * step, row_bytes);
+        out += row_bytes;
+    }
+    std::memset(out, 0, pad8(payload_size) - payload_size);
+    commit_record();
+}
+
+void TraceWriter::append_input(uint64_t frame_id, int64_t time_ns, const uint8_t* data, size_t size, uint32_t batch_size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint8_t* out = begin_record(TraceRecordType::Input, batch_size, frame_id, time_ns, size);
+    put_bytes(out, data, size);
+    commit_record();
+}
+
+void TraceWriter::append_output(uint64_t frame_id, int64_t time_ns, uint32_t request_index, int64_t latency_ns,
+                                const std::vector<TraceTensor>& tensors) {
+    uint64_t payload_size = 16;
+    for (const TraceTensor& tensor : tensors) {
+        payload_size += 16 + 8 * tensor.shape.size() + 8 + pad8(tensor.name.size()) + pad8(tensor.datatype.size()) +
+                        pad8(tensor.byte_size);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint8_t* out = begin_record(TraceRecordType::Output, request_index, frame_id, time_ns, payload_size);
+    put(out, static_cast<uint64_t>(latency_ns));
+    put(out, static_cast<uint32_t>(tensors.size()));
+    put(out, uint32_t{0});
+    for (const TraceTensor& tensor : tensors) {
+        put(out, static_cast<uint32_t>(tensor.name.size()));
+        put(out, static_cast<uint32_t>(tensor.datatype.size()));
+        put(out, static_cast<uint32_t>(tensor.shape.size()));
+        put(out, uint32_t{0});
+        for (int64_t dim : tensor.shape) {
+            put(out, dim);
+        }
+        put(out, static_cast<uint64_t>(tensor.byte_size));
+        put_bytes(out, tensor.name.data(), tensor.name.size());
+        put_bytes(out, tensor.datatype.data(), tensor.datatype.size());
+        put_bytes(out, tensor.data, tensor.byte_size);
+    }
+    commit_record();
+}
+
+TraceReader::TraceReader(const std::string& path) : path_{path} {
+    const int fd = open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st {};
+    if (fd == -1 || fstat(fd, &st) == -1) {
+        std::stringstream err_msg;
+        err_msg << "Failed to open trace " << path_ << ": " << std::strerror(errno);
+        if (fd != -1) {
+            close(fd);
+        }
+        throw std::runtime_error(err_msg.str());
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ < sizeof(TraceFileHeader)) {
+        close(fd);
+        throw std::runtime_error("Not a trace file: " + path_);
+    }
+    void* addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        std::stringstream err_msg;
+        err_msg << "Failed to map trace " << path_ << ": " << std::strerror(errno);
+        throw std::runtime_error(err_msg.str());
+    }
+    base_ = static_cast<uint8_t*>(addr);
+
+    TraceFileHeader header;
+    std::memcpy(&header, base_, sizeof(header));
+    if (std::memcmp(header.magic, kTraceMagic, sizeof(header.magic)) != 0) {
+        munmap(base_, size_);
+        throw std::runtime_error("Not a trace file: " + path_);
+    }
+    // A writer that did not shut down cleanly leaves zeroed space after the last record
+    const uint64_t end = std::min<uint64_t>(header.committed_size, size_);
+    uint64_t offset = sizeof(TraceFileHeader);
+    while (offset + sizeof(TraceRecordHeader) <= end) {
+        TraceRecordHeader record_header;
+        std::memcpy(&record_header, base_ + offset, sizeof(record_header));
+        const uint64_t payload_offset = offset + sizeof(TraceRecordHeader);
+        if (record_header.payload_size > end - payload_offset) {
+            break;
+        }
+        records_.push_back(TraceRecord{static_cast<TraceRecordType>(record_header.type), record_header.index,
+                                       record_header.frame_id, record_header.time_ns, base_ + payload_offset,
+                                       record_header.payload_size});
+        offset = payload_offset + pad8(record_header.payload_size);
+    }
+
+    for (const TraceRecord* record : records(TraceRecordType::Meta)) {
+        std::stringstream text(std::string(reinterpret_cast<const char*>(record->payload), record->payload_size));
+        std::string line;
+        while (std::getline(text, line)) {
+            const size_t equals = line.find('=');
+            if (equals != std::string::npos) {
+                meta_[line.substr(0, equals)] = line.substr(equals + 1);
+            }
+        }
+    }
+}
+
+TraceReader::~TraceReader() {
+    munmap(base_, size_);
+}
+
+std::vector<const TraceRecord*> TraceReader::records(TraceRecordType type) const {
+    std::vector<const TraceRecord*> selected;
+    for (const TraceRecord& record : records_) {
+        if (record.type == type) {
+            selected.push_back(&record);
+        }
+    }
+    return selected;
+}
+
+std::string TraceReader::meta(const std::string& key, const std::string& fallback) const {
+    auto it = meta_.find(key);
+    return it == meta_.end() ? fallback : it->second;
+}
+
+TraceFrame TraceReader::frame(const TraceRecord& record) {
+    PayloadReader in(record);
+    TraceFrame frame;
+    frame.width = in.get<int32_t>();
+    frame.height = in.get<int32_t>();
+    frame.type = in.get<int32_t>();
+    frame.elem_size = static_cast<size_t>(in.get<int32_t>());
+    if (frame.width <= 0 || frame.height <= 0 || frame.elem_size == 0) {
+        throw std::runtime_error("Malformed trace frame.");
+    }
+    frame.data = in.take(static_cast<uint64_t>(frame.width) * frame.height * frame.elem_size);
+    return frame;
+}
+
+TraceOutput TraceReader::output(const TraceRecord& record) {
+    PayloadReader in(record);
+    TraceOutput output;
+    output.latency_ns = static_cast<int64_t>(in.get<uint64_t>());
+    const uint32_t count = in.get<uint32_t>();
+    in.get<uint32_t>();
+    for (uint32_t i = 0; i < count; ++i) {
+        TraceTensor tensor;
+        const uint32_t name_length = in.get<uint32_t>();
+        const uint32_t datatype_length = in.get<uint32_t>();
+        const uint32_t rank = in.get<uint32_t>();
+        in.get<uint32_t>();
+        for (uint32_t d = 0; d < rank; ++d) {
+            tensor.shape.push_back(in.get<int64_t>());
+        }
+        tensor.byte_size = static_cast<size_t>(in.get<uint64_t>());
+        tensor.name.assign(reinterpret_cast<const char*>(in.take_padded(name_length)), name_length);
+        tensor.datatype.assign(reinterpret_cast<const char*>(in.take_padded(datatype_length)), datatype_length);
+        tensor.data = in.take_padded(tensor.byte_size);
+        output.tensors.push_back(std::move(tensor));
+    }
+    return output;
+}
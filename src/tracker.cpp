@@ -0,0 +1,155 @@
+#include "tracker.h"
+#include <algorithm>
+
+namespace {
+
+float iou(const Box& a, const Box& b) {
+    const float w = std::min(a.x2, b.x2) - std::max(a.x1, b.x1);
+    const float h = std::min(a.y2, b.y2) - std::max(a.y1, b.y1);
+    if (w <= 0.f || h <= 0.f) {
+        return 0.f;
+    }
+    const float intersection = w * h;
+    const float area_a = (a.x2 - a.x1) * (a.y2 - a.y1);
+    const float area_b = (b.x2 - b.x1) * (b.y2 - b.y1);
+    return intersection / (area_a + area_b - intersection);
+}
+
+void box_to_measurement(const Box& box, float (&z)[4]) {
+    z[0] = 0.5f * (box.x1 + box.x2);
+    z[1] = 0.5f * (box.y1 + box.y2);
+    z[2] = box.x2 - box.x1;
+    z[3] = box.y2 - box.y1;
+}
+
+} // namespace
+
+void IouTracker::Axis::init(float measurement, float measurement_variance) {
+    position = measurement;
+    velocity = 0.f;
+    p00 = measurement_variance;
+    p01 = 0.f;
+    // Unknown velocity: start with a wide prior so the first matches set it quickly
+    p11 = 10.f * measurement_variance;
+}
+
+void IouTracker::Axis::predict(float dt, float process_variance) {
+    position += velocity * dt;
+    // P = F P F^T + Q, with white-noise acceleration Q
+    const float dt2 = dt * dt;
+    p00 += dt * (2.f * p01 + dt * p11) + process_variance * dt2 * dt2 / 4.f;
+    p01 += dt * p11 + process_variance * dt2 * dt / 2.f;
+    p11 += process_variance * dt2;
+}
+
+void IouTracker::Axis::correct(float measurement, float measurement_variance) {
+    const float innovation = measurement - position;
+    const float s = p00 + measurement_variance;
+    const float k0 = p00 / s;
+    const float k1 = p01 / s;
+    position += k0 * innovation;
+    velocity += k1 * innovation;
+    p11 -= k1 * p01;
+    p01 -= k0 * p01;
+    p00 -= k0 * p00;
+}
+
+Box IouTracker::Track::box_at(uint64_t target_frame) const {
+    const float dt = target_frame > frame_id ? static_cast<float>(target_frame - frame_id) : 0.f;
+    const float cx = axes[0].at(dt);
+    const float cy = axes[1].at(dt);
+    const float w = std::max(axes[2].at(dt), 1.f);
+    const float h = std::max(axes[3].at(dt), 1.f);
+    return Box{cx - 0.5f * w, cy - 0.5f * h, cx + 0.5f * w, cy + 0.5f * h};
+}
+
+void IouTracker::update(std::vector<Detection>& detections, uint64_t frame_id) {
+    const float process_variance = config_.process_noise * config_.process_noise;
+    const float measurement_variance = config_.measurement_noise * config_.measurement_noise;
+
+    predicted_.clear();
+    for (const Track& track : tracks_) {
+        predicted_.push_back(track.box_at(frame_id));
+    }
+    // Greedy matching, best IoU first; the detections per frame are few enough that this beats Hungarian
+    candidates_.clear();
+    for (size_t t = 0; t < tracks_.size(); ++t) {
+        for (size_t d = 0; d < detections.size(); ++d) {
+            if (tracks_[t].class_id != detections[d].class_id) {
+                continue;
+            }
+            const float overlap = iou(predicted_[t], detections[d].bbox);
+            if (overlap >= config_.iou_threshold) {
+                candidates_.push_back({overlap, {t, d}});
+            }
+        }
+    }
+    std::sort(candidates_.begin(), candidates_.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    track_matched_.assign(tracks_.size(), false);
+    detection_matched_.assign(detections.size(), false);
+
+    float z[4];
+    for (const auto& [overlap, match] : candidates_) {
+        const auto [t, d] = match;
+        if (track_matched_[t] || detection_matched_[d]) {
+            continue;
+        }
+        track_matched_[t] = true;
+        detection_matched_[d] = true;
+        Track& track = tracks_[t];
+        const float dt = static_cast<float>(frame_id - track.frame_id);
+        box_to_measurement(detections[d].bbox, z);
+        for (int i = 0; i < 4; ++i) {
+            track.axes[i].predict(dt, process_variance);
+            track.axes[i].correct(z[i], measurement_variance);
+        }
+        track.frame_id = frame_id;
+        track.misses = 0;
+        track.confidence = detections[d].class_confidence;
+        detections[d].track_id = track.id;
+    }
+
+    // Unmatched tracks age out; unmatched detections start new tracks
+    size_t kept = 0;
+    for (size_t t = 0; t < tracks_.size(); ++t) {
+        if (!track_matched_[t] && ++tracks_[t].misses > config_.max_misses) {
+            continue;
+        }
+        if (kept != t) {
+            tracks_[kept] = tracks_[t];
+        }
+        ++kept;
+    }
+    tracks_.resize(kept);
+    for (size_t d = 0; d < detections.size(); ++d) {
+        if (detection_matched_[d]) {
+            continue;
+        }
+        Track track;
+        track.id = next_id_++;
+        track.class_id = detections[d].class_id;
+        track.confidence = detections[d].class_confidence;
+        track.frame_id = frame_id;
+        box_to_measurement(detections[d].bbox, z);
+        for (int i = 0; i < 4; ++i) {
+            track.axes[i].init(z[i], measurement_variance);
+        }
+        detections[d].track_id = track.id;
+        tracks_.push_back(track);
+    }
+}
+
+std::vector<Detection> IouTracker::predict(uint64_t frame_id) const {
+    std::vector<Detection> detections;
+    for (const Track& track : tracks_) {
+        if (track.misses == 0) {
+            detections.push_back(Detection{track.box_at(frame_id), track.class_id, track.confidence, track.id});
+        }
+    }
+    return detections;
+}
+
+void IouTracker::reset() {
+    tracks_.clear();
+    next_id_ = 0;
+}
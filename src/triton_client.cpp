@@ -1,100 +1,339 @@
 #include "triton_client.h"
+#include "metrics.h"
+#include "model_info_cache.h"
+#include "trace.h"
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 #include <stdexcept>
 #include <sstream>
+#include <numeric>
+#include <unistd.h>
 
-static size_t write_callback(char* ptr, size_t size, size_t nmemb, std::string& data) {
-    size_t total_size = size * nmemb;
-    data.append(ptr, total_size);
-    return total_size;
+size_t datatype_byte_size(const std::string& datatype) {
+    if (datatype == "FP32" || datatype == "INT32" || datatype == "UINT32") {
+        return 4;
+    }
+    if (datatype == "FP16" || datatype == "BF16" || datatype == "INT16" || datatype == "UINT16") {
+        return 2;
+    }
+    if (datatype == "UINT8" || datatype == "INT8" || datatype == "BOOL") {
+        return 1;
+    }
+    if (datatype == "FP64" || datatype == "INT64" || datatype == "UINT64") {
+        return 8;
+    }
+    std::stringstream err_msg;
+    err_msg << "Unsupported tensor datatype: " << datatype;
+    throw std::runtime_error(err_msg.str());
 }
 
-TritonModelInfo TritonClient::parse_model(const std::string& model_name, const std::string& url) {
-    TritonModelInfo info;
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        throw std::runtime_error("Failed to initialize libcurl. Ensure that libcurl is installed and properly configured.");
-    }
-    const auto model_config_url = "http://" + url + ":8000/v2/models/" + model_name + "/config";
-    curl_easy_setopt(curl, CURLOPT_URL, model_config_url.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    std::string response_data;
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);
-    CURLcode res = curl_easy_perform(curl);
-    if (res != CURLE_OK) {
-        curl_easy_cleanup(curl);
-        std::stringstream err_msg;
-        err_msg << "HTTP request to retrieve model configuration failed. CURL error: " << curl_easy_strerror(res);
-        throw std::runtime_error(err_msg.str());
+void append_bytes_element(std::vector<uint8_t>& tensor, const uint8_t* data, size_t size) {
+    const uint32_t length = static_cast<uint32_t>(size);
+    const uint8_t prefix[4] = {static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8),
+                               static_cast<uint8_t>(length >> 16), static_cast<uint8_t>(length >> 24)};
+    tensor.insert(tensor.end(), prefix, prefix + 4);
+    tensor.insert(tensor.end(), data, data + size);
+}
+
+static int64_t element_count(const std::vector<int64_t>& shape) {
+    return std::accumulate(shape.begin(), shape.end(), int64_t{1}, std::multiplies<int64_t>());
+}
+
+namespace {
+
+// Protocol-neutral subset of a model configuration, filled from the HTTP JSON or the gRPC message.
+struct ModelConfigFields {
+    struct Tensor {
+        std::string name;
+        std::string datatype; // "TYPE_FP32", ...
+        std::string format;   // Inputs only
+        std::vector<int64_t> dims;
+    };
+    int max_batch_size{0};
+    std::vector<Tensor> inputs;
+    std::vector<Tensor> outputs;
+    std::map<std::string, std::string> parameters; // string_value of each model parameter
+};
+
+[[noreturn]] void throw_invalid_config(const std::string& model_name, const std::string& detail) {
+    std::stringstream err_msg;
+    err_msg << "Invalid configuration for model '" << model_name << "': " << detail;
+    throw std::runtime_error(err_msg.str());
+}
+
+const rapidjson::Value& json_member(const rapidjson::Value& object, const char* name, const std::string& model_name) {
+    if (!object.IsObject() || !object.HasMember(name)) {
+        throw_invalid_config(model_name, std::string("missing \"") + name + "\"");
     }
-    
-    // Unknown model
-    if (response_data.find("Request for unknown model") != std::string::npos) {
-        curl_easy_cleanup(curl);
-        std::stringstream err_msg;
-        err_msg << "Model '" << model_name << "' not found on Triton server. Please check the model name and try again.";
-        throw std::runtime_error(err_msg.str());
+    return object[name];
+}
+
+ModelConfigFields::Tensor tensor_from_json(const rapidjson::Value& tensor_json, bool input, const std::string& model_name) {
+    ModelConfigFields::Tensor tensor;
+    const rapidjson::Value& name = json_member(tensor_json, "name", model_name);
+    const rapidjson::Value& datatype = json_member(tensor_json, "data_type", model_name);
+    const rapidjson::Value& dims = json_member(tensor_json, "dims", model_name);
+    if (!name.IsString() || !datatype.IsString() || !dims.IsArray()) {
+        throw_invalid_config(model_name, "tensor name, data_type or dims has the wrong type");
     }
+    tensor.name = name.GetString();
+    tensor.datatype = datatype.GetString();
+    for (const auto& dim : dims.GetArray()) {
+        // Older servers print int64 dims as strings
+        if (dim.IsInt64()) {
+            tensor.dims.push_back(dim.GetInt64());
+        } else if (dim.IsString()) {
+            tensor.dims.push_back(std::stoll(dim.GetString()));
+        } else {
+            throw_invalid_config(model_name, "non-integer dimension in " + tensor.name);
+        }
+    }
+    if (input && tensor_json.HasMember("format") && tensor_json["format"].IsString()) {
+        tensor.format = tensor_json["format"].GetString();
+    }
+    return tensor;
+}
 
-    rapidjson::Document response_json;
-    response_json.Parse(response_data.c_str());
-    info.input_name = response_json["input"][0]["name"].GetString();
-    const auto& input_dims = response_json["input"][0]["dims"].GetArray();
-    info.input_format = response_json["input"][0]["format"].GetString();
-    if (info.input_format == "FORMAT_NONE") {
-        info.input_format = "FORMAT_NCHW";
+ModelConfigFields config_fields_from_json(const std::string& config_json, const std::string& model_name) {
+    rapidjson::Document document;
+    document.Parse(config_json.c_str());
+    if (document.HasParseError() || !document.IsObject()) {
+        throw_invalid_config(model_name, "the server returned malformed JSON");
+    }
+    ModelConfigFields fields;
+    if (document.HasMember("max_batch_size") && document["max_batch_size"].IsInt()) {
+        fields.max_batch_size = document["max_batch_size"].GetInt();
+    }
+    for (const char* key : {"input", "output"}) {
+        const rapidjson::Value& tensors = json_member(document, key, model_name);
+        if (!tensors.IsArray()) {
+            throw_invalid_config(model_name, std::string("\"") + key + "\" is not an array");
+        }
+        const bool input = key[0] == 'i';
+        for (const auto& tensor : tensors.GetArray()) {
+            (input ? fields.inputs : fields.outputs).push_back(tensor_from_json(tensor, input, model_name));
+        }
+    }
+    if (document.HasMember("parameters") && document["parameters"].IsObject()) {
+        for (const auto& parameter : document["parameters"].GetObject()) {
+            if (parameter.value.IsObject() && parameter.value.HasMember("string_value") &&
+                parameter.value["string_value"].IsString()) {
+                fields.parameters[parameter.name.GetString()] = parameter.value["string_value"].GetString();
+            }
+        }
     }
+    return fields;
+}
 
-    if (info.input_format == "FORMAT_NCHW") {
-        if (input_dims.Size() == 4) {
-            info.input_channels = input_dims[1].GetInt();
-            info.input_height = input_dims[2].GetInt();
-            info.input_width = input_dims[3].GetInt();
-        } else if (input_dims.Size() == 3) {
-            info.input_channels = input_dims[0].GetInt();
-            info.input_height = input_dims[1].GetInt();
-            info.input_width = input_dims[2].GetInt();
-            info.input_shape.push_back(info.batch_size);
-        } else {
-            curl_easy_cleanup(curl);
-            std::stringstream err_msg;
-            err_msg << "Unsupported input dimensions in model configuration. Expected 3 or 4 dimensions, but received " << input_dims.Size() << " dimensions.";
-            throw std::runtime_error(err_msg.str());
+ModelConfigFields config_fields_from_proto(const inference::ModelConfig& config) {
+    ModelConfigFields fields;
+    fields.max_batch_size = config.max_batch_size();
+    for (const auto& [key, parameter] : config.parameters()) {
+        fields.parameters[key] = parameter.string_value();
+    }
+    for (int i = 0; i < config.input_size(); ++i) {
+        const auto& input = config.input(i);
+        ModelConfigFields::Tensor tensor{input.name(), inference::DataType_Name(input.data_type()),
+                                         inference::ModelInput_Format_Name(input.format()), {}};
+        for (int d = 0; d < input.dims_size(); ++d) {
+            tensor.dims.push_back(input.dims(d));
+        }
+        fields.inputs.push_back(std::move(tensor));
+    }
+    for (int i = 0; i < config.output_size(); ++i) {
+        const auto& output = config.output(i);
+        ModelConfigFields::Tensor tensor{output.name(), inference::DataType_Name(output.data_type()), "", {}};
+        for (int d = 0; d < output.dims_size(); ++d) {
+            tensor.dims.push_back(output.dims(d));
         }
+        fields.outputs.push_back(std::move(tensor));
+    }
+    return fields;
+}
+
+// "TYPE_FP32" -> "FP32", checking that the client can size tensors of that type. "TYPE_STRING" is
+// "BYTES" on the wire.
+std::string tensor_datatype(const std::string& config_datatype, const std::string& model_name) {
+    if (config_datatype.rfind("TYPE_", 0) != 0) {
+        throw_invalid_config(model_name, "unexpected data type " + config_datatype);
+    }
+    if (config_datatype == "TYPE_STRING") {
+        return "BYTES";
+    }
+    std::string datatype = config_datatype.substr(5);
+    datatype_byte_size(datatype);
+    return datatype;
+}
+
+// A tensor input: shape and layout come from the dims and format.
+void tensor_input_info(const ModelConfigFields::Tensor& input, const std::string& model_name, TritonModelInfo& info) {
+    info.input_format = input.format.empty() || input.format == "FORMAT_NONE" ? "FORMAT_NCHW" : input.format;
+    const auto& input_dims = input.dims;
+    if (input_dims.size() != 3 && input_dims.size() != 4) {
+        std::stringstream err_msg;
+        err_msg << "Unsupported input dimensions in model configuration. Expected 3 or 4 dimensions, but received " << input_dims.size() << " dimensions.";
+        throw std::runtime_error(err_msg.str());
+    }
+    // Dims without the batch dimension start at 0; a 4-D input carries its own batch dimension
+    const size_t first = input_dims.size() == 4 ? 1 : 0;
+    if (info.input_format == "FORMAT_NCHW") {
+        info.input_channels = static_cast<int>(input_dims[first]);
+        info.input_height = static_cast<int>(input_dims[first + 1]);
+        info.input_width = static_cast<int>(input_dims[first + 2]);
     } else if (info.input_format == "FORMAT_NHWC") {
-        if (input_dims.Size() == 4) {
-            info.input_height = input_dims[1].GetInt();
-            info.input_width = input_dims[2].GetInt();
-            info.input_channels = input_dims[3].GetInt();
-        } else if (input_dims.Size() == 3) {
-            info.input_height = input_dims[0].GetInt();
-            info.input_width = input_dims[1].GetInt();
-            info.input_channels = input_dims[2].GetInt();
-            info.input_shape.push_back(info.batch_size);
-        } else {
-            curl_easy_cleanup(curl);
-            std::stringstream err_msg;
-            err_msg << "Unsupported input dimensions in model configuration. Expected 3 or 4 dimensions, but received " << input_dims.Size() << " dimensions.";
-            throw std::runtime_error(err_msg.str());
+        info.input_height = static_cast<int>(input_dims[first]);
+        info.input_width = static_cast<int>(input_dims[first + 1]);
+        info.input_channels = static_cast<int>(input_dims[first + 2]);
+    } else {
+        throw_invalid_config(model_name, "unsupported input format " + info.input_format);
+    }
+    if (input_dims.size() == 3) {
+        info.input_shape.push_back(info.batch_size);
+    }
+    info.input_shape.insert(info.input_shape.end(), input_dims.begin(), input_dims.end());
+}
+
+// An encoded-image input (one BYTES element per frame, decoded server-side). The tensor only has
+// a length dimension, so the network resolution the server decodes to is read from the
+// "input_width" and "input_height" model parameters.
+void encoded_input_info(const ModelConfigFields& fields, const std::string& model_name, TritonModelInfo& info) {
+    const auto& input_dims = fields.inputs.front().dims;
+    if (input_dims.size() != 1 || (input_dims[0] != 1 && input_dims[0] != -1)) {
+        throw_invalid_config(model_name, "an encoded image input must have dims [1]");
+    }
+    auto dimension = [&](const char* key) {
+        auto it = fields.parameters.find(key);
+        int value = 0;
+        try {
+            value = it == fields.parameters.end() ? 0 : std::stoi(it->second);
+        } catch (const std::exception&) {
+        }
+        if (value <= 0) {
+            throw_invalid_config(model_name, std::string("an encoded image input needs a positive \"") + key + "\" parameter");
+        }
+        return value;
+    };
+    info.input_format = "FORMAT_NONE";
+    info.input_channels = 3;
+    info.input_width = dimension("input_width");
+    info.input_height = dimension("input_height");
+    if (info.max_batch_size > 0) {
+        info.input_shape.push_back(info.batch_size);
+    }
+    info.input_shape.push_back(1);
+}
+
+TritonModelInfo model_info_from_config(const ModelConfigFields& fields, const std::string& model_name) {
+    if (fields.inputs.size() != 1) {
+        throw_invalid_config(model_name, "expected exactly one input, found " + std::to_string(fields.inputs.size()));
+    }
+    if (fields.outputs.empty()) {
+        throw_invalid_config(model_name, "no outputs");
+    }
+    TritonModelInfo info;
+    const ModelConfigFields::Tensor& input = fields.inputs.front();
+    info.input_name = input.name;
+    info.input_datatype = tensor_datatype(input.datatype, model_name);
+    info.max_batch_size = fields.max_batch_size;
+    if (info.input_datatype == "BYTES") {
+        encoded_input_info(fields, model_name, info);
+    } else {
+        tensor_input_info(input, model_name, info);
+    }
+    for (const auto& output : fields.outputs) {
+        info.output_names.push_back(output.name);
+        info.output_datatypes.push_back(tensor_datatype(output.datatype, model_name));
+        std::vector<int64_t> output_shape;
+        if (info.max_batch_size > 0) {
+            output_shape.push_back(info.batch_size);
         }
+        output_shape.insert(output_shape.end(), output.dims.begin(), output.dims.end());
+        info.output_shapes.push_back(output_shape);
     }
+    return info;
+}
 
-    for (const auto& dim : input_dims) {
-        info.input_shape.push_back(dim.GetInt64());
+// Protobuf only orders map fields (the config's "parameters") when asked to, and the fingerprint
+// must not change between two identical responses.
+std::string serialize_deterministic(const google::protobuf::Message& message) {
+    std::string serialized;
+    {
+        google::protobuf::io::StringOutputStream stream(&serialized);
+        google::protobuf::io::CodedOutputStream coded(&stream);
+        coded.SetSerializationDeterministic(true);
+        message.SerializeToCodedStream(&coded);
     }
+    return serialized;
+}
 
-    info.max_batch_size = response_json["max_batch_size"].GetInt();
+} // namespace
 
-    for (const auto& output : response_json["output"].GetArray()) {
-        info.output_names.push_back(output["name"].GetString());
+tc::Error TritonClient::query_endpoints(const std::function<tc::Error(TritonEndpoint&)>& query) {
+    if (!initialized_) {
+        throw std::runtime_error("Triton client is not initialized. Call initialize_triton_client() first.");
+    }
+    tc::Error err;
+    for (auto& endpoint : endpoints_) {
+        err = query(*endpoint);
+        if (err.IsOk()) {
+            break;
+        }
     }
+    return err;
+}
 
-    info.input_datatype = response_json["input"][0]["data_type"].GetString();
-    info.input_datatype.erase(0, 5);
+TritonModelInfo TritonClient::parse_model(const std::string& model_name) {
+    return fetch_model_info(model_name, nullptr);
+}
 
-    // Cleanup
-    curl_easy_cleanup(curl);
+TritonModelInfo TritonClient::fetch_model_info(const std::string& model_name, std::string* fingerprint) {
+    ModelConfigFields fields;
+    tc::Error err = query_endpoints([&](TritonEndpoint& endpoint) {
+        if (protocol_ == ProtocolType::HTTP) {
+            std::string config_json;
+            tc::Error query_err = endpoint.client.httpClient->ModelConfig(&config_json, model_name, model_version_);
+            if (query_err.IsOk()) {
+                fields = config_fields_from_json(config_json, model_name);
+                if (fingerprint) {
+                    *fingerprint = ModelInfoCache::fingerprint(config_json);
+                }
+            }
+            return query_err;
+        }
+        inference::ModelConfigResponse response;
+        tc::Error query_err = endpoint.client.grpcClient->ModelConfig(&response, model_name, model_version_);
+        if (query_err.IsOk()) {
+            fields = config_fields_from_proto(response.config());
+            if (fingerprint) {
+                *fingerprint = ModelInfoCache::fingerprint(serialize_deterministic(response));
+            }
+        }
+        return query_err;
+    });
+    if (!err.IsOk()) {
+        std::stringstream err_msg;
+        err_msg << "Failed to retrieve the configuration of model '" << model_name << "'. Please check the model name and that the server is up. Error details: " << err;
+        throw std::runtime_error(err_msg.str());
+    }
+    return model_info_from_config(fields, model_name);
+}
 
-    return info;
+// The configuration rather than the metadata: batching, output dims and the input format the
+// cached entry depends on can all change without touching the model's tensor names and shapes.
+std::string TritonClient::model_fingerprint(const std::string& model_name) {
+    std::string config;
+    tc::Error err = query_endpoints([&](TritonEndpoint& endpoint) {
+        if (protocol_ == ProtocolType::HTTP) {
+            return endpoint.client.httpClient->ModelConfig(&config, model_name, model_version_);
+        }
+        inference::ModelConfigResponse response;
+        tc::Error query_err = endpoint.client.grpcClient->ModelConfig(&response, model_name, model_version_);
+        if (query_err.IsOk()) {
+            config = serialize_deterministic(response);
+        }
+        return query_err;
+    });
+    return err.IsOk() ? ModelInfoCache::fingerprint(config) : std::string();
 }
 
 void TritonClient::set_input_shape(const std::vector<int64_t>& shape)
@@ -106,8 +345,36 @@ void TritonClient::set_input_shape(const std::vector<int64_t>& shape)
     }
 
 
-TritonModelInfo TritonClient::retrieve_model_info(const std::string& model_name, const std::string& url, const std::vector<int64_t>& shape) {
-    model_info_ = parse_model(model_name, url);
+TritonModelInfo TritonClient::load_model_info(const std::string& model_name) {
+    if (!model_info_cache_) {
+        return parse_model(model_name);
+    }
+    std::string server = protocol_ == ProtocolType::GRPC ? "grpc" : "http";
+    for (const auto& endpoint : endpoints_) {
+        server += " " + endpoint->url;
+    }
+    std::string fingerprint;
+    if (auto entry = model_info_cache_->load(server, model_name, model_version_)) {
+        if (model_info_cache_->fresh(*entry)) {
+            return entry->info;
+        }
+        // Stale: still valid if the server describes the model exactly as it did when cached
+        fingerprint = model_fingerprint(model_name);
+        if (!fingerprint.empty() && fingerprint == entry->fingerprint) {
+            model_info_cache_->store(server, model_name, model_version_, entry->info, fingerprint);
+            return entry->info;
+        }
+    }
+    // Hashes the configuration it parses, so a miss costs a single round trip
+    TritonModelInfo info = fetch_model_info(model_name, &fingerprint);
+    if (!fingerprint.empty()) {
+        model_info_cache_->store(server, model_name, model_version_, info, fingerprint);
+    }
+    return info;
+}
+
+TritonModelInfo TritonClient::retrieve_model_info(const std::string& model_name, const std::vector<int64_t>& shape) {
+    model_info_ = load_model_info(model_name);
 
     if (model_info_.input_width == -1 || model_info_.input_height == -1) {
         if (shape.empty()) {
@@ -116,133 +383,808 @@ TritonModelInfo TritonClient::retrieve_model_info(const std::string& model_name,
         set_input_shape(shape);
     }
 
-    const auto& info = model_info_;
-    // Print model info
-    // std::cout << "Retrieved model information: " << std::endl;
-    // std::cout << "Input Name: " << info.input_name << std::endl;
-    // std::cout << "Input Data Type: " << info.input_datatype << std::endl;
-    // std::cout << "Input Channels: " << info.input_channels << std::endl;
-    // std::cout << "Input Height: " << info.input_height << std::endl;
-    // std::cout << "Input Width: " << info.input_width << std::endl;
-    // std::cout << "Input Format: " << info.input_format << std::endl;
-    // std::cout << "Max Batch Size: " << info.max_batch_size << std::endl;
-    // std::cout << "Output Names: ";
-    // for (const auto& output_name : info.output_names) {
-    //     std::cout << output_name << " ";
-    // }
-    // std::cout << std::endl;
-    return info;
+    // Request objects are built lazily per batch size from the final model info
+    request_pool_ = std::make_unique<PreparedRequestPool>(request_template());
+    return model_info_;
 }
 
-void TritonClient::initialize_triton_client() {
+void TritonClient::warm_up(size_t iterations, size_t batch_size) {
+    // Zero tensors (black JPEGs for encoded inputs) through every endpoint, bypassing the metrics
+    // and the endpoint latency histograms
+    std::vector<uint8_t> zeros;
+    if (model_info_.input_datatype == "BYTES") {
+        std::vector<uint8_t> black;
+        cv::imencode(".jpg", cv::Mat(model_info_.input_height, model_info_.input_width, CV_8UC3, cv::Scalar::all(0)), black);
+        for (size_t i = 0; i < batch_size; ++i) {
+            append_bytes_element(zeros, black.data(), black.size());
+        }
+    } else {
+        zeros.resize(element_count(model_info_.input_shape) * datatype_byte_size(model_info_.input_datatype) *
+                     (model_info_.max_batch_size > 0 ? batch_size : 1));
+    }
+    PreparedRequestPool::Lease request = request_pool().acquire(batch_size);
+    request->bind_input(zeros.data(), zeros.size());
+    for (auto& endpoint : endpoints_) {
+        for (size_t i = 0; i < iterations; ++i) {
+            tc::InferResult* result = nullptr;
+            tc::Error err = infer_on(*endpoint, &result, *request);
+            std::unique_ptr<tc::InferResult> owned(result);
+            if (err.IsOk() && shm_request_ && endpoint == endpoints_.front()) {
+                result = nullptr;
+                err = infer_on(*endpoint, &result, *shm_request_);
+                owned.reset(result);
+            }
+            if (!err.IsOk()) {
+                std::stringstream err_msg;
+                err_msg << "Warm-up request to " << endpoint->url << " failed. Error details: " << err;
+                throw std::runtime_error(err_msg.str());
+            }
+        }
+    }
+}
+
+TritonEndpoint::~TritonEndpoint() {
+    for (TritonClientInstance* instance : {&client, &health_client}) {
+        if (protocol == ProtocolType::HTTP) {
+            instance->httpClient.~unique_ptr<tc::InferenceServerHttpClient>();
+        } else {
+            instance->grpcClient.~unique_ptr<tc::InferenceServerGrpcClient>();
+        }
+    }
+}
+
+TritonClient::TritonClient(const std::vector<std::string>& server_urls, ProtocolType protocol, const std::string& model_name,
+                           const std::string& model_version, bool verbose, const LoadBalancingConfig& balancing)
+    : balancing_{balancing},
+      verbose_{verbose},
+      protocol_{protocol},
+      model_name_{model_name},
+      model_version_{model_version} {
+    if (server_urls.empty()) {
+        throw std::runtime_error("At least one Triton server URL is required.");
+    }
+    for (const auto& url : server_urls) {
+        endpoints_.push_back(std::make_unique<TritonEndpoint>(url, protocol));
+    }
+}
+
+void TritonClient::create_client(TritonClientInstance& instance, const std::string& url) {
     tc::Error err;
     if (protocol_ == ProtocolType::HTTP) {
-        err = tc::InferenceServerHttpClient::Create(&client_.httpClient, server_url_, verbose_);
+        err = tc::InferenceServerHttpClient::Create(&instance.httpClient, url, verbose_);
     } else {
-        err = tc::InferenceServerGrpcClient::Create(&client_.grpcClient, server_url_, verbose_);
+        err = tc::InferenceServerGrpcClient::Create(&instance.grpcClient, url, verbose_);
     }
     if (!err.IsOk()) {
         std::stringstream err_msg;
-        err_msg << "Failed to create Triton client for inference. Details: " << err;
+        err_msg << "Failed to create Triton client for inference at " << url << ". Details: " << err;
         throw std::runtime_error(err_msg.str());
     }
 }
 
-std::vector<const tc::InferRequestedOutput*> TritonClient::create_infer_requested_output(const std::vector<std::string>& output_names) {
-    std::vector<const tc::InferRequestedOutput*> outputs;
+void TritonClient::initialize_triton_client() {
+    const bool balanced = endpoints_.size() > 1;
+    for (auto& endpoint : endpoints_) {
+        create_client(endpoint->client, endpoint->url);
+        if (balanced) {
+            create_client(endpoint->health_client, endpoint->url);
+        }
+    }
+    initialized_ = true;
+    if (balanced && !health_thread_.joinable()) {
+        health_thread_ = std::thread(&TritonClient::health_check_loop, this);
+    }
+}
+
+size_t TritonClient::healthy_endpoint_count() const {
+    size_t count = 0;
+    for (const auto& endpoint : endpoints_) {
+        count += endpoint->healthy.load(std::memory_order_relaxed) ? 1 : 0;
+    }
+    return count;
+}
+
+TritonEndpoint& TritonClient::select_endpoint(const TritonEndpoint* exclude) {
+    const size_t count = endpoints_.size();
+    if (count == 1) {
+        return primary_endpoint();
+    }
+    // Start the scan at a rotating offset so ties are broken round-robin
+    const size_t start = next_endpoint_.fetch_add(1, std::memory_order_relaxed);
+    TritonEndpoint* best = nullptr;
+    bool best_healthy = false;
+    size_t best_outstanding = 0;
+    for (size_t i = 0; i < count; ++i) {
+        TritonEndpoint& endpoint = *endpoints_[(start + i) % count];
+        if (&endpoint == exclude) {
+            continue;
+        }
+        const bool healthy = endpoint.healthy.load(std::memory_order_relaxed);
+        const size_t outstanding = endpoint.outstanding.load(std::memory_order_relaxed);
+        if (!best || (healthy && !best_healthy) || (healthy == best_healthy && outstanding < best_outstanding)) {
+            best = &endpoint;
+            best_healthy = healthy;
+            best_outstanding = outstanding;
+        }
+    }
+    return *best;
+}
+
+tc::Error TritonClient::infer_on(TritonEndpoint& endpoint, tc::InferResult** result, PreparedRequest& request) {
+    if (protocol_ == ProtocolType::HTTP) {
+        return endpoint.client.httpClient->Infer(result, request.options(), request.inputs(), request.outputs());
+    }
+    return endpoint.client.grpcClient->Infer(result, request.options(), request.inputs(), request.outputs());
+}
+
+tc::Error TritonClient::async_infer_on(TritonEndpoint& endpoint, tc::InferenceServerClient::OnCompleteFn callback,
+                                       PreparedRequest& request) {
+    if (protocol_ == ProtocolType::HTTP) {
+        return endpoint.client.httpClient->AsyncInfer(callback, request.options(), request.inputs(), request.outputs());
+    }
+    return endpoint.client.grpcClient->AsyncInfer(callback, request.options(), request.inputs(), request.outputs());
+}
+
+void TritonClient::record_endpoint_result(TritonEndpoint& endpoint, std::chrono::steady_clock::time_point start, bool ok) {
+    if (ok) {
+        endpoint.latency.record(std::chrono::steady_clock::now() - start);
+        return;
+    }
+    // A single endpoint has nowhere to fail over to, so it is never ejected
+    if (endpoints_.size() > 1 && endpoint.healthy.exchange(false)) {
+        YOLOV10_COUNT(MetricCounter::EndpointEjections, 1);
+        std::cerr << "Triton endpoint " << endpoint.url << " ejected after a failed request." << std::endl;
+    }
+}
+
+bool TritonClient::check_endpoint_health(TritonEndpoint& endpoint) {
+    bool live = false;
+    bool ready = false;
     tc::Error err;
-    for (const auto& output_name : output_names) {
-        tc::InferRequestedOutput* output;
-        err = tc::InferRequestedOutput::Create(&output, output_name);
+    if (protocol_ == ProtocolType::HTTP) {
+        err = endpoint.health_client.httpClient->IsServerLive(&live);
+        if (err.IsOk() && live) {
+            err = endpoint.health_client.httpClient->IsModelReady(&ready, model_name_, model_version_);
+        }
+    } else {
+        err = endpoint.health_client.grpcClient->IsServerLive(&live);
+        if (err.IsOk() && live) {
+            err = endpoint.health_client.grpcClient->IsModelReady(&ready, model_name_, model_version_);
+        }
+    }
+    return err.IsOk() && live && ready;
+}
+
+void TritonClient::health_check_loop() {
+    std::unique_lock<std::mutex> lock(health_mutex_);
+    while (!health_stop_) {
+        lock.unlock();
+        for (auto& endpoint : endpoints_) {
+            const bool healthy = check_endpoint_health(*endpoint);
+            if (endpoint->healthy.exchange(healthy) != healthy) {
+                if (!healthy) {
+                    YOLOV10_COUNT(MetricCounter::EndpointEjections, 1);
+                }
+                std::cerr << "Triton endpoint " << endpoint->url
+                          << (healthy ? " passed its health check and is back in rotation." : " failed its health check and was ejected.")
+                          << std::endl;
+            }
+        }
+        lock.lock();
+        health_cv_.wait_for(lock, balancing_.health_check_interval, [this] { return health_stop_; });
+    }
+}
+
+void InferenceOutput::index_tensors(const std::vector<std::string>& output_names) {
+    tensors_.resize(output_names.size());
+    for (size_t i = 0; i < output_names.size(); ++i) {
+        Tensor& tensor = tensors_[i];
+        tensor.name = output_names[i];
+        tc::Error err = result_->Shape(output_names[i], &shape_scratch_);
         if (!err.IsOk()) {
             std::stringstream err_msg;
-            err_msg << "Unable to create output for inference request. Output name: " << output_name << ". Error details: " << err;
+            err_msg << "Failed to retrieve shape for output: " << output_names[i] << ". Error details: " << err;
+            throw std::runtime_error(err_msg.str());
+        }
+        tensor.shape.assign(shape_scratch_);
+        err = result_->Datatype(output_names[i], &tensor.datatype);
+        if (!err.IsOk()) {
+            std::stringstream err_msg;
+            err_msg << "Failed to retrieve datatype for output: " << output_names[i] << ". Error details: " << err;
             throw std::runtime_error(err_msg.str());
-        } else {
-            outputs.push_back(output);
         }
     }
-    return outputs;
 }
 
-std::tuple<std::vector<std::vector<float>>, std::vector<std::vector<int64_t>>> TritonClient::extract_inference_results(
+void InferenceOutput::reset(tc::InferResult* result, const std::vector<std::string>& output_names) {
+    result_.reset(result);
+    if (!result_->RequestStatus().IsOk()) {
+        std::stringstream err_msg;
+        err_msg << "Inference request failed. Status: " << result_->RequestStatus();
+        throw std::runtime_error(err_msg.str());
+    }
+    index_tensors(output_names);
+    for (auto& tensor : tensors_) {
+        tc::Error err = result_->RawData(tensor.name, &tensor.data, &tensor.byte_size);
+        if (!err.IsOk()) {
+            std::stringstream err_msg;
+            err_msg << "Failed to retrieve data for output: " << tensor.name << ". Error details: " << err;
+            throw std::runtime_error(err_msg.str());
+        }
+    }
+}
+
+void InferenceOutput::reset(tc::InferResult* result, const std::vector<std::string>& output_names, const uint8_t* region,
+                            const std::vector<size_t>& offsets, const std::vector<size_t>& byte_sizes) {
+    result_.reset(result);
+    if (!result_->RequestStatus().IsOk()) {
+        std::stringstream err_msg;
+        err_msg << "Inference request failed. Status: " << result_->RequestStatus();
+        throw std::runtime_error(err_msg.str());
+    }
+    index_tensors(output_names);
+    for (size_t i = 0; i < tensors_.size(); ++i) {
+        tensors_[i].data = region + offsets[i];
+        tensors_[i].byte_size = std::min(byte_sizes[i], tensors_[i].shape.element_count() * datatype_byte_size(tensors_[i].datatype));
+    }
+}
+
+void InferenceOutput::detach() {
+    size_t total = 0;
+    for (const auto& tensor : tensors_) {
+        total += tensor.byte_size;
+    }
+    detached_.resize(total);
+    size_t offset = 0;
+    for (auto& tensor : tensors_) {
+        if (tensor.data != detached_.data() + offset) {
+            std::memmove(detached_.data() + offset, tensor.data, tensor.byte_size);
+            tensor.data = detached_.data() + offset;
+        }
+        offset += tensor.byte_size;
+    }
+}
+
+void TritonClient::extract_inference_results(
     tc::InferResult* result,
     const size_t batch_size,
     const std::vector<std::string>& output_names, 
-    const bool batching) {
-    
-    if (!result->RequestStatus().IsOk()) {
+    const bool batching,
+    InferenceOutput& output) {
+
+    output.reset(result, output_names);
+    if (batching) {
+        for (size_t i = 0; i < output.size(); ++i) {
+            const TensorShape& infer_shape = output.shape(i);
+            if (infer_shape.size() == 0 || infer_shape[0] != static_cast<int64_t>(batch_size)) {
+                std::stringstream err_msg;
+                err_msg << "Output " << output_names[i] << " does not match the request batch size " << batch_size << ".";
+                throw std::runtime_error(err_msg.str());
+            }
+        }
+    }
+}
+
+void TritonClient::check_batch_size(size_t batch_size) const {
+    if (batch_size != 1 && (model_info_.max_batch_size <= 0 || batch_size > static_cast<size_t>(model_info_.max_batch_size))) {
         std::stringstream err_msg;
-        err_msg << "Inference request failed. Status: " << result->RequestStatus();
+        err_msg << "Batch size " << batch_size << " exceeds the model's max_batch_size of " << model_info_.max_batch_size << ".";
         throw std::runtime_error(err_msg.str());
     }
+}
 
-    std::vector<std::vector<float>> infer_results;
-    std::vector<std::vector<int64_t>> infer_shapes;
-
-    float* output_data;
-    size_t output_byte_size;
-    for (const auto& output_name : output_names) {
-        std::vector<int64_t> infer_shape;
-        std::vector<float> infer_result;
-
-        result->RawData(output_name, (const uint8_t**)&output_data, &output_byte_size);
+std::string TritonClient::next_request_id(const std::optional<RequestTag>& tag) {
+    const uint64_t sequence = next_request_id_.fetch_add(1, std::memory_order_relaxed);
+    return tag ? trace_request_id(tag->frame_id, tag->index, sequence) : std::to_string(sequence);
+}
 
-        tc::Error err = result->Shape(output_name, &infer_shape);
-        infer_result = std::vector<float>(output_byte_size / sizeof(float));
-        std::memcpy(infer_result.data(), output_data, output_byte_size);
-        if (!err.IsOk()) {
+void TritonClient::run_inference(const std::vector<uint8_t>& input_data, InferenceOutput& output, const size_t batch_size,
+                                 const std::optional<RequestTag>& tag) {
+    if (shm_input_ && batch_size == 1) {
+        if (input_data.size() != shm_input_->size()) {
             std::stringstream err_msg;
-            err_msg << "Failed to retrieve data for output: " << output_name << ". Error details: " << err;
+            err_msg << "Unexpected input size: " << input_data.size() << " bytes, expecting " << shm_input_->size();
             throw std::runtime_error(err_msg.str());
         }
-        infer_results.push_back(infer_result);
-        infer_shapes.push_back(infer_shape);
+        {
+            YOLOV10_SCOPED_TIMER(MetricStage::Serialize);
+            std::memcpy(shm_input_->data(), input_data.data(), input_data.size());
+        }
+        run_inference_from_shared_memory(output, tag);
+        return;
     }
 
-    return std::make_tuple(infer_results, infer_shapes);
-}
+    check_batch_size(batch_size);
+
+    YOLOV10_COUNT(MetricCounter::Requests, 1);
+    if (balancing_.hedging && endpoints_.size() > 1) {
+        tc::InferResult* result = run_hedged_inference(input_data, batch_size, next_request_id(tag));
+        YOLOV10_SCOPED_TIMER(MetricStage::Deserialize);
+        extract_inference_results(result, batch_size, model_info_.output_names, model_info_.max_batch_size > 0, output);
+        return;
+    }
+
+    PreparedRequestPool::Lease request;
+    {
+        YOLOV10_SCOPED_TIMER(MetricStage::Serialize);
+        request = request_pool().acquire(batch_size);
+        request->bind_input(input_data.data(), input_data.size());
+        // Pooled objects keep the id of their previous request otherwise
+        request->options().request_id_ = next_request_id(tag);
+    }
 
-std::tuple<std::vector<std::vector<float>>, std::vector<std::vector<int64_t>>> TritonClient::run_inference(const std::vector<uint8_t>& input_data) {
+    TritonEndpoint& endpoint = select_endpoint();
     tc::Error err;
-    std::vector<tc::InferInput*> inputs = {nullptr};
+    tc::InferResult* result;
+    {
+        YOLOV10_SCOPED_TIMER(MetricStage::Network);
+        endpoint.outstanding.fetch_add(1, std::memory_order_relaxed);
+        const auto start = std::chrono::steady_clock::now();
+        err = infer_on(endpoint, &result, *request);
+        endpoint.outstanding.fetch_sub(1, std::memory_order_relaxed);
+        record_endpoint_result(endpoint, start, err.IsOk());
+    }
 
-    std::string input_name = model_info_.input_name;
-    err = tc::InferInput::Create(&inputs[0], input_name, model_info_.input_shape, model_info_.input_datatype);
     if (!err.IsOk()) {
+        YOLOV10_COUNT(MetricCounter::Errors, 1);
         std::stringstream err_msg;
-        err_msg << "Failed to create inference input. Error details: " << err;
+        err_msg << "Inference request failed. Error details: " << err;
         throw std::runtime_error(err_msg.str());
     }
+    
+    YOLOV10_SCOPED_TIMER(MetricStage::Deserialize);
+    extract_inference_results(result, batch_size, model_info_.output_names, model_info_.max_batch_size > 0, output);
+}
 
-    err = inputs[0]->AppendRaw(input_data);
-    if (!err.IsOk()) {
+// A blocking request that may be sent to two endpoints. It owns a copy of the input and both
+// request objects, so the losing copy can still be on the wire after run_inference has returned.
+struct HedgedInference {
+    std::vector<uint8_t> input_data;
+    PreparedRequestPool::Lease requests[2];
+    size_t sent{0};
+    size_t completed{0};
+    tc::InferResult* result{nullptr}; // First successful response, handed to the caller
+    std::string error;
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+
+static void release_settled_hedge(HedgedInference& hedge) {
+    // The leases return their requests to request_pool_, so they must go before pending_hedges_ lets
+    // ~TritonClient proceed; the caller's shared_ptr may outlive the client
+    if (hedge.completed == hedge.sent) {
+        for (auto& request : hedge.requests) {
+            request = {};
+        }
+    }
+}
+
+tc::InferResult* TritonClient::run_hedged_inference(const std::vector<uint8_t>& input_data, size_t batch_size,
+                                                    const std::string& request_id) {
+    auto hedge = std::make_shared<HedgedInference>();
+    {
+        YOLOV10_SCOPED_TIMER(MetricStage::Serialize);
+        hedge->input_data = input_data;
+        hedge->requests[0] = request_pool().acquire(batch_size);
+        hedge->requests[0]->bind_input(hedge->input_data.data(), hedge->input_data.size());
+        hedge->requests[0]->options().request_id_ = request_id;
+        hedge->sent = 1;
+    }
+
+    YOLOV10_SCOPED_TIMER(MetricStage::Network);
+    TritonEndpoint& primary = select_endpoint();
+    send_hedge_copy(hedge, primary, 0);
+
+    std::unique_lock<std::mutex> lock(hedge->mutex);
+    auto settled = [&] { return hedge->result != nullptr || hedge->completed == hedge->sent; };
+    // Until the endpoint has enough samples for a meaningful quantile, only a failure triggers the second copy
+    if (primary.latency.count() >= balancing_.hedge_min_samples) {
+        const auto delay = std::max<std::chrono::microseconds>(
+            balancing_.min_hedge_delay, std::chrono::microseconds(primary.latency.quantile_us(balancing_.hedge_quantile)));
+        hedge->cv.wait_for(lock, delay, settled);
+    } else {
+        hedge->cv.wait(lock, settled);
+    }
+    if (!hedge->result) {
+        // Filled under the lock: the last completion releases the leases once completed == sent
+        hedge->requests[1] = request_pool().acquire(batch_size);
+        hedge->requests[1]->bind_input(hedge->input_data.data(), hedge->input_data.size());
+        hedge->requests[1]->options().request_id_ = request_id;
+        ++hedge->sent;
+        lock.unlock();
+        TritonEndpoint& backup = select_endpoint(&primary);
+        YOLOV10_COUNT(MetricCounter::Hedges, 1);
+        send_hedge_copy(hedge, backup, 1);
+        lock.lock();
+        hedge->cv.wait(lock, settled);
+    }
+    if (!hedge->result) {
+        YOLOV10_COUNT(MetricCounter::Errors, 1);
         std::stringstream err_msg;
-        err_msg << "Failed to set input data for inference. Error details: " << err;
+        err_msg << "Inference request failed on every endpoint tried. Error details: " << hedge->error;
         throw std::runtime_error(err_msg.str());
     }
+    return hedge->result;
+}
+
+void TritonClient::send_hedge_copy(const std::shared_ptr<HedgedInference>& hedge, TritonEndpoint& endpoint, size_t index) {
+    {
+        std::lock_guard<std::mutex> lock(hedge_mutex_);
+        ++pending_hedges_;
+    }
+    endpoint.outstanding.fetch_add(1, std::memory_order_relaxed);
+    const auto start = std::chrono::steady_clock::now();
+    auto on_complete = [this, hedge, &endpoint, start](tc::InferResult* result) { complete_hedge(hedge, endpoint, start, result); };
+    tc::Error err = async_infer_on(endpoint, on_complete, *hedge->requests[index]);
+    if (err.IsOk()) {
+        return;
+    }
+    endpoint.outstanding.fetch_sub(1, std::memory_order_relaxed);
+    record_endpoint_result(endpoint, start, false);
+    {
+        std::lock_guard<std::mutex> lock(hedge->mutex);
+        ++hedge->completed;
+        std::stringstream err_msg;
+        err_msg << err;
+        hedge->error = err_msg.str();
+        release_settled_hedge(*hedge);
+        hedge->cv.notify_all();
+    }
+    std::lock_guard<std::mutex> lock(hedge_mutex_);
+    --pending_hedges_;
+    hedge_cv_.notify_all();
+}
 
-    tc::InferOptions options(model_name_);
-    std::vector<std::string> output_names = model_info_.output_names;
-    auto outputs = create_infer_requested_output(output_names);
+void TritonClient::complete_hedge(const std::shared_ptr<HedgedInference>& hedge, TritonEndpoint& endpoint,
+                                  std::chrono::steady_clock::time_point start, tc::InferResult* result) {
+    endpoint.outstanding.fetch_sub(1, std::memory_order_relaxed);
+    const bool ok = result->RequestStatus().IsOk();
+    record_endpoint_result(endpoint, start, ok);
+    {
+        std::lock_guard<std::mutex> lock(hedge->mutex);
+        ++hedge->completed;
+        if (ok && !hedge->result) {
+            hedge->result = result;
+            result = nullptr;
+        } else if (!ok) {
+            std::stringstream err_msg;
+            err_msg << result->RequestStatus();
+            hedge->error = err_msg.str();
+        }
+        release_settled_hedge(*hedge);
+        hedge->cv.notify_all();
+    }
+    delete result; // The slower copy, or a failed one
+    std::lock_guard<std::mutex> lock(hedge_mutex_);
+    --pending_hedges_;
+    hedge_cv_.notify_all();
+}
 
-    tc::InferResult* result;
-    std::unique_ptr<tc::InferResult> result_ptr;
+RequestTemplate TritonClient::request_template() const {
+    RequestTemplate request_template;
+    request_template.model_name = model_name_;
+    request_template.model_version = model_version_;
+    request_template.input_name = model_info_.input_name;
+    request_template.input_datatype = model_info_.input_datatype;
+    request_template.input_shape = model_info_.input_shape;
+    request_template.output_names = model_info_.output_names;
+    request_template.batching = model_info_.max_batch_size > 0;
+    return request_template;
+}
+
+PreparedRequestPool& TritonClient::request_pool() {
+    if (!request_pool_) {
+        throw std::runtime_error("Model information has not been retrieved. Call retrieve_model_info() first.");
+    }
+    return *request_pool_;
+}
+
+tc::Error TritonClient::register_system_shared_memory(const std::string& name, const std::string& key, size_t byte_size) {
+    TritonEndpoint& endpoint = primary_endpoint();
     if (protocol_ == ProtocolType::HTTP) {
-        err = client_.httpClient->Infer(&result, options, inputs, outputs);
+        return endpoint.client.httpClient->RegisterSystemSharedMemory(name, key, byte_size);
+    }
+    return endpoint.client.grpcClient->RegisterSystemSharedMemory(name, key, byte_size);
+}
+
+void TritonClient::unregister_system_shared_memory(const std::string& name) {
+    TritonEndpoint& endpoint = primary_endpoint();
+    if (protocol_ == ProtocolType::HTTP) {
+        endpoint.client.httpClient->UnregisterSystemSharedMemory(name);
     } else {
-        err = client_.grpcClient->Infer(&result, options, inputs, outputs);
+        endpoint.client.grpcClient->UnregisterSystemSharedMemory(name);
+    }
+}
+
+bool TritonClient::enable_shared_memory() {
+    if (shm_input_) {
+        return true;
+    }
+    if (endpoints_.size() > 1) {
+        std::cerr << "Shared memory disabled: it needs a single co-located server, but the client has "
+                  << endpoints_.size() << " endpoints. Falling back to network transport." << std::endl;
+        return false;
+    }
+    if (model_info_.input_datatype == "BYTES") {
+        std::cerr << "Shared memory disabled: encoded image inputs have no fixed size. Falling back to network transport."
+                  << std::endl;
+        return false;
+    }
+    constexpr size_t alignment = 64;
+    size_t input_byte_size = element_count(model_info_.input_shape) * datatype_byte_size(model_info_.input_datatype);
+    size_t output_byte_size = 0;
+    std::vector<size_t> offsets;
+    std::vector<size_t> byte_sizes;
+    for (size_t i = 0; i < model_info_.output_names.size(); ++i) {
+        const int64_t count = i < model_info_.output_shapes.size() ? element_count(model_info_.output_shapes[i]) : -1;
+        if (count <= 0) {
+            std::cerr << "Shared memory disabled: output " << model_info_.output_names[i]
+                      << " has no static shape. Falling back to network transport." << std::endl;
+            return false;
+        }
+        offsets.push_back(output_byte_size);
+        byte_sizes.push_back(count * datatype_byte_size(model_info_.output_datatypes[i]));
+        output_byte_size += (byte_sizes.back() + alignment - 1) / alignment * alignment;
+    }
+
+    const std::string suffix = std::to_string(getpid()) + "_" + std::to_string(reinterpret_cast<uintptr_t>(this));
+    const std::string input_name = "yolov10_input_" + suffix;
+    const std::string output_name = "yolov10_output_" + suffix;
+    std::unique_ptr<SharedMemoryRegion> input_region;
+    std::unique_ptr<SharedMemoryRegion> output_region;
+    try {
+        input_region = std::make_unique<SharedMemoryRegion>("/" + input_name, input_byte_size);
+        output_region = std::make_unique<SharedMemoryRegion>("/" + output_name, output_byte_size);
+    } catch (const std::exception& e) {
+        std::cerr << "Shared memory disabled: " << e.what() << ". Falling back to network transport." << std::endl;
+        return false;
+    }
+
+    tc::Error err = register_system_shared_memory(input_name, input_region->key(), input_region->size());
+    if (err.IsOk()) {
+        err = register_system_shared_memory(output_name, output_region->key(), output_region->size());
+        if (!err.IsOk()) {
+            unregister_system_shared_memory(input_name);
+        }
+    }
+    if (!err.IsOk()) {
+        std::cerr << "Shared memory registration failed (is the server on this host?): " << err
+                  << ". Falling back to network transport." << std::endl;
+        return false;
+    }
+
+    shm_input_ = std::move(input_region);
+    shm_output_ = std::move(output_region);
+    shm_input_name_ = input_name;
+    shm_output_name_ = output_name;
+    shm_output_offsets_ = std::move(offsets);
+    shm_output_byte_sizes_ = std::move(byte_sizes);
+    // Bound to the regions once; every shared-memory request reuses it unchanged
+    shm_request_ = std::make_unique<PreparedRequest>(request_template(), 1);
+    shm_request_->bind_shared_memory(shm_input_name_, shm_input_->size(), shm_output_name_, shm_output_offsets_,
+                                     shm_output_byte_sizes_);
+    return true;
+}
+
+void TritonClient::disable_shared_memory() {
+    if (!shm_input_) {
+        return;
     }
+    unregister_system_shared_memory(shm_input_name_);
+    unregister_system_shared_memory(shm_output_name_);
+    shm_request_.reset();
+    shm_input_.reset();
+    shm_output_.reset();
+}
 
+void TritonClient::run_inference_from_shared_memory(InferenceOutput& output, const std::optional<RequestTag>& tag) {
+    if (!shm_input_) {
+        throw std::runtime_error("Shared memory transport is not enabled.");
+    }
+    shm_request_->options().request_id_ = next_request_id(tag);
+    YOLOV10_COUNT(MetricCounter::Requests, 1);
+    tc::Error err;
+    tc::InferResult* result;
+    {
+        YOLOV10_SCOPED_TIMER(MetricStage::Network);
+        err = infer_on(primary_endpoint(), &result, *shm_request_);
+    }
     if (!err.IsOk()) {
+        YOLOV10_COUNT(MetricCounter::Errors, 1);
         std::stringstream err_msg;
         err_msg << "Inference request failed. Error details: " << err;
         throw std::runtime_error(err_msg.str());
     }
-    
-    const auto [infer_results, infer_shapes] =  extract_inference_results(result, inputs[0]->Shape()[0], output_names, model_info_.max_batch_size > 0);
-    result_ptr.reset(result);
-    return std::make_tuple(infer_results, infer_shapes);
+    // Outputs were written by the server straight into the output region
+    YOLOV10_SCOPED_TIMER(MetricStage::Deserialize);
+    output.reset(result, model_info_.output_names, shm_output_->data(), shm_output_offsets_, shm_output_byte_sizes_);
+}
+
+struct AsyncInferRequest {
+    uint64_t frame_id{0};
+    // The Triton client keeps pointers into these until the request completes.
+    std::vector<uint8_t> input_data;
+    PreparedRequestPool::Lease request_objects;
+    InferenceCallback callback;
+    TritonEndpoint* endpoint{nullptr};
+    std::chrono::steady_clock::time_point submit_time;
+};
+
+TritonClient::~TritonClient() {
+    {
+        std::lock_guard<std::mutex> lock(health_mutex_);
+        health_stop_ = true;
+    }
+    health_cv_.notify_all();
+    if (health_thread_.joinable()) {
+        health_thread_.join();
+    }
+    wait_all();
+    {
+        std::unique_lock<std::mutex> lock(hedge_mutex_);
+        hedge_cv_.wait(lock, [this] { return pending_hedges_ == 0; });
+    }
+    disable_shared_memory();
+    if (streaming_) {
+        primary_endpoint().client.grpcClient->StopStream();
+    }
+}
+
+void TritonClient::set_max_in_flight(size_t max_in_flight) {
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    max_in_flight_ = std::max<size_t>(1, max_in_flight);
+    in_flight_cv_.notify_all();
+}
+
+void TritonClient::acquire_in_flight_slot() {
+    std::unique_lock<std::mutex> lock(in_flight_mutex_);
+    in_flight_cv_.wait(lock, [this] { return in_flight_ < max_in_flight_; });
+    ++in_flight_;
+    YOLOV10_GAUGE_ADD(MetricGauge::InFlight, 1);
+}
+
+void TritonClient::release_in_flight_slot() {
+    YOLOV10_GAUGE_ADD(MetricGauge::InFlight, -1);
+    // Notify under the lock: a waiter in ~TritonClient may destroy the condition variable as soon as it sees zero
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    --in_flight_;
+    in_flight_cv_.notify_all();
 }
 
+void TritonClient::wait_all() {
+    std::unique_lock<std::mutex> lock(in_flight_mutex_);
+    in_flight_cv_.wait(lock, [this] { return in_flight_ == 0; });
+}
+
+void TritonClient::enable_streaming() {
+    if (protocol_ != ProtocolType::GRPC) {
+        throw std::runtime_error("Streaming inference is only supported with the gRPC protocol.");
+    }
+    if (streaming_) {
+        return;
+    }
+    if (endpoints_.size() > 1) {
+        throw std::runtime_error("Streaming inference is bound to one server and needs a single endpoint.");
+    }
+    tc::Error err = primary_endpoint().client.grpcClient->StartStream([this](tc::InferResult* result) { on_stream_result(result); });
+    if (!err.IsOk()) {
+        std::stringstream err_msg;
+        err_msg << "Failed to start gRPC inference stream. Error details: " << err;
+        throw std::runtime_error(err_msg.str());
+    }
+    streaming_ = true;
+}
+
+void TritonClient::disable_streaming() {
+    if (!streaming_) {
+        return;
+    }
+    wait_all();
+    primary_endpoint().client.grpcClient->StopStream();
+    streaming_ = false;
+}
+
+void TritonClient::complete_async_request(const std::shared_ptr<AsyncInferRequest>& request, tc::InferResult* result) {
+    InferenceResult inference_result;
+    inference_result.frame_id = request->frame_id;
+    inference_result.output = std::make_shared<InferenceOutput>();
+    YOLOV10_RECORD_LATENCY(MetricStage::Network, std::chrono::steady_clock::now() - request->submit_time);
+    request->endpoint->outstanding.fetch_sub(1, std::memory_order_relaxed);
+    record_endpoint_result(*request->endpoint, request->submit_time, result->RequestStatus().IsOk());
+    try {
+        YOLOV10_SCOPED_TIMER(MetricStage::Deserialize);
+        extract_inference_results(result, request->request_objects->batch_size(), model_info_.output_names,
+                                  model_info_.max_batch_size > 0, *inference_result.output);
+    } catch (...) {
+        YOLOV10_COUNT(MetricCounter::Errors, 1);
+        inference_result.error = std::current_exception();
+    }
+    request->callback(std::move(inference_result));
+    request->request_objects = {}; // back to the pool
+    release_in_flight_slot();
+}
+
+void TritonClient::on_stream_result(tc::InferResult* result) {
+    std::string request_id;
+    result->Id(&request_id);
+    std::shared_ptr<AsyncInferRequest> request;
+    {
+        std::lock_guard<std::mutex> lock(stream_mutex_);
+        auto it = stream_requests_.find(request_id);
+        if (it == stream_requests_.end()) {
+            delete result;
+            return;
+        }
+        request = std::move(it->second);
+        stream_requests_.erase(it);
+    }
+    complete_async_request(request, result);
+}
+
+void TritonClient::run_inference_async(uint64_t frame_id, std::vector<uint8_t> input_data, InferenceCallback callback,
+                                       size_t batch_size, uint32_t request_index) {
+    check_batch_size(batch_size);
+    auto request = std::make_shared<AsyncInferRequest>();
+    request->frame_id = frame_id;
+    request->input_data = std::move(input_data);
+    request->callback = std::move(callback);
+
+    acquire_in_flight_slot();
+    tc::Error err;
+    try {
+        YOLOV10_SCOPED_TIMER(MetricStage::Serialize);
+        request->request_objects = request_pool().acquire(batch_size);
+        request->request_objects->bind_input(request->input_data.data(), request->input_data.size());
+    } catch (...) {
+        release_in_flight_slot();
+        throw;
+    }
+    tc::InferOptions& options = request->request_objects->options();
+    // Also the key that matches streamed responses to their requests; the sequence number keeps it unique
+    options.request_id_ = next_request_id(RequestTag{frame_id, request_index});
+    const auto& inputs = request->request_objects->inputs();
+    const auto& outputs = request->request_objects->outputs();
+    YOLOV10_COUNT(MetricCounter::Requests, 1);
+    request->endpoint = streaming_ ? &primary_endpoint() : &select_endpoint();
+    request->endpoint->outstanding.fetch_add(1, std::memory_order_relaxed);
+    request->submit_time = std::chrono::steady_clock::now();
+
+    if (streaming_) {
+        {
+            std::lock_guard<std::mutex> lock(stream_mutex_);
+            stream_requests_[options.request_id_] = request;
+        }
+        err = primary_endpoint().client.grpcClient->AsyncStreamInfer(options, inputs, outputs);
+        if (!err.IsOk()) {
+            std::lock_guard<std::mutex> lock(stream_mutex_);
+            stream_requests_.erase(options.request_id_);
+        }
+    } else {
+        auto on_complete = [this, request](tc::InferResult* result) { complete_async_request(request, result); };
+        err = async_infer_on(*request->endpoint, on_complete, *request->request_objects);
+    }
+
+    if (!err.IsOk()) {
+        YOLOV10_COUNT(MetricCounter::Errors, 1);
+        request->endpoint->outstanding.fetch_sub(1, std::memory_order_relaxed);
+        record_endpoint_result(*request->endpoint, request->submit_time, false);
+        release_in_flight_slot();
+        std::stringstream err_msg;
+        err_msg << "Asynchronous inference request failed. Error details: " << err;
+        throw std::runtime_error(err_msg.str());
+    }
+}
 
+std::future<InferenceResult> TritonClient::run_inference_async(uint64_t frame_id, std::vector<uint8_t> input_data,
+                                                              size_t batch_size, uint32_t request_index) {
+    auto promise = std::make_shared<std::promise<InferenceResult>>();
+    auto future = promise->get_future();
+    run_inference_async(frame_id, std::move(input_data), [promise](InferenceResult&& result) {
+        if (result.error) {
+            promise->set_exception(result.error);
+        } else {
+            promise->set_value(std::move(result));
+        }
+    }, batch_size, request_index);
+    return future;
+}
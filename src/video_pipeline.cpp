@@ -0,0 +1,457 @@
+#include "video_pipeline.h"
+#include "metrics.h"
+#include <deque>
+#include <stdexcept>
+#include <sstream>
+
+namespace {
+
+constexpr size_t stage_index(PipelineStage stage) {
+    return static_cast<size_t>(stage);
+}
+
+// Spin briefly, then yield, then sleep: keeps hand-off latency low without burning a core when idle.
+class Backoff {
+public:
+    void reset() { count_ = 0; }
+
+    void pause() {
+        if (count_ < 64) {
+            ++count_;
+        } else if (count_ < 128) {
+            ++count_;
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+private:
+    int count_{0};
+};
+
+bool is_device_index(const std::string& source) {
+    return !source.empty() && std::all_of(source.begin(), source.end(), ::isdigit);
+}
+
+} // namespace
+
+VideoPipeline::VideoPipeline(YOLOv10& task, TritonClient& triton_client, const TritonModelInfo& model_info,
+                             const PipelineConfig& config)
+    : task_{task},
+      triton_client_{triton_client},
+      model_info_{model_info},
+      config_{config},
+      capture_queue_{config.queue_capacity},
+      preprocess_queue_{config.queue_capacity},
+      infer_queue_{config.queue_capacity},
+      recycled_buffers_{config.queue_capacity * 2},
+      motion_gate_{config.motion_gate},
+      tracker_{config.tracker} {
+    if (config_.tiling) {
+        tiler_ = std::make_unique<FrameTiler>(task_, model_info_, config_.tiler);
+    }
+    if (config_.trace) {
+        config_.trace->append_meta({{"input_name", model_info_.input_name},
+                                    {"input_width", std::to_string(model_info_.input_width)},
+                                    {"input_height", std::to_string(model_info_.input_height)},
+                                    {"input_datatype", model_info_.input_datatype},
+                                    {"input_format", model_info_.input_format},
+                                    {"max_batch_size", std::to_string(model_info_.max_batch_size)},
+                                    {"tiling", config_.tiling ? "1" : "0"}});
+    }
+}
+
+VideoPipeline::~VideoPipeline() {
+    stop();
+}
+
+void VideoPipeline::open(const std::string& source) {
+    bool opened = is_device_index(source) ? capture_.open(std::stoi(source)) : capture_.open(source);
+    if (!opened || !capture_.isOpened()) {
+        std::stringstream err_msg;
+        err_msg << "Failed to open video source: " << source;
+        throw std::runtime_error(err_msg.str());
+    }
+}
+
+void VideoPipeline::open_replay(std::shared_ptr<const TraceReader> trace) {
+    replay_ = std::move(trace);
+}
+
+void VideoPipeline::start(ResultCallback on_result) {
+    if (!capture_.isOpened() && !replay_) {
+        throw std::runtime_error("Video source is not open. Call open() before start().");
+    }
+    on_result_ = std::move(on_result);
+    start_time_ = std::chrono::steady_clock::now();
+    threads_.emplace_back(&VideoPipeline::run_stage, this, PipelineStage::Capture, &VideoPipeline::capture_loop);
+    threads_.emplace_back(&VideoPipeline::run_stage, this, PipelineStage::Preprocess, &VideoPipeline::preprocess_loop);
+    threads_.emplace_back(&VideoPipeline::run_stage, this, PipelineStage::Infer, &VideoPipeline::infer_loop);
+    threads_.emplace_back(&VideoPipeline::run_stage, this, PipelineStage::Postprocess, &VideoPipeline::postprocess_loop);
+}
+
+void VideoPipeline::stop() {
+    stop_.store(true, std::memory_order_release);
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    threads_.clear();
+    capture_.release();
+}
+
+void VideoPipeline::wait() {
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    threads_.clear();
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+}
+
+bool VideoPipeline::finished() const {
+    return stage_done_[stage_index(PipelineStage::Postprocess)].load(std::memory_order_acquire);
+}
+
+PipelineStats VideoPipeline::stats() const {
+    PipelineStats stats;
+    stats.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+    for (size_t i = 0; i < stage_index(PipelineStage::Count); ++i) {
+        stats.stages[i].frames = stage_frames_[i].load(std::memory_order_relaxed);
+        stats.stages[i].fps = stats.elapsed_seconds > 0.0 ? stats.stages[i].frames / stats.elapsed_seconds : 0.0;
+    }
+    stats.stages[stage_index(PipelineStage::Preprocess)].queue_depth = capture_queue_.size();
+    stats.stages[stage_index(PipelineStage::Infer)].queue_depth = preprocess_queue_.size();
+    stats.stages[stage_index(PipelineStage::Postprocess)].queue_depth = infer_queue_.size();
+    stats.dropped_frames = dropped_frames_.load(std::memory_order_relaxed);
+    stats.skipped_frames = skipped_frames_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void VideoPipeline::run_stage(PipelineStage stage, void (VideoPipeline::*loop)()) {
+    try {
+        (this->*loop)();
+    } catch (...) {
+        YOLOV10_COUNT(MetricCounter::Errors, 1);
+        {
+            std::lock_guard<std::mutex> lock(error_mutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+        stop_.store(true, std::memory_order_release);
+    }
+    stage_done_[stage_index(stage)].store(true, std::memory_order_release);
+}
+
+namespace {
+
+// Blocks until the frame is queued; returns false if the pipeline is stopping.
+bool push_frame(SpscQueue<PipelineFrame>& queue, PipelineFrame&& frame, const std::atomic<bool>& stop) {
+    Backoff backoff;
+    while (!queue.try_push(std::move(frame))) {
+        if (stop.load(std::memory_order_acquire)) {
+            return false;
+        }
+        backoff.pause();
+    }
+    return true;
+}
+
+// Blocks until a frame is available; returns false once the upstream stage is done and drained.
+bool pop_frame(SpscQueue<PipelineFrame>& queue, PipelineFrame& frame, const std::atomic<bool>& upstream_done,
+               const std::atomic<bool>& stop) {
+    Backoff backoff;
+    while (!queue.try_pop(frame)) {
+        if (stop.load(std::memory_order_acquire)) {
+            return false;
+        }
+        if (upstream_done.load(std::memory_order_acquire)) {
+            return queue.try_pop(frame);
+        }
+        backoff.pause();
+    }
+    return true;
+}
+
+} // namespace
+
+bool VideoPipeline::deliver(PipelineFrame&& frame) {
+    stage_frames_[stage_index(PipelineStage::Capture)].fetch_add(1, std::memory_order_relaxed);
+    if (config_.trace) {
+        const cv::Mat& image = frame.frame;
+        config_.trace->append_frame(frame.frame_id, config_.trace->now_ns(), image.cols, image.rows, image.type(),
+                                    image.elemSize(), image.data, image.step);
+    }
+    if (config_.drop_when_full) {
+        if (!capture_queue_.try_push(std::move(frame))) {
+            dropped_frames_.fetch_add(1, std::memory_order_relaxed);
+            YOLOV10_COUNT(MetricCounter::DroppedFrames, 1);
+        }
+        return true;
+    }
+    return push_frame(capture_queue_, std::move(frame), stop_);
+}
+
+void VideoPipeline::capture_loop() {
+    if (replay_) {
+        replay_loop();
+        return;
+    }
+    uint64_t frame_id = 0;
+    while (!stop_.load(std::memory_order_acquire)) {
+        PipelineFrame frame;
+        if (!capture_.read(frame.frame) || frame.frame.empty()) {
+            break;
+        }
+        frame.frame_id = frame_id++;
+        frame.capture_time = std::chrono::steady_clock::now();
+        if (!deliver(std::move(frame))) {
+            break;
+        }
+    }
+}
+
+// Frame k is released at the same offset from the first frame as it was captured, so the
+// downstream stages see the recorded arrival pattern, bursts and stalls included.
+void VideoPipeline::replay_loop() {
+    const std::vector<const TraceRecord*> frames = replay_->records(TraceRecordType::Frame);
+    const auto start = std::chrono::steady_clock::now();
+    const int64_t first_ns = frames.empty() ? 0 : frames.front()->time_ns;
+    for (const TraceRecord* record : frames) {
+        if (stop_.load(std::memory_order_acquire)) {
+            break;
+        }
+        std::this_thread::sleep_until(start + std::chrono::nanoseconds(record->time_ns - first_ns));
+        const TraceFrame recorded = TraceReader::frame(*record);
+        PipelineFrame frame;
+        frame.frame_id = record->frame_id;
+        // Copied out of the read-only mapping; result callbacks draw on the frame
+        frame.frame = cv::Mat(recorded.height, recorded.width, recorded.type, const_cast<uint8_t*>(recorded.data)).clone();
+        frame.capture_time = std::chrono::steady_clock::now();
+        if (!deliver(std::move(frame))) {
+            break;
+        }
+    }
+}
+
+void VideoPipeline::preprocess_loop() {
+    PipelineFrame frame;
+    while (pop_frame(capture_queue_, frame, stage_done_[stage_index(PipelineStage::Capture)], stop_)) {
+        frame.skipped = config_.motion_gating && !motion_gate_.should_infer(frame.frame);
+        if (frame.skipped) {
+            skipped_frames_.fetch_add(1, std::memory_order_relaxed);
+            YOLOV10_COUNT(MetricCounter::SkippedFrames, 1);
+        } else {
+            // Reuse a tensor buffer handed back by the infer stage when one is available.
+            recycled_buffers_.try_pop(frame.input_data);
+            if (tiler_) {
+                frame.tiles = tiler_->grid(frame.frame.size());
+                tiler_->preprocess(frame.frame, *frame.tiles, frame.input_data);
+            } else {
+                task_.preprocess(frame.frame, frame.input_data);
+            }
+            if (config_.trace) {
+                config_.trace->append_input(frame.frame_id, config_.trace->now_ns(), frame.input_data.data(),
+                                            frame.input_data.size(), frame.tiles ? static_cast<uint32_t>(frame.tiles->size()) : 1);
+            }
+        }
+        stage_frames_[stage_index(PipelineStage::Preprocess)].fetch_add(1, std::memory_order_relaxed);
+        if (!push_frame(preprocess_queue_, std::move(frame), stop_)) {
+            break;
+        }
+    }
+}
+
+void VideoPipeline::infer_loop() {
+    if (config_.max_in_flight > 1) {
+        infer_loop_async();
+        return;
+    }
+    PipelineFrame frame;
+    while (pop_frame(preprocess_queue_, frame, stage_done_[stage_index(PipelineStage::Preprocess)], stop_)) {
+        if (frame.skipped) {
+            if (!push_frame(infer_queue_, std::move(frame), stop_)) {
+                break;
+            }
+            continue;
+        }
+        if (frame.tiles) {
+            auto request_inputs = tiler_->split_requests(*frame.tiles, std::move(frame.input_data));
+            for (size_t k = 0; k < request_inputs.size(); ++k) {
+                auto output = std::make_shared<InferenceOutput>();
+                const auto sent = std::chrono::steady_clock::now();
+                triton_client_.run_inference(request_inputs[k], *output, tiler_->request_batch_size(*frame.tiles, k),
+                                             RequestTag{frame.frame_id, static_cast<uint32_t>(k)});
+                if (config_.trace) {
+                    record_output(frame.frame_id, static_cast<uint32_t>(k), std::chrono::steady_clock::now() - sent, *output);
+                }
+                if (triton_client_.shared_memory_enabled()) {
+                    output->detach();
+                }
+                frame.tile_outputs.push_back(std::move(output));
+            }
+            frame.input_data = {};
+        } else {
+            frame.output = std::make_shared<InferenceOutput>();
+            const auto sent = std::chrono::steady_clock::now();
+            triton_client_.run_inference(frame.input_data, *frame.output, 1, RequestTag{frame.frame_id, 0});
+            if (config_.trace) {
+                record_output(frame.frame_id, 0, std::chrono::steady_clock::now() - sent, *frame.output);
+            }
+            if (triton_client_.shared_memory_enabled()) {
+                // The next request reuses the shared output region while this frame is postprocessed
+                frame.output->detach();
+            }
+            recycled_buffers_.try_push(std::move(frame.input_data));
+            frame.input_data = {};
+        }
+        stage_frames_[stage_index(PipelineStage::Infer)].fetch_add(1, std::memory_order_relaxed);
+        if (!push_frame(infer_queue_, std::move(frame), stop_)) {
+            break;
+        }
+    }
+}
+
+// Keeps up to max_in_flight requests outstanding. Completions are forwarded strictly in
+// submission order, so the postprocess stage still sees frames in capture order.
+void VideoPipeline::infer_loop_async() {
+    triton_client_.set_max_in_flight(config_.max_in_flight);
+    const auto& upstream_done = stage_done_[stage_index(PipelineStage::Preprocess)];
+    // A frame is forwarded once all of its requests (one per tile request when tiling) are done
+    std::deque<std::pair<PipelineFrame, std::vector<std::future<InferenceResult>>>> pending;
+    bool upstream_open = true;
+    Backoff backoff;
+    auto all_ready = [](const std::vector<std::future<InferenceResult>>& futures) {
+        return std::all_of(futures.begin(), futures.end(), [](const std::future<InferenceResult>& future) {
+            return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        });
+    };
+
+    while ((upstream_open || !pending.empty()) && !stop_.load(std::memory_order_acquire)) {
+        if (!pending.empty() && all_ready(pending.front().second)) {
+            auto [frame, futures] = std::move(pending.front());
+            pending.pop_front();
+            if (frame.tiles) {
+                for (auto& future : futures) {
+                    frame.tile_outputs.push_back(future.get().output);
+                }
+            } else {
+                InferenceResult result = futures.front().get();
+                frame.output = std::move(result.output);
+                frame.batch_index = result.batch_index;
+            }
+            if (!frame.skipped) {
+                stage_frames_[stage_index(PipelineStage::Infer)].fetch_add(1, std::memory_order_relaxed);
+            }
+            if (!push_frame(infer_queue_, std::move(frame), stop_)) {
+                break;
+            }
+            backoff.reset();
+            continue;
+        }
+
+        if (upstream_open && pending.size() < config_.max_in_flight) {
+            const bool done = upstream_done.load(std::memory_order_acquire);
+            PipelineFrame frame;
+            if (preprocess_queue_.try_pop(frame)) {
+                std::vector<std::future<InferenceResult>> futures;
+                if (frame.skipped) {
+                    // Queued behind the outstanding requests so frames stay in capture order
+                    std::promise<InferenceResult> skipped;
+                    skipped.set_value(InferenceResult{frame.frame_id, nullptr, 0, nullptr});
+                    futures.push_back(skipped.get_future());
+                } else if (frame.tiles) {
+                    auto request_inputs = tiler_->split_requests(*frame.tiles, std::move(frame.input_data));
+                    for (size_t k = 0; k < request_inputs.size(); ++k) {
+                        futures.push_back(submit(frame.frame_id, std::move(request_inputs[k]),
+                                                 tiler_->request_batch_size(*frame.tiles, k), static_cast<uint32_t>(k)));
+                    }
+                } else {
+                    futures.push_back(submit(frame.frame_id, std::move(frame.input_data), 1, 0));
+                }
+                pending.emplace_back(std::move(frame), std::move(futures));
+                backoff.reset();
+                continue;
+            }
+            if (done) {
+                upstream_open = false;
+                continue;
+            }
+        }
+        backoff.pause();
+    }
+    triton_client_.wait_all();
+}
+
+std::future<InferenceResult> VideoPipeline::submit(uint64_t frame_id, std::vector<uint8_t> input_data, size_t batch_size,
+                                                   uint32_t request_index) {
+    if (!config_.trace) {
+        return triton_client_.run_inference_async(frame_id, std::move(input_data), batch_size, request_index);
+    }
+    // The callback form sees the completion time; the future alone would only show when it was collected
+    auto promise = std::make_shared<std::promise<InferenceResult>>();
+    std::future<InferenceResult> future = promise->get_future();
+    const auto sent = std::chrono::steady_clock::now();
+    triton_client_.run_inference_async(
+        frame_id, std::move(input_data),
+        [this, promise, sent, request_index](InferenceResult&& result) {
+            if (result.error) {
+                // Same as the untraced future: the server's error surfaces where the result is collected
+                promise->set_exception(result.error);
+                return;
+            }
+            if (result.output) {
+                record_output(result.frame_id, request_index, std::chrono::steady_clock::now() - sent, *result.output);
+            }
+            promise->set_value(std::move(result));
+        },
+        batch_size, request_index);
+    return future;
+}
+
+void VideoPipeline::record_output(uint64_t frame_id, uint32_t request_index, std::chrono::steady_clock::duration latency,
+                                  const InferenceOutput& output) {
+    std::vector<TraceTensor> tensors;
+    for (size_t i = 0; i < output.size(); ++i) {
+        const TensorShape& shape = output.shape(i);
+        tensors.push_back(TraceTensor{output.name(i), output.datatype(i),
+                                      std::vector<int64_t>(shape.dims.begin(), shape.dims.begin() + shape.rank),
+                                      output.raw_data(i), output.byte_size(i)});
+    }
+    config_.trace->append_output(frame_id, config_.trace->now_ns(), request_index,
+                                 std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count(), tensors);
+}
+
+void VideoPipeline::postprocess_loop() {
+    PipelineFrame frame;
+    while (pop_frame(infer_queue_, frame, stage_done_[stage_index(PipelineStage::Infer)], stop_)) {
+        if (frame.skipped) {
+            frame.detections = tracker_.predict(frame.frame_id);
+        } else {
+            if (frame.tiles) {
+                frame.detections = tiler_->postprocess(*frame.tiles, frame.tile_outputs);
+            } else {
+                frame.detections = task_.postprocess(cv::Size(frame.frame.cols, frame.frame.rows), *frame.output, frame.batch_index);
+            }
+            if (config_.motion_gating) {
+                tracker_.update(frame.detections, frame.frame_id);
+            }
+        }
+        stage_frames_[stage_index(PipelineStage::Postprocess)].fetch_add(1, std::memory_order_relaxed);
+        YOLOV10_COUNT(MetricCounter::Frames, 1);
+        // Sampled once per frame from the consumer side; exact enough for a gauge
+        YOLOV10_GAUGE_SET(MetricGauge::CaptureQueue, capture_queue_.size());
+        YOLOV10_GAUGE_SET(MetricGauge::PreprocessQueue, preprocess_queue_.size());
+        YOLOV10_GAUGE_SET(MetricGauge::InferQueue, infer_queue_.size());
+        if (on_result_) {
+            on_result_(frame);
+        }
+    }
+}
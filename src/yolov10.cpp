@@ -1,7 +1,37 @@
 #include "yolov10.h"
+#include "metrics.h"
+#include "postprocess_kernels.h"
+#include "triton_client.h"
+#include <cmath>
+#include <limits>
+#include <sstream>
 
-YOLOv10::YOLOv10(int input_width, int input_height) 
-    : input_width_(input_width), input_height_(input_height) {}
+namespace {
+
+// The kernels and the encoder take 8-bit BGR; anything else is converted into `scratch`.
+const cv::Mat& as_bgr(const cv::Mat& img, cv::Mat& scratch) {
+    if (img.type() == CV_8UC3) {
+        return img;
+    }
+    if (img.channels() == 1) {
+        cv::cvtColor(img, scratch, cv::COLOR_GRAY2BGR);
+    } else if (img.channels() == 4) {
+        cv::cvtColor(img, scratch, cv::COLOR_BGRA2BGR);
+    } else {
+        img.convertTo(scratch, CV_8UC3);
+    }
+    return scratch;
+}
+
+} // namespace
+
+YOLOv10::YOLOv10(int input_width, int input_height, const std::string& input_format, const std::string& input_datatype)
+    : input_width_(input_width), input_height_(input_height),
+      encoded_input_(input_datatype == "BYTES"),
+      preprocess_kernel_(encoded_input_ ? nullptr : select_preprocess_kernel(input_format, input_datatype)),
+      input_byte_size_(encoded_input_ ? 0 : static_cast<size_t>(input_width) * input_height * 3 * (input_datatype == "UINT8" ? 1 : sizeof(float))) {
+    set_postprocess_config(PostprocessConfig{});
+}
 
 std::vector<std::string> YOLOv10::read_label_names(const std::string& file_name) {
     std::vector<std::string> classes;
@@ -15,69 +45,259 @@ std::vector<std::string> YOLOv10::read_label_names(const std::string& file_name)
     return classes;
 }
 
-std::vector<Detection> YOLOv10::postprocess(const cv::Size& frame_size, 
-                                             std::vector<std::vector<float>>& infer_results, 
-                                             const std::vector<std::vector<int64_t>>& infer_shapes) {
-    std::vector<Detection> detections;
-    const float confidence_threshold = 0.1f; 
-    const auto infer_shape = infer_shapes.front();
-    const auto infer_result = infer_results.front();
+void DetectionBatch::clear() {
+    for (auto* field : {&x1, &y1, &x2, &y2, &score}) {
+        field->clear();
+    }
+    class_id.clear();
+    frame_index.clear();
+}
+
+void DetectionBatch::reserve(size_t count) {
+    for (auto* field : {&x1, &y1, &x2, &y2, &score}) {
+        field->reserve(count);
+    }
+    class_id.reserve(count);
+    frame_index.reserve(count);
+}
 
-    int rows = infer_shape[1]; // Assuming this is the number of detections
+Detection DetectionBatch::detection(size_t i) const {
+    return Detection{Box{x1[i], y1[i], x2[i], y2[i]}, class_id[i], score[i]};
+}
 
-    for (int i = 0; i < rows; ++i) {
-        if (i * infer_shape[2] + 4 >= infer_result.size()) {
-            break;
+void YOLOv10::set_postprocess_config(const PostprocessConfig& config) {
+    int class_count = 0;
+    auto track_class = [&](int class_id) {
+        if (class_id < 0) {
+            std::stringstream err_msg;
+            err_msg << "Invalid class id in postprocess config: " << class_id;
+            throw std::runtime_error(err_msg.str());
         }
+        class_count = std::max(class_count, class_id + 1);
+    };
+    for (const auto& [class_id, threshold] : config.class_thresholds) {
+        track_class(class_id);
+    }
+    for (int class_id : config.allowed_classes) {
+        track_class(class_id);
+    }
 
-        float score = infer_result[i * infer_shape[2] + 4];
-        if (score >= confidence_threshold) {
-            Detection detection;
-            detection.class_id = static_cast<int>(infer_result[i * infer_shape[2] + 5]);
-            detection.class_confidence = score;
+    constexpr float filtered = std::numeric_limits<float>::infinity();
+    const bool filter_classes = !config.allowed_classes.empty();
+    class_thresholds_.assign(class_count, filter_classes ? filtered : config.confidence_threshold);
+    for (int class_id : config.allowed_classes) {
+        class_thresholds_[class_id] = config.confidence_threshold;
+    }
+    for (const auto& [class_id, threshold] : config.class_thresholds) {
+        if (!filter_classes || class_thresholds_[class_id] != filtered) {
+            class_thresholds_[class_id] = threshold;
+        }
+    }
+    default_threshold_ = filter_classes ? filtered : config.confidence_threshold;
+    min_threshold_ = default_threshold_;
+    for (float threshold : class_thresholds_) {
+        min_threshold_ = std::min(min_threshold_, threshold);
+    }
+    postprocess_config_ = config;
+}
 
-            float r_w = static_cast<float>(frame_size.width) / input_width_;
-            float r_h = static_cast<float>(frame_size.height) / input_height_;
+size_t YOLOv10::select_detections(const float* data, int64_t rows, int64_t cols) {
+    if (cols < 6) {
+        std::stringstream err_msg;
+        err_msg << "Expected detections with at least 6 values per row, got " << cols << ".";
+        throw std::runtime_error(err_msg.str());
+    }
+    selected_.resize(static_cast<size_t>(rows));
+    if (rows == 0 || std::isinf(min_threshold_)) {
+        return 0;
+    }
+    // Vectorized pass on the loosest threshold, then the exact per-class check on the few survivors
+    const size_t candidates = select_score_candidates(data, static_cast<size_t>(rows), static_cast<size_t>(cols), 4,
+                                                      min_threshold_, selected_.data());
+    const int class_count = static_cast<int>(class_thresholds_.size());
+    size_t count = 0;
+    for (size_t i = 0; i < candidates; ++i) {
+        const float* row = data + static_cast<size_t>(selected_[i]) * cols;
+        const int class_id = static_cast<int>(row[5]);
+        const float threshold = class_id >= 0 && class_id < class_count ? class_thresholds_[class_id] : default_threshold_;
+        if (row[4] >= threshold) {
+            selected_[count++] = selected_[i];
+        }
+    }
 
-            detection.bbox.x1 = infer_result[i * infer_shape[2] + 0] * r_w;
-            detection.bbox.y1 = infer_result[i * infer_shape[2] + 1] * r_h;
-            detection.bbox.x2 = infer_result[i * infer_shape[2] + 2] * r_w;
-            detection.bbox.y2 = infer_result[i * infer_shape[2] + 3] * r_h;
+    const size_t max_detections = postprocess_config_.max_detections;
+    if (max_detections > 0 && count > max_detections) {
+        auto by_score = [&](uint32_t a, uint32_t b) {
+            const float score_a = data[static_cast<size_t>(a) * cols + 4];
+            const float score_b = data[static_cast<size_t>(b) * cols + 4];
+            return score_a > score_b || (score_a == score_b && a < b);
+        };
+        std::partial_sort(selected_.begin(), selected_.begin() + max_detections, selected_.begin() + count, by_score);
+        count = max_detections;
+    }
+    return count;
+}
 
-            detections.emplace_back(detection);
-        }
+template <typename Emit>
+void YOLOv10::decode(const cv::Size& frame_size, const float* data, int64_t rows, int64_t cols, Emit&& emit) {
+    YOLOV10_SCOPED_TIMER(MetricStage::Postprocess);
+    const size_t count = select_detections(data, rows, cols);
+    // Undo the preprocessing resize (and letterbox padding) to get frame coordinates
+    const ResizeGeometry geometry = resize_geometry(frame_size);
+    const float pad_x = static_cast<float>(geometry.pad_x);
+    const float pad_y = static_cast<float>(geometry.pad_y);
+    const float inv_scale_x = 1.f / geometry.scale_x;
+    const float inv_scale_y = 1.f / geometry.scale_y;
+    const float max_x = static_cast<float>(frame_size.width);
+    const float max_y = static_cast<float>(frame_size.height);
+    for (size_t i = 0; i < count; ++i) {
+        const float* row = data + static_cast<size_t>(selected_[i]) * cols;
+        Detection detection;
+        detection.bbox.x1 = std::clamp((row[0] - pad_x) * inv_scale_x, 0.f, max_x);
+        detection.bbox.y1 = std::clamp((row[1] - pad_y) * inv_scale_y, 0.f, max_y);
+        detection.bbox.x2 = std::clamp((row[2] - pad_x) * inv_scale_x, 0.f, max_x);
+        detection.bbox.y2 = std::clamp((row[3] - pad_y) * inv_scale_y, 0.f, max_y);
+        detection.class_id = static_cast<int>(row[5]);
+        detection.class_confidence = row[4];
+        emit(detection);
     }
-    return detections; 
 }
 
-std::vector<uint8_t> YOLOv10::preprocess(const cv::Mat& img, const std::string& format, 
-                                          int img_type1, int img_type3,
-                                          size_t img_channels, const cv::Size& img_size) {
-    std::vector<uint8_t> input_data;
-    cv::Mat sample;
-    
-    cv::cvtColor(img, sample, cv::COLOR_BGR2RGB); // Convert BGR to RGB
-    sample.convertTo(sample, (img_channels == 3) ? img_type3 : img_type1);
-    cv::resize(sample, sample, cv::Size(input_width_, input_height_));
-    sample.convertTo(sample, CV_32FC3, 1.f / 255.f); // Normalize to [0, 1]
+const float* YOLOv10::fp32_rows(const TensorView<Float16>& frame_output) {
+    fp16_scratch_.resize(frame_output.size());
+    convert_fp16_to_fp32(reinterpret_cast<const uint16_t*>(frame_output.data), fp16_scratch_.data(), frame_output.size());
+    return fp16_scratch_.data();
+}
 
-    size_t img_byte_size = sample.total() * sample.elemSize();
-    input_data.resize(img_byte_size);
+std::vector<Detection> YOLOv10::postprocess(const cv::Size& frame_size, const TensorView<float>& output, size_t batch_index) {
+    std::vector<Detection> detections;
+    const TensorView<float> infer_result = output.slice(batch_index);
+    decode(frame_size, infer_result.data, infer_result.shape[1], infer_result.shape[2],
+           [&](const Detection& detection) { detections.push_back(detection); });
+    return detections;
+}
+
+std::vector<Detection> YOLOv10::postprocess(const cv::Size& frame_size, const TensorView<Float16>& output, size_t batch_index) {
+    std::vector<Detection> detections;
+    const TensorView<Float16> infer_result = output.slice(batch_index);
+    decode(frame_size, fp32_rows(infer_result), infer_result.shape[1], infer_result.shape[2],
+           [&](const Detection& detection) { detections.push_back(detection); });
+    return detections;
+}
+
+std::vector<Detection> YOLOv10::postprocess(const cv::Size& frame_size, const InferenceOutput& output, size_t batch_index) {
+    if (output.datatype(0) == "FP16") {
+        return postprocess(frame_size, output.view<Float16>(0), batch_index);
+    }
+    return postprocess(frame_size, output.view<float>(0), batch_index);
+}
+
+void YOLOv10::postprocess(const cv::Size& frame_size, const InferenceOutput& output, size_t batch_index,
+                          DetectionBatch& detections) {
+    auto append = [&](const Detection& detection) {
+        detections.x1.push_back(detection.bbox.x1);
+        detections.y1.push_back(detection.bbox.y1);
+        detections.x2.push_back(detection.bbox.x2);
+        detections.y2.push_back(detection.bbox.y2);
+        detections.score.push_back(detection.class_confidence);
+        detections.class_id.push_back(detection.class_id);
+        detections.frame_index.push_back(static_cast<uint32_t>(batch_index));
+    };
+    if (output.datatype(0) == "FP16") {
+        const TensorView<Float16> infer_result = output.view<Float16>(0).slice(batch_index);
+        decode(frame_size, fp32_rows(infer_result), infer_result.shape[1], infer_result.shape[2], append);
+    } else {
+        const TensorView<float> infer_result = output.view<float>(0).slice(batch_index);
+        decode(frame_size, infer_result.data, infer_result.shape[1], infer_result.shape[2], append);
+    }
+}
+
+std::vector<std::vector<Detection>> YOLOv10::postprocess_batch(const std::vector<cv::Size>& frame_sizes,
+                                                               const TensorView<float>& output) {
+    std::vector<std::vector<Detection>> batch_detections;
+    batch_detections.reserve(frame_sizes.size());
+    for (size_t i = 0; i < frame_sizes.size(); ++i) {
+        batch_detections.push_back(postprocess(frame_sizes[i], output, i));
+    }
+    return batch_detections;
+}
+
+void YOLOv10::postprocess_batch(const std::vector<cv::Size>& frame_sizes, const InferenceOutput& output,
+                                DetectionBatch& detections) {
+    detections.clear();
+    for (size_t i = 0; i < frame_sizes.size(); ++i) {
+        postprocess(frame_sizes[i], output, i, detections);
+    }
+}
+
+void YOLOv10::set_resize_mode(ResizeMode mode) {
+    if (mode != resize_mode_) {
+        resize_mode_ = mode;
+        resize_tables_.clear();
+    }
+}
 
-    std::vector<cv::Mat> input_channels;
-    size_t pos = 0;
+ResizeGeometry YOLOv10::resize_geometry(const cv::Size& frame_size) const {
+    return compute_resize_geometry(frame_size, cv::Size(input_width_, input_height_), resize_mode_);
+}
 
-    for (size_t i = 0; i < img_channels; ++i) {
-        input_channels.emplace_back(img_size.height, img_size.width, img_type1, &input_data[pos]);
-        pos += input_channels.back().total() * input_channels.back().elemSize();
+const ResizeTable& YOLOv10::resize_table(const cv::Size& frame_size) {
+    constexpr size_t max_cached_tables = 16;
+    const uint64_t key = (static_cast<uint64_t>(frame_size.width) << 32) | static_cast<uint32_t>(frame_size.height);
+    auto it = resize_tables_.find(key);
+    if (it == resize_tables_.end()) {
+        if (resize_tables_.size() >= max_cached_tables) {
+            resize_tables_.clear();
+        }
+        it = resize_tables_.emplace(key, build_resize_table(frame_size, cv::Size(input_width_, input_height_), resize_mode_)).first;
     }
+    return it->second;
+}
 
-    cv::split(sample, input_channels);
+void YOLOv10::preprocess(const cv::Mat& img, uint8_t* dst) {
+    if (encoded_input_) {
+        throw std::runtime_error("Encoded input varies in size per frame; preprocess into a std::vector instead.");
+    }
+    YOLOV10_SCOPED_TIMER(MetricStage::Preprocess);
+    cv::Mat converted;
+    const cv::Mat& bgr = as_bgr(img, converted);
+    preprocess_kernel_(bgr, resize_table(bgr.size()), dst);
+}
 
-    if (pos != img_byte_size) {
-        std::cerr << "Unexpected total size of channels: " << pos << ", expecting " << img_byte_size << std::endl;
-        exit(1);
+// Resized to the network input here, so the server only decodes and the JPEG is a fraction of
+// the source frame; boxes map back through the same resize_geometry as tensor input.
+void YOLOv10::encode(const cv::Mat& img, std::vector<uint8_t>& input_data) {
+    YOLOV10_SCOPED_TIMER(MetricStage::Preprocess);
+    cv::Mat converted;
+    const cv::Mat& bgr = as_bgr(img, converted);
+    const ResizeGeometry geometry = resize_geometry(bgr.size());
+    cv::Mat content;
+    cv::resize(bgr, content, cv::Size(geometry.content_width, geometry.content_height), 0, 0, cv::INTER_LINEAR);
+    if (content.size() == geometry.dst_size) {
+        resized_ = content;
+    } else {
+        cv::copyMakeBorder(content, resized_, geometry.pad_y, geometry.dst_size.height - geometry.content_height - geometry.pad_y,
+                           geometry.pad_x, geometry.dst_size.width - geometry.content_width - geometry.pad_x,
+                           cv::BORDER_CONSTANT, cv::Scalar::all(kLetterboxPadValue));
+    }
+    if (!cv::imencode(".jpg", resized_, encoded_, {cv::IMWRITE_JPEG_QUALITY, jpeg_quality_})) {
+        throw std::runtime_error("Failed to JPEG-encode the frame.");
     }
+    input_data.clear();
+    append_bytes_element(input_data, encoded_.data(), encoded_.size());
+}
 
+void YOLOv10::preprocess(const cv::Mat& img, std::vector<uint8_t>& input_data) {
+    if (encoded_input_) {
+        encode(img, input_data);
+        return;
+    }
+    input_data.resize(input_byte_size_);
+    preprocess(img, input_data.data());
+}
+
+std::vector<uint8_t> YOLOv10::preprocess(const cv::Mat& img) {
+    std::vector<uint8_t> input_data;
+    preprocess(img, input_data);
     return input_data;
 }
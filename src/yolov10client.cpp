@@ -0,0 +1,218 @@
+#include "yolov10client.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "daemon_protocol.h"
+#include "model_info_cache.h"
+#include "triton_client.h"
+#include "yolov10.h"
+
+namespace yolov10 {
+
+struct Client::Impl {
+    std::unique_ptr<TritonClient> triton_client;
+    TritonModelInfo model_info;
+    std::unique_ptr<YOLOv10> task;
+    std::string model;
+    std::mutex mutex;
+    std::vector<uint8_t> input_data;
+};
+
+Client::Client(const ClientOptions& options) : impl_{std::make_unique<Impl>()} {
+    if (options.servers.empty()) {
+        throw std::runtime_error("No inference server given.");
+    }
+    impl_->model = options.model;
+    impl_->triton_client = std::make_unique<TritonClient>(options.servers, options.http ? ProtocolType::HTTP : ProtocolType::GRPC,
+                                                          options.model);
+    if (options.model_cache) {
+        impl_->triton_client->set_model_info_cache(std::make_shared<ModelInfoCache>());
+    }
+    impl_->triton_client->initialize_triton_client();
+    impl_->model_info = impl_->triton_client->retrieve_model_info(options.model, {1, 3, 640, 640});
+    if (options.warmup_requests > 0) {
+        impl_->triton_client->warm_up(options.warmup_requests);
+    }
+    const TritonModelInfo& info = impl_->model_info;
+    impl_->task = std::make_unique<YOLOv10>(info.input_width, info.input_height, info.input_format, info.input_datatype);
+    if (options.letterbox) {
+        impl_->task->set_resize_mode(ResizeMode::Letterbox);
+    }
+    PostprocessConfig postprocess;
+    postprocess.confidence_threshold = options.confidence_threshold;
+    postprocess.max_detections = options.max_detections;
+    impl_->task->set_postprocess_config(postprocess);
+}
+
+Client::~Client() = default;
+Client::Client(Client&&) noexcept = default;
+Client& Client::operator=(Client&&) noexcept = default;
+
+std::vector<Detection> Client::detect(const ImageView& image) {
+    if (!image.data || image.size == 0) {
+        throw std::runtime_error("Empty image.");
+    }
+    cv::Mat frame;
+    if (image.format == ImageFormat::Encoded) {
+        frame = cv::imdecode(cv::Mat(1, static_cast<int>(image.size), CV_8UC1, const_cast<uint8_t*>(image.data)), cv::IMREAD_COLOR);
+        if (frame.empty()) {
+            throw std::runtime_error("Failed to decode image.");
+        }
+    } else {
+        const size_t row_bytes = static_cast<size_t>(std::max(image.width, 0)) * 3;
+        const size_t stride = image.stride > 0 ? image.stride : row_bytes;
+        // Divides instead of multiplying stride by height, which a hostile caller could overflow
+        if (image.width <= 0 || image.height <= 0 || stride < row_bytes || image.size < row_bytes ||
+            static_cast<size_t>(image.height - 1) > (image.size - row_bytes) / stride) {
+            std::stringstream err_msg;
+            err_msg << "A " << image.width << "x" << image.height << " BGR image with stride " << stride
+                    << " does not fit in " << image.size << " bytes.";
+            throw std::runtime_error(err_msg.str());
+        }
+        // Wraps the caller's pixels; preprocessing reads them in place
+        frame = cv::Mat(image.height, image.width, CV_8UC3, const_cast<uint8_t*>(image.data), stride);
+    }
+
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->task->preprocess(frame, impl_->input_data);
+    InferenceOutput output;
+    impl_->triton_client->run_inference(impl_->input_data, output);
+    std::vector<Detection> detections;
+    for (const ::Detection& detection : impl_->task->postprocess(frame.size(), output)) {
+        detections.push_back(Detection{detection.bbox.x1, detection.bbox.y1, detection.bbox.x2, detection.bbox.y2,
+                                       detection.class_confidence, detection.class_id});
+    }
+    return detections;
+}
+
+const std::string& Client::model() const {
+    return impl_->model;
+}
+
+int Client::input_width() const {
+    return impl_->model_info.input_width;
+}
+
+int Client::input_height() const {
+    return impl_->model_info.input_height;
+}
+
+DaemonConnection::DaemonConnection(const std::string& socket_path) {
+    sockaddr_un address{};
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        std::stringstream err_msg;
+        err_msg << "Socket path is too long: " << socket_path;
+        throw std::runtime_error(err_msg.str());
+    }
+    socket_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (socket_ == -1) {
+        std::stringstream err_msg;
+        err_msg << "Failed to create socket: " << std::strerror(errno);
+        throw std::runtime_error(err_msg.str());
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+    if (connect(socket_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1) {
+        std::stringstream err_msg;
+        err_msg << "Failed to connect to yolov10d at " << socket_path << ": " << std::strerror(errno);
+        close(socket_);
+        socket_ = -1;
+        throw std::runtime_error(err_msg.str());
+    }
+}
+
+DaemonConnection::~DaemonConnection() {
+    if (socket_ != -1) {
+        close(socket_);
+    }
+}
+
+DaemonConnection::DaemonConnection(DaemonConnection&& other) noexcept : socket_{other.socket_} {
+    other.socket_ = -1;
+}
+
+DaemonConnection& DaemonConnection::operator=(DaemonConnection&& other) noexcept {
+    if (this != &other) {
+        if (socket_ != -1) {
+            close(socket_);
+        }
+        socket_ = other.socket_;
+        other.socket_ = -1;
+    }
+    return *this;
+}
+
+std::string DaemonConnection::default_socket_path() {
+    const char* path = std::getenv("YOLOV10_DAEMON_SOCKET");
+    return path && *path ? path : "/tmp/yolov10d.sock";
+}
+
+std::vector<Detection> DaemonConnection::detect_fd(int fd, uint64_t offset, const ImageView& image) {
+    if (fd < 0) {
+        throw std::runtime_error("Invalid image descriptor.");
+    }
+    return request(fd, offset, image);
+}
+
+std::vector<Detection> DaemonConnection::detect(const ImageView& image) {
+    if (image.size > kDaemonMaxInlineBytes) {
+        std::stringstream err_msg;
+        err_msg << "Inline images are limited to " << kDaemonMaxInlineBytes << " bytes; pass a descriptor instead.";
+        throw std::runtime_error(err_msg.str());
+    }
+    return request(-1, 0, image);
+}
+
+std::vector<Detection> DaemonConnection::request(int fd, uint64_t offset, const ImageView& image) {
+    if (socket_ == -1) {
+        throw std::runtime_error("Daemon connection is closed.");
+    }
+    DaemonRequest header{};
+    header.magic = kDaemonRequestMagic;
+    header.version = kDaemonProtocolVersion;
+    header.format = static_cast<uint32_t>(image.format);
+    header.has_fd = fd >= 0 ? 1 : 0;
+    header.width = image.width;
+    header.height = image.height;
+    header.stride = image.stride;
+    header.offset = offset;
+    header.size = image.size;
+    DaemonResponse response{};
+    std::string error;
+    std::vector<Detection> detections;
+    try {
+        send_message(socket_, &header, sizeof(header), fd >= 0 ? nullptr : image.data, fd >= 0 ? 0 : image.size, fd);
+        if (!receive_exact(socket_, &response, sizeof(response))) {
+            throw std::runtime_error("yolov10d closed the connection.");
+        }
+        if (response.magic != kDaemonResponseMagic || response.count > kDaemonMaxDetections ||
+            response.error_length > kDaemonMaxErrorBytes) {
+            throw std::runtime_error("Malformed response from yolov10d.");
+        }
+        error.resize(response.error_length);
+        detections.resize(response.count);
+        // Closing before the body (false from a non-empty read) must not pass zero-filled detections off as a result
+        if ((!error.empty() && !receive_exact(socket_, error.data(), error.size())) ||
+            (!detections.empty() && !receive_exact(socket_, detections.data(), detections.size() * sizeof(Detection)))) {
+            throw std::runtime_error("yolov10d closed the connection.");
+        }
+    } catch (...) {
+        // The stream is at an unknown position; later requests would read garbage
+        close(socket_);
+        socket_ = -1;
+        throw;
+    }
+    if (response.status != 0) {
+        throw std::runtime_error("yolov10d: " + error);
+    }
+    return detections;
+}
+
+} // namespace yolov10
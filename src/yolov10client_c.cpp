@@ -0,0 +1,166 @@
+#include "yolov10client_c.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "yolov10client.h"
+
+struct yolov10_client {
+    yolov10::Client client;
+    std::string last_error;
+};
+
+struct yolov10_daemon_connection {
+    yolov10::DaemonConnection connection;
+    std::string last_error;
+};
+
+static_assert(sizeof(yolov10_detection) == sizeof(yolov10::Detection), "C and C++ detections must match");
+
+namespace {
+
+void copy_error(const char* message, char* error, size_t error_size) {
+    if (error && error_size > 0) {
+        std::strncpy(error, message, error_size - 1);
+        error[error_size - 1] = '\0';
+    }
+}
+
+yolov10::ImageView image_view(const yolov10_image& image) {
+    yolov10::ImageView view;
+    view.data = image.data;
+    view.size = image.size;
+    view.format = image.format == YOLOV10_IMAGE_ENCODED ? yolov10::ImageFormat::Encoded : yolov10::ImageFormat::Bgr;
+    view.width = image.width;
+    view.height = image.height;
+    view.stride = image.stride;
+    return view;
+}
+
+void copy_detections(const std::vector<yolov10::Detection>& found, yolov10_detection* detections, size_t capacity,
+                     size_t* count) {
+    const size_t copied = detections ? std::min(capacity, found.size()) : 0;
+    if (copied > 0) {
+        std::memcpy(detections, found.data(), copied * sizeof(yolov10_detection));
+    }
+    if (count) {
+        *count = found.size();
+    }
+}
+
+// Runs `body`, turning exceptions into -1 and the handle's last error.
+template <typename Handle, typename Body>
+int guarded(Handle* handle, Body&& body) {
+    if (!handle) {
+        return -1;
+    }
+    try {
+        handle->last_error.clear();
+        body();
+        return 0;
+    } catch (const std::exception& e) {
+        handle->last_error = e.what();
+    } catch (...) {
+        handle->last_error = "unknown error";
+    }
+    return -1;
+}
+
+} // namespace
+
+extern "C" {
+
+void yolov10_client_options_init(yolov10_client_options* options) {
+    if (!options) {
+        return;
+    }
+    options->servers = "localhost:8001";
+    options->use_http = 0;
+    options->model = "yolov10m";
+    options->confidence_threshold = 0.1f;
+    options->max_detections = 0;
+    options->letterbox = 0;
+    options->warmup_requests = 0;
+}
+
+yolov10_client* yolov10_client_create(const yolov10_client_options* options, char* error, size_t error_size) {
+    yolov10_client_options defaults;
+    yolov10_client_options_init(&defaults);
+    const yolov10_client_options& o = options ? *options : defaults;
+    try {
+        yolov10::ClientOptions client_options;
+        client_options.servers.clear();
+        const std::string servers = o.servers ? o.servers : defaults.servers;
+        size_t start = 0;
+        while (start <= servers.size()) {
+            const size_t end = std::min(servers.find(',', start), servers.size());
+            if (end > start) {
+                client_options.servers.push_back(servers.substr(start, end - start));
+            }
+            start = end + 1;
+        }
+        client_options.http = o.use_http != 0;
+        client_options.model = o.model ? o.model : defaults.model;
+        client_options.confidence_threshold = o.confidence_threshold;
+        client_options.max_detections = o.max_detections;
+        client_options.letterbox = o.letterbox != 0;
+        client_options.warmup_requests = o.warmup_requests;
+        return new yolov10_client{yolov10::Client(client_options), std::string()};
+    } catch (const std::exception& e) {
+        copy_error(e.what(), error, error_size);
+    } catch (...) {
+        copy_error("unknown error", error, error_size);
+    }
+    return nullptr;
+}
+
+void yolov10_client_destroy(yolov10_client* client) {
+    delete client;
+}
+
+int yolov10_client_detect(yolov10_client* client, const yolov10_image* image, yolov10_detection* detections,
+                          size_t capacity, size_t* count) {
+    return guarded(client, [&] {
+        if (!image) {
+            throw std::runtime_error("No image given.");
+        }
+        copy_detections(client->client.detect(image_view(*image)), detections, capacity, count);
+    });
+}
+
+yolov10_daemon_connection* yolov10_daemon_connect(const char* socket_path, char* error, size_t error_size) {
+    try {
+        const std::string path = socket_path ? socket_path : yolov10::DaemonConnection::default_socket_path();
+        return new yolov10_daemon_connection{yolov10::DaemonConnection(path), std::string()};
+    } catch (const std::exception& e) {
+        copy_error(e.what(), error, error_size);
+    } catch (...) {
+        copy_error("unknown error", error, error_size);
+    }
+    return nullptr;
+}
+
+void yolov10_daemon_close(yolov10_daemon_connection* connection) {
+    delete connection;
+}
+
+int yolov10_daemon_detect(yolov10_daemon_connection* connection, int fd, uint64_t offset, const yolov10_image* image,
+                          yolov10_detection* detections, size_t capacity, size_t* count) {
+    return guarded(connection, [&] {
+        if (!image) {
+            throw std::runtime_error("No image given.");
+        }
+        const yolov10::ImageView view = image_view(*image);
+        copy_detections(fd >= 0 ? connection->connection.detect_fd(fd, offset, view) : connection->connection.detect(view),
+                        detections, capacity, count);
+    });
+}
+
+const char* yolov10_client_last_error(const yolov10_client* client) {
+    return client ? client->last_error.c_str() : "no client";
+}
+
+const char* yolov10_daemon_last_error(const yolov10_daemon_connection* connection) {
+    return connection ? connection->last_error.c_str() : "no connection";
+}
+
+} // extern "C"
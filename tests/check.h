@@ -0,0 +1,63 @@
+#pragma once
+// Minimal assertions for the unit tests, so they build without a test framework. A failed check
+// prints where it failed and the test keeps going; main() returns check_result().
+#include <cmath>
+#include <exception>
+#include <iostream>
+
+inline int& check_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline int check_result() {
+    if (check_failures() != 0) {
+        std::cerr << check_failures() << " check(s) failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+#define CHECK(condition)                                                                        \
+    do {                                                                                        \
+        if (!(condition)) {                                                                     \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed" << std::endl; \
+            ++check_failures();                                                                 \
+        }                                                                                       \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                                  \
+    do {                                                                                            \
+        const auto& check_actual = (actual);                                                        \
+        const auto& check_expected = (expected);                                                    \
+        if (!(check_actual == check_expected)) {                                                    \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ(" #actual ", " #expected ") failed: " \
+                      << check_actual << " != " << check_expected << std::endl;                     \
+            ++check_failures();                                                                     \
+        }                                                                                           \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance)                                                     \
+    do {                                                                                            \
+        const double check_actual = (actual);                                                       \
+        const double check_expected = (expected);                                                   \
+        if (std::fabs(check_actual - check_expected) > (tolerance)) {                               \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_NEAR(" #actual ", " #expected ") failed: " \
+                      << check_actual << " != " << check_expected << std::endl;                     \
+            ++check_failures();                                                                     \
+        }                                                                                           \
+    } while (0)
+
+#define CHECK_THROWS(statement)                                                                 \
+    do {                                                                                        \
+        bool check_threw = false;                                                               \
+        try {                                                                                   \
+            statement;                                                                          \
+        } catch (const std::exception&) {                                                       \
+            check_threw = true;                                                                 \
+        }                                                                                       \
+        if (!check_threw) {                                                                     \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": " #statement " did not throw" << std::endl; \
+            ++check_failures();                                                                 \
+        }                                                                                       \
+    } while (0)
@@ -0,0 +1,115 @@
+#include "spsc_queue.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include "check.h"
+
+namespace {
+
+void test_capacity_rounding() {
+    CHECK_EQ(SpscQueue<int>(0).capacity(), size_t{2});
+    CHECK_EQ(SpscQueue<int>(3).capacity(), size_t{4});
+    CHECK_EQ(SpscQueue<int>(8).capacity(), size_t{8});
+}
+
+void test_full_and_empty() {
+    SpscQueue<int> queue(4);
+    int value = 0;
+    CHECK(queue.empty());
+    CHECK(!queue.try_pop(value));
+    for (int i = 0; i < 4; ++i) {
+        CHECK(queue.try_push(int{i}));
+        CHECK_EQ(queue.size(), static_cast<size_t>(i + 1));
+    }
+    CHECK(!queue.try_push(4));
+    CHECK_EQ(queue.size(), size_t{4});
+    for (int i = 0; i < 4; ++i) {
+        CHECK(queue.try_pop(value));
+        CHECK_EQ(value, i);
+    }
+    CHECK(queue.empty());
+}
+
+// The indices run far past the capacity, so every slot is reused many times
+void test_wraparound() {
+    SpscQueue<int> queue(4);
+    int next_push = 0;
+    int next_pop = 0;
+    for (int round = 0; round < 100; ++round) {
+        const int pushes = 1 + round % 4;
+        for (int i = 0; i < pushes; ++i) {
+            CHECK(queue.try_push(int{next_push++}));
+        }
+        CHECK_EQ(queue.size(), static_cast<size_t>(pushes));
+        int value = -1;
+        for (int i = 0; i < pushes; ++i) {
+            CHECK(queue.try_pop(value));
+            CHECK_EQ(value, next_pop++);
+        }
+        CHECK(queue.empty());
+    }
+    // Leave the ring partly full across the wrap point
+    for (int i = 0; i < 3; ++i) {
+        CHECK(queue.try_push(int{next_push++}));
+    }
+    int value = -1;
+    CHECK(queue.try_pop(value));
+    CHECK_EQ(value, next_pop++);
+    CHECK(queue.try_push(int{next_push++}));
+    CHECK(queue.try_push(int{next_push++}));
+    CHECK_EQ(queue.size(), size_t{4});
+    CHECK(!queue.try_push(0));
+}
+
+// size() is read from a third thread while both sides run; it must never exceed the capacity.
+// The loops yield so the test also finishes on a single core.
+void test_concurrent_order_and_size() {
+    constexpr uint64_t kCount = 100000;
+    SpscQueue<uint64_t> queue(16);
+    bool size_ok = true;
+    std::atomic<bool> finished{false};
+    std::thread observer([&] {
+        while (!finished.load(std::memory_order_acquire)) {
+            if (queue.size() > queue.capacity()) {
+                size_ok = false;
+            }
+            std::this_thread::yield();
+        }
+    });
+    std::thread producer([&] {
+        for (uint64_t i = 0; i < kCount;) {
+            if (queue.try_push(uint64_t{i})) {
+                ++i;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    uint64_t expected = 0;
+    bool in_order = true;
+    while (expected < kCount) {
+        uint64_t value = 0;
+        if (queue.try_pop(value)) {
+            in_order = in_order && value == expected;
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    finished.store(true, std::memory_order_release);
+    observer.join();
+    CHECK(in_order);
+    CHECK(size_ok);
+    CHECK(queue.empty());
+}
+
+} // namespace
+
+int main() {
+    test_capacity_rounding();
+    test_full_and_empty();
+    test_wraparound();
+    test_concurrent_order_and_size();
+    return check_result();
+}
@@ -0,0 +1,124 @@
+#include "tiler.h"
+#include "check.h"
+
+namespace {
+
+Detection make_detection(float x1, float y1, float x2, float y2, float score, int class_id = 0) {
+    return Detection{Box{x1, y1, x2, y2}, class_id, score};
+}
+
+// Properties every grid must have: starts at 0, ends at the frame edge, strictly increasing,
+// and neighbours overlap by at least `overlap`.
+void check_origins(int length, int tile, int overlap) {
+    const std::vector<int> origins = tile_origins(length, tile, overlap);
+    CHECK(!origins.empty());
+    if (origins.empty()) {
+        return;
+    }
+    CHECK_EQ(origins.front(), 0);
+    if (length <= tile) {
+        CHECK_EQ(origins.size(), size_t{1});
+        return;
+    }
+    CHECK_EQ(origins.back(), length - tile);
+    for (size_t i = 1; i < origins.size(); ++i) {
+        CHECK(origins[i] > origins[i - 1]);
+        CHECK(origins[i - 1] + tile - origins[i] >= overlap);
+    }
+}
+
+void test_tile_origins() {
+    // Frame no larger than a tile
+    CHECK(tile_origins(640, 640, 96) == std::vector<int>({0}));
+    CHECK(tile_origins(100, 640, 96) == std::vector<int>({0}));
+    // Exactly two tiles overlapping by `overlap`
+    CHECK(tile_origins(1184, 640, 96) == std::vector<int>({0, 544}));
+    // One pixel more needs a third tile, and the three spread evenly
+    CHECK(tile_origins(1185, 640, 96) == std::vector<int>({0, 273, 545}));
+    CHECK(tile_origins(1280, 640, 96) == std::vector<int>({0, 320, 640}));
+    // One pixel past a tile still needs two
+    CHECK(tile_origins(641, 640, 96) == std::vector<int>({0, 1}));
+    // No overlap: tiles just touch
+    CHECK(tile_origins(1280, 640, 0) == std::vector<int>({0, 640}));
+    // An overlap as large as the tile still advances one pixel per tile
+    CHECK(tile_origins(643, 640, 640) == std::vector<int>({0, 1, 2, 3}));
+
+    for (int length : {639, 640, 641, 1000, 1920, 3840, 7680}) {
+        for (int overlap : {0, 32, 96, 320, 639}) {
+            check_origins(length, 640, overlap);
+        }
+    }
+}
+
+void test_same_region_kept() {
+    // The model is NMS-free: overlapping boxes from one region are distinct objects
+    const std::vector<Detection> detections = {make_detection(0, 0, 100, 100, 0.9f), make_detection(10, 10, 100, 100, 0.8f)};
+    for (TileMerge merge : {TileMerge::Nms, TileMerge::WeightedFusion}) {
+        const auto merged = merge_detections(detections, {0, 0}, merge, TileMatch::Iou, 0.5f);
+        CHECK_EQ(merged.size(), size_t{2});
+    }
+}
+
+void test_cross_region_nms() {
+    const std::vector<Detection> detections = {make_detection(10, 10, 110, 110, 0.6f), make_detection(0, 0, 100, 100, 0.9f)};
+    const auto merged = merge_detections(detections, {0, 1}, TileMerge::Nms, TileMatch::Iou, 0.5f);
+    CHECK_EQ(merged.size(), size_t{1});
+    if (merged.size() == 1) {
+        // The best box is kept untouched
+        CHECK_NEAR(merged[0].class_confidence, 0.9f, 1e-6);
+        CHECK_NEAR(merged[0].bbox.x1, 0.f, 1e-6);
+        CHECK_NEAR(merged[0].bbox.x2, 100.f, 1e-6);
+    }
+
+    // Different classes never merge
+    const std::vector<Detection> classes = {make_detection(0, 0, 100, 100, 0.9f, 0), make_detection(0, 0, 100, 100, 0.8f, 1)};
+    CHECK_EQ(merge_detections(classes, {0, 1}, TileMerge::Nms, TileMatch::Iou, 0.5f).size(), size_t{2});
+
+    // A group takes one box per region: the second box from region 1 starts its own group
+    const std::vector<Detection> three = {make_detection(0, 0, 100, 100, 0.9f), make_detection(0, 0, 100, 100, 0.8f),
+                                          make_detection(2, 2, 100, 100, 0.7f)};
+    CHECK_EQ(merge_detections(three, {0, 1, 1}, TileMerge::Nms, TileMatch::Iou, 0.5f).size(), size_t{2});
+}
+
+void test_cross_region_weighted_fusion() {
+    const std::vector<Detection> detections = {make_detection(0, 0, 100, 100, 0.75f), make_detection(20, 20, 120, 120, 0.25f)};
+    const auto merged = merge_detections(detections, {0, 1}, TileMerge::WeightedFusion, TileMatch::IntersectionOverSmaller, 0.5f);
+    CHECK_EQ(merged.size(), size_t{1});
+    if (merged.size() == 1) {
+        // Score-weighted average of the two boxes, with the best score
+        CHECK_NEAR(merged[0].bbox.x1, 5.0, 1e-4);
+        CHECK_NEAR(merged[0].bbox.y1, 5.0, 1e-4);
+        CHECK_NEAR(merged[0].bbox.x2, 105.0, 1e-4);
+        CHECK_NEAR(merged[0].bbox.y2, 105.0, 1e-4);
+        CHECK_NEAR(merged[0].class_confidence, 0.75, 1e-6);
+    }
+}
+
+void test_match_measures() {
+    // A box cut in half by a tile border: IoU 0.5, intersection over the smaller box 1.0
+    const std::vector<Detection> detections = {make_detection(0, 0, 100, 100, 0.9f), make_detection(0, 0, 50, 100, 0.8f)};
+    CHECK_EQ(merge_detections(detections, {0, 1}, TileMerge::Nms, TileMatch::Iou, 0.6f).size(), size_t{2});
+    CHECK_EQ(merge_detections(detections, {0, 1}, TileMerge::Nms, TileMatch::IntersectionOverSmaller, 0.6f).size(), size_t{1});
+    // The threshold is exclusive
+    CHECK_EQ(merge_detections(detections, {0, 1}, TileMerge::Nms, TileMatch::Iou, 0.5f).size(), size_t{2});
+    // Disjoint boxes never match
+    const std::vector<Detection> apart = {make_detection(0, 0, 10, 10, 0.9f), make_detection(20, 20, 30, 30, 0.8f)};
+    CHECK_EQ(merge_detections(apart, {0, 1}, TileMerge::Nms, TileMatch::IntersectionOverSmaller, 0.f).size(), size_t{2});
+}
+
+void test_region_count_checked() {
+    CHECK_THROWS(merge_detections({make_detection(0, 0, 1, 1, 0.5f)}, {}, TileMerge::Nms, TileMatch::Iou, 0.5f));
+    CHECK(merge_detections({}, {}, TileMerge::Nms, TileMatch::Iou, 0.5f).empty());
+}
+
+} // namespace
+
+int main() {
+    test_tile_origins();
+    test_same_region_kept();
+    test_cross_region_nms();
+    test_cross_region_weighted_fusion();
+    test_match_measures();
+    test_region_count_checked();
+    return check_result();
+}
@@ -0,0 +1,124 @@
+#include "trace.h"
+#include <cstring>
+#include <filesystem>
+#include <unistd.h>
+#include "check.h"
+
+namespace {
+
+void test_round_trip(const std::string& path) {
+    // A 3x2 frame with padded rows: only width * elem_size bytes of each row are recorded
+    const int width = 3;
+    const int height = 2;
+    const size_t step = 16;
+    std::vector<uint8_t> pixels(step * height);
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = static_cast<uint8_t>(i);
+    }
+    const std::vector<uint8_t> input = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    const std::vector<float> boxes = {0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f};
+    const std::vector<int32_t> count = {7};
+
+    {
+        TraceWriter writer(path);
+        writer.append_meta({{"model", "yolov10"}, {"input_format", "FORMAT_NCHW"}});
+        writer.append_frame(11, writer.now_ns(), width, height, 16, 3, pixels.data(), step);
+        writer.append_input(11, writer.now_ns(), input.data(), input.size(), 2);
+        TraceTensor boxes_tensor{"boxes", "FP32", {1, 6}, reinterpret_cast<const uint8_t*>(boxes.data()),
+                                 boxes.size() * sizeof(float)};
+        TraceTensor count_tensor{"num_dets", "INT32", {1}, reinterpret_cast<const uint8_t*>(count.data()),
+                                 count.size() * sizeof(int32_t)};
+        writer.append_output(11, writer.now_ns(), 1, 12345, {boxes_tensor, count_tensor});
+        CHECK(writer.size() > sizeof(TraceFileHeader));
+    }
+
+    TraceReader reader(path);
+    CHECK_EQ(reader.records().size(), size_t{4});
+    CHECK_EQ(reader.meta("model"), std::string("yolov10"));
+    CHECK_EQ(reader.meta("input_format"), std::string("FORMAT_NCHW"));
+    CHECK_EQ(reader.meta("missing", "fallback"), std::string("fallback"));
+
+    const auto frames = reader.records(TraceRecordType::Frame);
+    CHECK_EQ(frames.size(), size_t{1});
+    if (frames.size() == 1) {
+        CHECK_EQ(frames[0]->frame_id, uint64_t{11});
+        const TraceFrame frame = TraceReader::frame(*frames[0]);
+        CHECK_EQ(frame.width, width);
+        CHECK_EQ(frame.height, height);
+        CHECK_EQ(frame.type, 16);
+        CHECK_EQ(frame.elem_size, size_t{3});
+        for (int row = 0; row < height; ++row) {
+            CHECK(std::memcmp(frame.data + row * width * 3, pixels.data() + row * step, width * 3) == 0);
+        }
+    }
+
+    const auto inputs = reader.records(TraceRecordType::Input);
+    CHECK_EQ(inputs.size(), size_t{1});
+    if (inputs.size() == 1) {
+        CHECK_EQ(inputs[0]->index, uint32_t{2});
+        CHECK_EQ(inputs[0]->payload_size, uint64_t{input.size()});
+        CHECK(std::memcmp(inputs[0]->payload, input.data(), input.size()) == 0);
+    }
+
+    const auto outputs = reader.records(TraceRecordType::Output);
+    CHECK_EQ(outputs.size(), size_t{1});
+    if (outputs.size() == 1) {
+        CHECK_EQ(outputs[0]->frame_id, uint64_t{11});
+        CHECK_EQ(outputs[0]->index, uint32_t{1});
+        const TraceOutput output = TraceReader::output(*outputs[0]);
+        CHECK_EQ(output.latency_ns, int64_t{12345});
+        CHECK_EQ(output.tensors.size(), size_t{2});
+        if (output.tensors.size() == 2) {
+            const TraceTensor& tensor = output.tensors[0];
+            CHECK_EQ(tensor.name, std::string("boxes"));
+            CHECK_EQ(tensor.datatype, std::string("FP32"));
+            CHECK(tensor.shape == std::vector<int64_t>({1, 6}));
+            CHECK_EQ(tensor.byte_size, boxes.size() * sizeof(float));
+            CHECK(std::memcmp(tensor.data, boxes.data(), tensor.byte_size) == 0);
+            CHECK_EQ(output.tensors[1].name, std::string("num_dets"));
+            CHECK(std::memcmp(output.tensors[1].data, count.data(), sizeof(int32_t)) == 0);
+        }
+    }
+
+    // Records are in file order with non-decreasing timestamps
+    for (size_t i = 1; i < reader.records().size(); ++i) {
+        CHECK(reader.records()[i].time_ns >= reader.records()[i - 1].time_ns);
+    }
+}
+
+void test_request_ids() {
+    uint64_t frame_id = 0;
+    uint32_t request_index = 0;
+    CHECK(parse_trace_request_id(trace_request_id(42, 3, 99), frame_id, request_index));
+    CHECK_EQ(frame_id, uint64_t{42});
+    CHECK_EQ(request_index, uint32_t{3});
+
+    CHECK(!parse_trace_request_id("", frame_id, request_index));
+    CHECK(!parse_trace_request_id("42", frame_id, request_index));
+    CHECK(!parse_trace_request_id("42:3", frame_id, request_index));
+    CHECK(!parse_trace_request_id(":3:1", frame_id, request_index));
+    CHECK(!parse_trace_request_id("42::1", frame_id, request_index));
+    CHECK(!parse_trace_request_id("4x:3:1", frame_id, request_index));
+}
+
+void test_rejects_other_files(const std::string& path) {
+    {
+        FILE* file = std::fopen(path.c_str(), "wb");
+        const char garbage[128] = "not a trace";
+        std::fwrite(garbage, 1, sizeof(garbage), file);
+        std::fclose(file);
+    }
+    CHECK_THROWS(TraceReader reader(path));
+}
+
+} // namespace
+
+int main() {
+    const std::string path =
+        (std::filesystem::temp_directory_path() / ("yolov10-trace-test-" + std::to_string(getpid()) + ".trace")).string();
+    test_round_trip(path);
+    test_request_ids();
+    test_rejects_other_files(path);
+    std::filesystem::remove(path);
+    return check_result();
+}